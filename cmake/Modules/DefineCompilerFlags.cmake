@@ -68,6 +68,28 @@ if (UNIX AND NOT WIN32)
 
 endif (UNIX AND NOT WIN32)
 
+#
+# Require C++11; newer compilers default to a later standard
+#
+if (${CMAKE_CXX_COMPILER_ID} MATCHES "GNU")
+    if (CMAKE_CXX_COMPILER_VERSION VERSION_LESS 6.1)
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -std=gnu++11")
+    endif (CMAKE_CXX_COMPILER_VERSION VERSION_LESS 6.1)
+elseif (${CMAKE_CXX_COMPILER_ID} MATCHES "Clang")
+    if (CMAKE_CXX_COMPILER_VERSION VERSION_LESS 6.0)
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -std=gnu++11")
+    endif (CMAKE_CXX_COMPILER_VERSION VERSION_LESS 6.0)
+endif (${CMAKE_CXX_COMPILER_ID} MATCHES "GNU")
+
+#
+# Instrument for data race detection
+#
+if (FREDCPP_WITH_TSAN AND ${CMAKE_CXX_COMPILER_ID} MATCHES "(GNU|Clang)")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -fsanitize=thread")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fsanitize=thread")
+    set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -fsanitize=thread")
+endif (FREDCPP_WITH_TSAN AND ${CMAKE_CXX_COMPILER_ID} MATCHES "(GNU|Clang)")
+
 if (MSVC)
     # Use secure functions by default and suppress warnings about
     #"deprecated" functions
@@ -3,6 +3,8 @@ option(FREDCPP_BUILD_XML_PARSER "Enable building of the supplied XML parser." ON
 option(FREDCPP_BUILD_LOGGER "Enable building of the supplied logger facility." ON)
 option(FREDCPP_BUILD_TESTS "Enable building of the unit and acceptance tests." ON)
 option(FREDCPP_BUILD_EXAMPLES "Enable building of the examples." ON)
+option(FREDCPP_BUILD_BENCHMARKS "Enable building of the benchmarks (requires tests)." OFF)
+option(FREDCPP_WITH_TSAN "Build with ThreadSanitizer to check for data races." OFF)
 
 if (FREDCPP_BUILD_HTTP_CLIENT)
   option(FREDCPP_USE_CURL_HTTP
@@ -32,6 +34,19 @@ if (FREDCPP_BUILD_TESTS)
   set(WITH_TESTS ${FREDCPP_BUILD_TESTS})
 endif (FREDCPP_BUILD_TESTS)
 
+if (FREDCPP_BUILD_BENCHMARKS)
+  set(WITH_BENCHMARKS ${FREDCPP_BUILD_BENCHMARKS})
+endif (FREDCPP_BUILD_BENCHMARKS)
+
 if (FREDCPP_BUILD_EXAMPLES)
   set(WITH_EXAMPLES ${FREDCPP_BUILD_EXAMPLES})
 endif (FREDCPP_BUILD_EXAMPLES)
+
+set(FREDCPP_LOG_MIN_LEVEL "DEBUG" CACHE STRING
+  "Lowest log level compiled in: DEBUG, INFO, WARN, ERROR, FATAL or OFF."
+)
+set_property(CACHE FREDCPP_LOG_MIN_LEVEL PROPERTY STRINGS DEBUG INFO WARN ERROR FATAL OFF)
+
+if (NOT FREDCPP_LOG_MIN_LEVEL STREQUAL "DEBUG")
+  add_definitions(-DFREDCPP_LOG_MIN_LEVEL=FREDCPP_LOG_LEVEL_${FREDCPP_LOG_MIN_LEVEL})
+endif (NOT FREDCPP_LOG_MIN_LEVEL STREQUAL "DEBUG")
@@ -9,39 +9,60 @@
 // Some series may belong in more than one category.
 //
 // The retrieved FRED data is written into output file in pipe-delimited format.
+// Category tree is crawled with `CategoryCrawler`, requesting each tree level
+// concurrently within the FRED API rate limit.
 //
 // @note Expects FRED API key defined in `FRED_API_KEY` enviroment variable.
 
 
 #include <fredcpp/fredcpp.h>
 
-#include <fredcpp/external/CurlHttpClient.h>
+#include <fredcpp/external/CurlMultiHttpClient.h>
 #include <fredcpp/external/PugiXmlParser.h>
 #include <fredcpp/external/SimpleLogger.h>
 
 #include <iostream>
+#include <fstream>
 #include <cstdlib>
-#include <map>
-#include <set>
-#include <list>
 
 
 const char* ENV_API_KEY("FRED_API_KEY");
 const char* DEFAULT_CATEGORY("18"); // "0" for top-most root category
 const char* DEFAULT_OUTPUT_FILE("example.txt");
+const unsigned MAX_REQUESTS_PER_MINUTE(120);
 
 bool listAllSeries(const std::string& rootCategory, const std::string& outputFile);
 
-bool exitOnApiError(const fredcpp::ApiResponse& response);
 bool exitOnBadOutputFile(const std::string& outputFile);
 std::string getKeyFromEnv(const std::string& envVar);
 
 
-typedef std::set<std::string> IdSet;
-typedef std::map<std::string, IdSet> ChildrenByIdMap;
+/// Writes each series found by the crawler to the output file.
 
-std::size_t buildCategoryTree(fredcpp::Api& api, ChildrenByIdMap& tree, const std::string& rootCategory);
-std::size_t addCategoryToTree(fredcpp::Api& api, ChildrenByIdMap& tree, const std::string& categoryId);
+class SeriesFileSink : public fredcpp::CategoryCrawlerSink {
+public:
+  explicit SeriesFileSink(std::ostream& output)
+    : output_(output) {
+  }
+
+  void onSeries(const fredcpp::ApiEntity& series, const std::string& categoryId) {
+    output_ << series.attribute("id")
+            << "|" << series.attribute("frequency_short")
+            << "|" << series.attribute("title")
+            << "|" << series.attribute("observation_start")
+            << "|" << series.attribute("observation_end")
+            << "|"
+            << std::endl;
+  }
+
+  bool onError(const fredcpp::ApiRequest& request, const fredcpp::ApiResponse& response) {
+    FREDCPP_LOG_ERROR(response.error);
+    return (false);
+  }
+
+private:
+  std::ostream& output_;
+};
 
 //______________________________________________________________________________
 
@@ -58,9 +79,7 @@ int main(int argc, char* argv[], char* envp[]) {
     outputFile.assign(argv[2]);
   }
 
-  listAllSeries(rootCategory, outputFile);
-
-  return (0);
+  return (listAllSeries(rootCategory, outputFile) ? EXIT_SUCCESS : EXIT_FAILURE);
 }
 
 
@@ -73,7 +92,7 @@ bool listAllSeries(const std::string& rootCategory, const std::string& outputFil
 
   Api api;
   api.withLogger(external::SimpleLogger::getInstance())
-     .withExecutor(external::CurlHttpClient::getInstance())
+     .withExecutor(external::CurlMultiHttpClient::getInstance())
      .withParser(external::PugiXmlParser::getInstance())
      ;
 
@@ -83,20 +102,8 @@ bool listAllSeries(const std::string& rootCategory, const std::string& outputFil
      << " (" << FREDCPP_BRIEF  << ")");
 
   FREDCPP_LOG_INFO("Getting API key from environment variable " << ENV_API_KEY << " ...");
-  api.withKey(getKeyFromEnv(ENV_API_KEY));
-
-
-  // Build a list of available sub-categories under the root
-
-  FREDCPP_LOG_INFO("Building list of available sub-categories of category " << rootCategory << " ...");
-
-  ChildrenByIdMap categoryTree;
-  if ( 0 == buildCategoryTree(api, categoryTree, rootCategory)) {
-    FREDCPP_LOG_FATAL("Unable to retrieve categories");
-    exit(EXIT_FAILURE);
-  }
-
-  FREDCPP_LOG_INFO("Available categories count:" << categoryTree.size());
+  api.withKey(getKeyFromEnv(ENV_API_KEY))
+     .withRateLimit(MAX_REQUESTS_PER_MINUTE);
 
 
   FREDCPP_LOG_INFO("Creating output data file " << outputFile << " ...");
@@ -107,169 +114,35 @@ bool listAllSeries(const std::string& rootCategory, const std::string& outputFil
   }
 
 
-  // Get series
-
-  IdSet uniqueSeries;
-  ApiResponse response;
-
-  for (ChildrenByIdMap::iterator it = categoryTree.begin();
-       it != categoryTree.end();
-       ++it) {
-    std::string categoryId(it->first);
-
-    api.get(ApiRequestBuilder::CategorySeries(categoryId)
-            , response) || exitOnApiError(response);
-
-    if (!response.entities.size()) {
-      FREDCPP_LOG_INFO("category:" << categoryId << " contains no series");
-    }
-
-    // Print series
-
-    // NOTE: a given series can belong to multiple categories,
-    // so keep track of unique series
+  // Crawl sub-categories of the root and write their series
 
-    for (std::size_t n = 0; n < response.entities.size(); ++n) {
+  FREDCPP_LOG_INFO("Listing series of category " << rootCategory << " and its sub-categories ...");
 
-      std::string seriesId (response.entities[n].attribute("id"));
+  SeriesFileSink sink(output);
+  CategoryCrawler crawler(api);
 
-      if (uniqueSeries.find(seriesId) != uniqueSeries.end()) {
-        continue;
-      }
-
-      uniqueSeries.insert(seriesId);
-
-      output << response.entities[n].attribute("id")
-             << "|" << response.entities[n].attribute("frequency_short")
-             << "|" << response.entities[n].attribute("title")
-             << "|" << response.entities[n].attribute("observation_start")
-             << "|" << response.entities[n].attribute("observation_end")
-             << "|"
-             << std::endl;
-    }
-  }
+  result = crawler.crawl(rootCategory, sink);
 
 
   // Report stats
 
-  FREDCPP_LOG_INFO("root-category:" << rootCategory
-                   << " sub-categories-count:" << categoryTree.size() - 1
-                   << " series-count:" << uniqueSeries.size());
+  const CategoryCrawler::Stats& stats(crawler.getStats());
 
+  FREDCPP_LOG_INFO("root-category:" << rootCategory
+                   << " sub-categories-count:" << stats.categories - 1
+                   << " series-count:" << stats.series
+                   << " requests:" << stats.requests);
 
   output.close();
 
-  FREDCPP_LOG_INFO("Successfully created file " << outputFile);
-
-  result = true;
-  return (result);
-
-}
-
-
-std::size_t buildCategoryTree(fredcpp::Api& api, ChildrenByIdMap& tree, const std::string& rootCategory) {
-  std::size_t categoryCount;
-
-  using namespace fredcpp;
-
-  tree.clear();
-
-  // Request children categories for sub-categories starting from rootCategory
-
-  std::string parentId(rootCategory);
-
-
-  // Add top-level categories
-
-  categoryCount = addCategoryToTree(api, tree, parentId);
-
-  if (categoryCount == 0) {
-    return (categoryCount);
-  }
-
-  std::list<IdSet> parentLevels;
-  IdSet parents;
-
-  IdSet children = tree[parentId];
-
-  if (children.size()) {
-    parentLevels.push_back(children);
-
-  } else {
-    return (categoryCount);
-  }
-
-
-  while (parentLevels.size()) {
-     parents = parentLevels.front();
-
-    for (IdSet::iterator itNextParent = parents.begin();
-         itNextParent != parents.end();
-         ++itNextParent) {
-
-      for (IdSet::iterator itChild = children.begin();
-           itChild != children.end();
-           ++itChild) {
-        std::string childId(*itChild);
-
-        //FREDCPP_LOG_INFO("category:" << childId << " parent:" << parentId);
-
-        categoryCount += addCategoryToTree(api, tree,  childId);
-      }
-
-      parentId = *itNextParent;
-      children = tree[parentId];
-      if (children.size()) {
-        parentLevels.push_back(children);
-      }
-    }
-
-    parentLevels.pop_front();
+  if (!result) {
+    FREDCPP_LOG_FATAL("Unable to retrieve all categories and series");
+    return (result);
   }
 
-  return (categoryCount);
-}
-
-
-std::size_t addCategoryToTree(fredcpp::Api& api, ChildrenByIdMap& tree, const std::string& categoryId) {
-  std::size_t addedCount(0);
-
-  using namespace fredcpp;
-
-  ApiResponse response;
-  api.get(ApiRequestBuilder::CategoryChildren(categoryId)
-          , response) || exitOnApiError(response);
-
-  // Add categoryId to tree
-
-  std::pair<ChildrenByIdMap::iterator, bool> inserted =
-      tree.insert(ChildrenByIdMap::value_type(categoryId, ChildrenByIdMap::mapped_type()));
-
-  if (inserted.second) {
-    ++addedCount;
-  }
-
-  // Populate category children
-  for (std::size_t n = 0; n < response.entities.size(); ++n) {
-    std::string childId (response.entities[n].attribute("id"));
-
-    tree[categoryId].insert(childId);
-  }
-
-  return (addedCount);
-}
-
-
-bool exitOnApiError(const fredcpp::ApiResponse& response) {
-  bool gotError( !response.good() );
-
-  if (gotError) {
-    FREDCPP_LOG_ERROR(response.error);
-
-    exit(response.error.status);
-  }
+  FREDCPP_LOG_INFO("Successfully created file " << outputFile);
 
-  return (gotError);
+  return (result);
 }
 
 
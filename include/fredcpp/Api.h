@@ -33,20 +33,47 @@
 /// @example example3.cpp
 
 
+#include <fredcpp/ApiRequest.h>
+#include <fredcpp/ApiResponseCache.h>
+
 #include <string>
+#include <vector>
 
 
 namespace fredcpp {
 namespace internal {
 
 class HttpRequestExecutor; // forward
-class XmlResponseParser; // forward
+class ResponseParser; // forward
 class Logger; // forward
+class HttpRequest; // forward
+class HttpResponse; // forward
+class RateLimiter; // forward
 
 } // namespace internal
 
-class ApiRequest; // forward
-struct ApiResponse; // forward
+
+
+/// Collection of API requests executed as a batch.
+typedef std::vector<ApiRequest> ApiRequestVector;
+
+
+/// Handler of API responses of a batch of requests.
+/// Receives each response as soon as its request completes.
+///
+/// @see Api::getBatch
+
+class ApiResponseHandler {
+public:
+  virtual ~ApiResponseHandler();
+
+  /// Called once for each request of the batch, in order of completion.
+  /// The response is valid only for the duration of the call; swap its
+  /// content out to keep it.
+  virtual void onResponse(std::size_t index, const ApiRequest& request, ApiResponse& response) = 0;
+};
+
+//______________________________________________________________________________
 
 
 /// Interface to FRED database API.
@@ -55,7 +82,7 @@ struct ApiResponse; // forward
 ///
 /// General usage pattern:
 /// - configure Logger, Executor, and Parser Facilities (with implementations of
-///   internal::Logger, internal::HttpRequestExecutor, internal::XmlResponseParser
+///   internal::Logger, internal::HttpRequestExecutor, internal::ResponseParser
 ///   interfaces)
 /// - configure with FRED API key
 /// - call Api::get function for the specific ApiRequest object created with
@@ -75,28 +102,92 @@ public:
   /// @{
   Api& withLogger(internal::Logger& logger);
   Api& withExecutor(internal::HttpRequestExecutor& executor);
-  Api& withParser(internal::XmlResponseParser& parser);
+  Api& withParser(internal::ResponseParser& parser);
 
   Api& withKey(const std::string& key);
+  /// Sets `file_type` of responses, the parser is to accept it
+  /// (e.g. `json` with external::JsonResponseParser).
   Api& withFileType(const std::string& type);
+
+  /// Limits requests to the specified maximum per period (0 disables).
+  /// The limit is shared by all Api objects configured with the same key;
+  /// configuring the same limit again does not reset the requests taken.
+  Api& withRateLimit(unsigned maxRequests, unsigned periodSecs = DEFAULT_RATE_PERIOD_SECS);
+
+  /// Serves responses of repeated requests from the in-memory cache.
+  /// Only good responses are cached, keyed with the API base URI, so the
+  /// cache may be shared with Api objects of other endpoints.
+  Api& withCache(ApiResponseCache& cache);
   /// @}
 
 
   /// Execute the specified API request and fill the resulting response.
+  /// With a cache configured, a cached response is copied without a request.
   virtual bool get(const ApiRequest& request, ApiResponse& response);
 
+  /// Execute the specified API request and return the shared response.
+  /// With a cache configured, a cached response is returned without a request
+  /// or copying; otherwise it is a new response.
+  /// @return response, test ApiResponse::good for success.
+  ApiResponsePtr getShared(const ApiRequest& request);
+
+  /// Execute the specified API request and pass each entity of the response
+  /// to the handler instead of storing it in the response.
+  /// With an incremental parser (e.g. external::StreamingXmlParser) entities
+  /// are parsed and passed on while the content is still being received.
+  virtual bool get(const ApiRequest& request, ApiResponse& response, ApiEntityHandler& handler);
+
+  /// Execute a batch of API requests and pass each response to the handler
+  /// as its request completes.
+  /// Requests are executed concurrently when the configured executor supports
+  /// it (e.g. external::CurlMultiHttpClient).
+  /// @return true when all responses are good.
+  virtual bool getBatch(const ApiRequestVector& requests, ApiResponseHandler& handler);
+
+  /// Execute a batch of API requests and fill the responses in request order.
+  bool getBatch(const ApiRequestVector& requests, std::vector<ApiResponse>& responses);
+
+  /// Execute the specified API request for all pages of a paged result and
+  /// merge the entities of the pages in order into the response.
+  /// Paging is read from `count`, `limit`, and `offset` result attributes of
+  /// the first page; the remaining pages are requested as a batch.
+  /// The result attributes are those of the first page.
+  bool getAll(const ApiRequest& request, ApiResponse& response);
+
 
 private:
+  class BatchResponseHandler; // forward
+  friend class BatchResponseHandler;
+
+  bool fetch(const ApiRequest& request, ApiResponse& response);
+  void bindRateLimiter();
+  bool requireValidFacilities(ApiResponse& response) const;
+  bool requireParsableContent(const ApiRequest& request, const internal::HttpRequest& httpRequest,
+                         const internal::HttpResponse& httpResponse, ApiResponse& response) const;
+  void makeHttpRequest(const ApiRequest& request, internal::HttpRequest& httpRequest) const;
+  bool processResponse(const ApiRequest& request, const internal::HttpRequest& httpRequest,
+                       internal::HttpResponse& httpResponse, ApiResponse& response);
+
   static const std::string DEFAULT_BASE_URI;
   static const std::string FRED_PARAM_API_KEY;
   static const std::string FRED_PARAM_FILE_TYPE;
+  static const std::string FRED_PARAM_LIMIT;
+  static const std::string FRED_PARAM_OFFSET;
+  static const std::string FRED_RESULT_COUNT;
+  static const unsigned DEFAULT_RATE_PERIOD_SECS;
 
   const std::string apiURI_;
 
   std::string apiKey_;
   std::string apiFileType_;
   internal::HttpRequestExecutor* executor_;
-  internal::XmlResponseParser* parser_;
+  internal::ResponseParser* parser_;
+
+  unsigned rateMaxRequests_;
+  unsigned ratePeriodSecs_;
+  internal::RateLimiter* rateLimiter_;
+
+  ApiResponseCache* cache_;
 };
 
 } //namespace fredcpp
@@ -95,6 +95,12 @@ struct ErrorHttpRequestFailed : public ApiError {
 
 
 /// Data object to describe error at parsing of response content received from FRED API.
+struct ErrorParseFailed : public ApiError {
+  ErrorParseFailed(const ApiRequest& request, const std::string& content);
+};
+
+
+/// Data object to describe error at parsing of XML response content received from FRED API.
 struct ErrorXmlParseFailed : public ApiError {
   ErrorXmlParseFailed(const ApiRequest& request, const std::istringstream& xmlContent);
 };
@@ -33,6 +33,7 @@
 
 #include <fredcpp/internal/Logger.h>
 
+#include <atomic>
 #include <string>
 
 
@@ -43,6 +44,13 @@ namespace fredcpp {
 /// Supports progressively inclusive debug message depth - prints all debug messages
 /// with depth <= configured depth.
 /// Usually called via the defined @ref FREDCPP_LOG "FREDCPP_LOG-macros".
+///
+/// Safe to use from many threads; the logger itself must be thread-safe
+/// (e.g. external::SimpleLogger). Reconfigure it only while not logging.
+///
+/// The logging predicates are static and inline: they test the levels cached
+/// by the logger (see internal::Logger::isLevelEnabled), so a disabled log
+/// message costs a couple of loads.
 
 class ApiLog {
 public:
@@ -72,11 +80,14 @@ public:
   /// @name Logging Predicates
   /// Test if logging level is enabled.
   /// @{
-  bool infoEnabled() const;
-  bool warnEnabled() const;
-  bool errorEnabled() const;
-  bool fatalEnabled() const;
-  bool debugEnabled() const;
+  static bool infoEnabled();
+  static bool warnEnabled();
+  static bool errorEnabled();
+  static bool fatalEnabled();
+  static bool debugEnabled();
+  /// Tests if debug messages of the depth are logged.
+  static bool debugEnabled(int depth);
+  static bool levelEnabled(internal::LogLevel::Level level);
   /// @}
 
 
@@ -90,16 +101,66 @@ private:
   bool requireValidLogger(internal::Logger* const loggerPtr) const;
 
 
-  internal::Logger* loggerPtr_;
-  int debugDepth_;
+  static std::atomic<internal::Logger*> loggerPtr_;
+  static std::atomic<int> debugDepth_;
 };
 
+//______________________________________________________________________________
+
+inline bool ApiLog::levelEnabled(internal::LogLevel::Level level) {
+  internal::Logger* loggerPtr(loggerPtr_.load(std::memory_order_acquire));
+  return (NULL != loggerPtr && loggerPtr->isLevelEnabled(level));
+}
+
+inline bool ApiLog::infoEnabled() {
+  return (levelEnabled(internal::LogLevel::LOG_INFO));
+}
+
+inline bool ApiLog::warnEnabled() {
+  return (levelEnabled(internal::LogLevel::LOG_WARN));
+}
+
+inline bool ApiLog::errorEnabled() {
+  return (levelEnabled(internal::LogLevel::LOG_ERROR));
+}
+
+inline bool ApiLog::fatalEnabled() {
+  return (levelEnabled(internal::LogLevel::LOG_FATAL));
+}
+
+inline bool ApiLog::debugEnabled() {
+  return (levelEnabled(internal::LogLevel::LOG_DEBUG));
+}
+
+inline bool ApiLog::debugEnabled(int depth) {
+  return (depth <= debugDepth_.load(std::memory_order_relaxed)
+          && levelEnabled(internal::LogLevel::LOG_DEBUG));
+}
+
 
 } // namespace fredcpp
 
 //______________________________________________________________________________
 
 
+/// @name Compile-time Log Level
+/// Log levels in order of priority, to set `FREDCPP_LOG_MIN_LEVEL`.
+/// Logging helper macros of a level below `FREDCPP_LOG_MIN_LEVEL` are compiled
+/// out, the message expression is neither evaluated nor formatted.
+/// @{
+#define FREDCPP_LOG_LEVEL_DEBUG 0
+#define FREDCPP_LOG_LEVEL_INFO  1
+#define FREDCPP_LOG_LEVEL_WARN  2
+#define FREDCPP_LOG_LEVEL_ERROR 3
+#define FREDCPP_LOG_LEVEL_FATAL 4
+#define FREDCPP_LOG_LEVEL_OFF   5
+
+#ifndef FREDCPP_LOG_MIN_LEVEL
+# define FREDCPP_LOG_MIN_LEVEL FREDCPP_LOG_LEVEL_DEBUG
+#endif
+/// @}
+
+
 /// @anchor FREDCPP_LOG
 ///
 /// @name Logging Helper Macros
@@ -109,6 +170,9 @@ private:
 ///   FREDCPP_LOG_INFO("This is INFO message:" << 123 << "...");
 /// @endcode
 ///
+/// The message is formatted only when the level is enabled, into a reused
+/// per-thread buffer (fredcpp::internal::LogMessage).
+///
 /// @attention Requires fredcpp::ApiLog instance configured with valid
 /// fredcpp::internal::Logger implementation.
 ///
@@ -116,40 +180,52 @@ private:
 /// @{
 #define FREDCPP_LOGCONTEXT fredcpp::internal::LogContext(__FILE__,__LINE__, FREDCPP__FUNC__) // FREDCPP__PRETTY_FUNC__
 
-#define  FREDCPP_LOG_INFO(message) {\
-  fredcpp::ApiLog& log_ = fredcpp::ApiLog::getInstance();\
-  if (log_.infoEnabled()) {\
-    std::ostringstream buf_;\
-    buf_ << message;\
-    log_.info(buf_.str(), FREDCPP_LOGCONTEXT); }}
-
-#define  FREDCPP_LOG_WARN(message) {\
-  fredcpp::ApiLog& log_ = fredcpp::ApiLog::getInstance();\
-  if (log_.warnEnabled()) {\
-    std::ostringstream buf_;\
-    buf_ << message;\
-    log_.warn(buf_.str(), FREDCPP_LOGCONTEXT); }}
-
-#define  FREDCPP_LOG_ERROR(message) {\
-  fredcpp::ApiLog& log_ = fredcpp::ApiLog::getInstance();\
-  if (log_.errorEnabled()) {\
-    std::ostringstream buf_;\
-    buf_ << message;\
-    log_.error(buf_.str(), FREDCPP_LOGCONTEXT); }}
-
-#define  FREDCPP_LOG_FATAL(message) {\
-  fredcpp::ApiLog& log_ = fredcpp::ApiLog::getInstance();\
-  if (log_.fatalEnabled()) {\
-    std::ostringstream buf_;\
-    buf_ << message;\
-    log_.fatal(buf_.str(), FREDCPP_LOGCONTEXT); }}
-
-#define  FREDCPP_LOG_DBGN(depth, message) {\
-  fredcpp::ApiLog& log_ = fredcpp::ApiLog::getInstance();\
-  if (log_.debugEnabled()) {\
-    std::ostringstream buf_;\
-    buf_ << message;\
-    log_.debug((depth), buf_.str(), FREDCPP_LOGCONTEXT); }}
+#define  FREDCPP_LOG_MESSAGE_(enabled, logCall, message) {\
+  if (enabled) {\
+    fredcpp::internal::LogMessage buf_;\
+    buf_.stream() << message;\
+    fredcpp::ApiLog::getInstance().logCall; }}
+
+// compiled out, still type-checks the message
+#define  FREDCPP_LOG_DISABLED_(message) {\
+  if (false) {\
+    fredcpp::internal::LogMessage buf_;\
+    buf_.stream() << message; }}
+
+#if FREDCPP_LOG_MIN_LEVEL <= FREDCPP_LOG_LEVEL_INFO
+# define  FREDCPP_LOG_INFO(message) \
+  FREDCPP_LOG_MESSAGE_(fredcpp::ApiLog::infoEnabled(), info(buf_.str(), FREDCPP_LOGCONTEXT), message)
+#else
+# define  FREDCPP_LOG_INFO(message) FREDCPP_LOG_DISABLED_(message)
+#endif
+
+#if FREDCPP_LOG_MIN_LEVEL <= FREDCPP_LOG_LEVEL_WARN
+# define  FREDCPP_LOG_WARN(message) \
+  FREDCPP_LOG_MESSAGE_(fredcpp::ApiLog::warnEnabled(), warn(buf_.str(), FREDCPP_LOGCONTEXT), message)
+#else
+# define  FREDCPP_LOG_WARN(message) FREDCPP_LOG_DISABLED_(message)
+#endif
+
+#if FREDCPP_LOG_MIN_LEVEL <= FREDCPP_LOG_LEVEL_ERROR
+# define  FREDCPP_LOG_ERROR(message) \
+  FREDCPP_LOG_MESSAGE_(fredcpp::ApiLog::errorEnabled(), error(buf_.str(), FREDCPP_LOGCONTEXT), message)
+#else
+# define  FREDCPP_LOG_ERROR(message) FREDCPP_LOG_DISABLED_(message)
+#endif
+
+#if FREDCPP_LOG_MIN_LEVEL <= FREDCPP_LOG_LEVEL_FATAL
+# define  FREDCPP_LOG_FATAL(message) \
+  FREDCPP_LOG_MESSAGE_(fredcpp::ApiLog::fatalEnabled(), fatal(buf_.str(), FREDCPP_LOGCONTEXT), message)
+#else
+# define  FREDCPP_LOG_FATAL(message) FREDCPP_LOG_DISABLED_(message)
+#endif
+
+#if FREDCPP_LOG_MIN_LEVEL <= FREDCPP_LOG_LEVEL_DEBUG
+# define  FREDCPP_LOG_DBGN(depth, message) \
+  FREDCPP_LOG_MESSAGE_(fredcpp::ApiLog::debugEnabled(depth), debug((depth), buf_.str(), FREDCPP_LOGCONTEXT), message)
+#else
+# define  FREDCPP_LOG_DBGN(depth, message) FREDCPP_LOG_DISABLED_(message)
+#endif
 
 #define  FREDCPP_LOG_DEBUG(message) FREDCPP_LOG_DBGN(0, message)
 /// @}
@@ -31,6 +31,7 @@
 
 #include <fredcpp/internal/Request.h>
 
+#include <cstddef>
 #include <ostream>
 #include <string>
 
@@ -44,11 +45,21 @@ namespace fredcpp {
 /// Generally used through its children classes, that represent specific FRED API
 /// requests (e.g. FredSeriesRequest).
 ///
+/// Entity names are interned (case-sensitive), so constructing and copying
+/// a request does not copy the name.
+///
 /// @see ApiRequestBuilder
 
 class  ApiRequest : public internal::Request {
 public:
   explicit ApiRequest(const std::string& entity);
+
+  /// Constructs request of the entity given as string literal.
+  template<std::size_t N>
+  explicit ApiRequest(const char (&entity)[N])
+    : entity_(internEntityLiteral(entity)) {
+  }
+
   virtual ~ApiRequest();
 
   /// Return requested entity's path.
@@ -60,7 +71,10 @@ public:
   virtual std::ostream& print(std::ostream& os) const;
 
 private:
-  std::string entity_;
+  static const std::string* internEntity(const std::string& entity);
+  static const std::string* internEntityLiteral(const char* entity);
+
+  const std::string* entity_;
 };
 
 
@@ -31,7 +31,7 @@
 /// @example example1.cpp
 
 
-#include <fredcpp/internal/Request.h>
+#include <fredcpp/internal/AttributeMap.h>
 #include <fredcpp/ApiError.h>
 
 #include <ostream>
@@ -53,15 +53,20 @@ namespace fredcpp {
 struct ApiEntity {
   std::string name;
   std::string value;
-  internal::KeyValueMap attributes;
+  internal::AttributeMap attributes;
 
   /// Get an attribute value by its name.
   /// When attribute's name is not found, returns an empty value.
-  internal::KeyValueMap::mapped_type attribute(const internal::KeyValueMap::key_type& name) const;
+  internal::AttributeMap::mapped_type attribute(const internal::AttributeMap::key_type& name) const;
 
   virtual std::ostream& print(std::ostream& os) const;
   virtual void clear();
 
+  /// Clears the entity, keeping its memory and attribute slots for reuse.
+  void recycle();
+
+  /// Swaps content with the other entity without copying.
+  void swap(ApiEntity& other);
 };
 
 std::ostream& operator<< (std::ostream& os, const ApiEntity& object);
@@ -69,6 +74,28 @@ std::ostream& operator<< (std::ostream& os, const ApiEntity& object);
 //______________________________________________________________________________
 
 
+/// Handler of API response entities.
+/// Receives each entity as soon as it is parsed, instead of storing all
+/// entities in the response.
+///
+/// @see Api::get
+
+class ApiEntityHandler {
+public:
+  virtual ~ApiEntityHandler();
+
+  /// Called for each entity of the response, in order of the content.
+  /// The entity is valid only for the duration of the call.
+  virtual void onEntity(const ApiEntity& entity) = 0;
+
+  /// Called when the response is restarted, e.g. when the request is re-tried
+  /// after a network failure. The entities received so far should be discarded.
+  virtual void onReset();
+};
+
+//______________________________________________________________________________
+
+
 /// Data object to store FRED API query response.
 /// Contains data returned from FRED API query or a resulting error.
 /// Response is good, when it has no error.
@@ -81,6 +108,11 @@ std::ostream& operator<< (std::ostream& os, const ApiEntity& object);
 /// - when good, the result is set and entities are filled with available FRED data
 /// - otherwise, error is set
 ///
+/// When the same response object is reused for many requests, enable
+/// recycling (see ApiResponse::setRecycling): cleared entities are then kept
+/// with their allocated memory and attribute slots, and reused for the next
+/// response.
+///
 /// @see ApiEntity, Api
 
 struct ApiResponse {
@@ -98,9 +130,33 @@ struct ApiResponse {
   void setError(const ApiError& otherError);
   void setErrorFromResult();
 
+  /// Appends an empty entity, reusing a recycled one when available.
+  ApiEntity& appendEntity();
+
+  /// Enables keeping cleared entities for reuse, disabling releases them.
+  void setRecycling(bool recycle);
+  bool isRecycling() const;
+
   virtual std::ostream& print(std::ostream& os) const;
+
+  /// Clears the response.
+  /// With recycling enabled, entities are kept for reuse instead of freed.
   virtual void clear();
 
+private:
+  /// Recycled entities, owned by the response object: neither copied nor
+  /// assigned with the response.
+  class EntityPool {
+  public:
+    EntityPool();
+    EntityPool(const EntityPool& other);
+    EntityPool& operator= (const EntityPool& rhs);
+
+    ApiEntityVector entities;
+    bool enabled;
+  };
+
+  EntityPool pool_;
 };
 
 
@@ -0,0 +1,165 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef FREDCPP_APIRESPONSECACHE_H_
+#define FREDCPP_APIRESPONSECACHE_H_
+
+/// @file
+/// Defines fredcpp::ApiResponseCache, an in-memory cache of parsed responses.
+
+
+#include <fredcpp/ApiRequest.h>
+#include <fredcpp/ApiResponse.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+namespace fredcpp {
+
+
+/// Shared immutable API response.
+typedef std::shared_ptr<const ApiResponse> ApiResponsePtr;
+
+
+/// In-memory cache of parsed API responses.
+/// Keeps the most recently used responses within a byte budget, evicting
+/// the least recently used ones when the budget is exceeded.
+///
+/// Responses are keyed by the API endpoint (base URI), the request entity and
+/// its parameters; the key does not depend on the order or the case of
+/// parameter names. Api passes its base URI, so Api objects of different
+/// endpoints may share a cache without serving each other's responses. Entries are
+/// looked up by the request fingerprint, reusing the encoded query the request
+/// keeps (see internal::Request::getEncodedQuery). Cached
+/// responses are shared and immutable, so a hit costs neither a request
+/// nor parsing. The cache is thread-safe and may be shared by many threads.
+///
+/// Configure Api with the cache to serve repeated requests from memory:
+///
+///     ApiResponseCache cache(16 * 1024 * 1024);
+///     api.withCache(cache);
+///
+///     ApiResponsePtr response(api.getShared(ApiRequestBuilder::Series("GDP")));
+///
+/// @see Api::withCache, Api::getShared
+
+class ApiResponseCache {
+public:
+  /// Cache effectiveness counters.
+  struct Stats {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    unsigned long insertions;
+
+    Stats();
+  };
+
+  explicit ApiResponseCache(std::size_t maxBytes = DEFAULT_MAX_BYTES);
+  ~ApiResponseCache();
+
+  /// Sets the byte budget, evicting entries to fit it.
+  ApiResponseCache& withMaxBytes(std::size_t maxBytes);
+
+  /// Finds the response of the request to the endpoint, marking it most
+  /// recently used.
+  /// @return NULL pointer when not cached.
+  ApiResponsePtr find(const ApiRequest& request, const std::string& endpoint = std::string());
+
+  /// Stores the response of the request to the endpoint, replacing an
+  /// existing one. A response larger than the byte budget is not stored.
+  /// @return true when the response was stored.
+  bool insert(const ApiRequest& request, const ApiResponsePtr& response, const std::string& endpoint = std::string());
+
+  /// Removes the response of the request to the endpoint.
+  /// @return true when it was cached.
+  bool erase(const ApiRequest& request, const std::string& endpoint = std::string());
+  void clear();
+
+  std::size_t size() const;
+  std::size_t getBytes() const;
+  std::size_t getMaxBytes() const;
+
+  /// @{
+  /** Get cache effectiveness counters.
+  */
+  Stats getStats() const;
+  void resetStats();
+  /// @}
+
+  /// Gets cache key of the request: endpoint, entity and encoded query.
+  static std::string makeKey(const ApiRequest& request, const std::string& endpoint = std::string());
+
+  /// Gets fingerprint of the request: of the endpoint, the entity and the
+  /// encoded query.
+  static std::uint64_t makeFingerprint(const ApiRequest& request, const std::string& endpoint = std::string());
+
+  /// Estimates memory used by the response.
+  static std::size_t estimateBytes(const ApiResponse& response);
+
+
+private:
+  ApiResponseCache(const ApiResponseCache&);
+  ApiResponseCache& operator= (const ApiResponseCache&);
+
+  struct Entry {
+    std::string key;
+    std::uint64_t fingerprint;
+    ApiResponsePtr response;
+    std::size_t bytes;
+  };
+
+  typedef std::list<Entry> EntryList;
+  typedef std::unordered_multimap<std::uint64_t, EntryList::iterator> EntryIndex;
+
+  /// Finds index of the request's entry, end when not cached.
+  EntryIndex::iterator findEntry(std::uint64_t fingerprint, const ApiRequest& request, const std::string& endpoint);
+  /// Finds index of the entry.
+  EntryIndex::iterator findEntry(EntryList::iterator itEntry);
+
+  void evict(std::size_t maxBytes);
+  void eraseEntry(EntryIndex::iterator itIndex);
+
+  static bool matchesKey(const std::string& key, const ApiRequest& request, const std::string& endpoint);
+
+  static const std::size_t DEFAULT_MAX_BYTES;
+
+  std::size_t maxBytes_;
+  std::size_t bytes_;
+  EntryList entries_;   ///< most recently used first
+  EntryIndex index_;
+  Stats stats_;
+
+  mutable std::mutex mutex_;
+};
+
+
+} // namespace fredcpp
+
+#endif // FREDCPP_APIRESPONSECACHE_H_
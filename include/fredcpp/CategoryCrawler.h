@@ -0,0 +1,166 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef FREDCPP_CATEGORYCRAWLER_H_
+#define FREDCPP_CATEGORYCRAWLER_H_
+
+/// @file
+/// Defines fredcpp::CategoryCrawler to walk FRED category tree and its series.
+
+
+#include <fredcpp/ApiRequest.h>
+#include <fredcpp/ApiResponse.h>
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace fredcpp {
+
+class Api; // forward
+
+
+/// Receiver of categories and series found by CategoryCrawler.
+/// Entities are valid only for the duration of the call.
+
+class CategoryCrawlerSink {
+public:
+  virtual ~CategoryCrawlerSink();
+
+  /// Called once for each sub-category found under the parent category.
+  virtual void onCategory(const ApiEntity& category, const std::string& parentId);
+
+  /// Called once for each unique series, with the first category it was found in.
+  virtual void onSeries(const ApiEntity& series, const std::string& categoryId) = 0;
+
+  /// Called when a request failed.
+  /// @return true to continue crawling, false to stop (default).
+  virtual bool onError(const ApiRequest& request, const ApiResponse& response);
+};
+
+//______________________________________________________________________________
+
+
+/// Crawler of FRED category tree.
+/// Walks sub-categories of the root category breadth-first and lists the
+/// series of every category, passing each unique series to a sink.
+///
+/// Requests of a tree level (children and series of each category, as well
+/// as further pages of series) are submitted as batches of bounded size
+/// with Api::getBatch, so with a concurrent executor the crawl is limited by
+/// the configured rate limit rather than by request latency.
+///
+///     CategoryCrawler crawler(api);
+///     crawler.withMaxBatchSize(32)
+///            .crawl("18", sink);
+///
+/// @see Api::withRateLimit, external::CurlMultiHttpClient
+
+class CategoryCrawler {
+public:
+  /// Crawl counters.
+  struct Stats {
+    unsigned long categories;         ///< categories visited, including the root
+    unsigned long series;             ///< unique series passed to the sink
+    unsigned long duplicateSeries;    ///< series found in more than one category
+    unsigned long requests;
+    unsigned long batches;
+    unsigned long failedRequests;
+
+    Stats();
+  };
+
+  explicit CategoryCrawler(Api& api);
+  ~CategoryCrawler();
+
+  /// @name Configuration Parameters
+  /// @{
+  /// Sets maximum number of requests submitted in one batch.
+  CategoryCrawler& withMaxBatchSize(std::size_t size);
+  /// Sets maximum depth of sub-categories below the root, 0 is unlimited.
+  CategoryCrawler& withMaxDepth(unsigned depth);
+  /// Sets whether series are listed, otherwise only categories are walked.
+  CategoryCrawler& withSeries(bool listSeries);
+  /// Sets number of series requested per page.
+  CategoryCrawler& withSeriesPageSize(unsigned long size);
+  /// @}
+
+  /// Crawls the category tree under the root category.
+  /// @return true when all requests succeeded.
+  bool crawl(const std::string& rootCategory, CategoryCrawlerSink& sink);
+
+  const Stats& getStats() const;
+
+
+private:
+  CategoryCrawler(const CategoryCrawler&);
+  CategoryCrawler& operator= (const CategoryCrawler&);
+
+  enum TaskKind {
+    TASK_CHILDREN,
+    TASK_SERIES
+  };
+
+  /// Pending request of a category.
+  struct Task {
+    TaskKind kind;
+    std::string categoryId;
+    ApiRequest request;
+
+    Task(TaskKind taskKind, const std::string& id, const ApiRequest& apiRequest);
+  };
+
+  typedef std::vector<Task> TaskVector;
+  typedef std::set<std::string> IdSet;
+
+  class BatchHandler; // forward
+  friend class BatchHandler;
+
+  void addCategoryTasks(const std::string& categoryId, TaskVector& tasks) const;
+  bool runTasks(TaskVector& tasks, std::vector<std::string>& nextLevel);
+
+  void onChildren(const Task& task, const ApiResponse& response, std::vector<std::string>& nextLevel);
+  void onSeries(const Task& task, const ApiResponse& response, TaskVector& tasks);
+
+  static const std::size_t DEFAULT_MAX_BATCH_SIZE;
+  static const unsigned long DEFAULT_SERIES_PAGE_SIZE;
+
+  Api& api_;
+  std::size_t maxBatchSize_;
+  unsigned maxDepth_;
+  bool listSeries_;
+  unsigned long seriesPageSize_;
+
+  CategoryCrawlerSink* sink_;
+  IdSet visitedCategories_;
+  IdSet visitedSeries_;
+  bool stopped_;
+  Stats stats_;
+};
+
+
+} // namespace fredcpp
+
+#endif // FREDCPP_CATEGORYCRAWLER_H_
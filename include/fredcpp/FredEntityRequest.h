@@ -34,6 +34,9 @@
 
 #include <fredcpp/ApiRequest.h>
 
+#include <cstddef>
+#include <string>
+
 
 namespace fredcpp {
 
@@ -51,6 +54,19 @@ inline RequestT& setRequestKeyValue(RequestT& request, const std::string& key, c
 }
 
 
+/// Set a parameter value, the key is given as string literal.
+/// Add a key with non-empty value.
+
+template<typename RequestT, std::size_t N>
+inline RequestT& setRequestKeyValue(RequestT& request, const char (&key)[N], const std::string& value) {
+  if (N > 1 && !value.empty()) {
+    request.with(key, value);
+  }
+
+  return (request);
+}
+
+
 /// @name Realtime
 /// @{
 template<typename RequestT>
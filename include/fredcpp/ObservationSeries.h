@@ -0,0 +1,140 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_OBSERVATIONSERIES_H_
+#define FREDCPP_OBSERVATIONSERIES_H_
+
+/// @file
+/// Defines fredcpp::ObservationSeries to store series observations compactly.
+
+
+#include <fredcpp/ApiResponse.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace fredcpp {
+
+
+/// Typed container of series observations.
+/// Stores observation dates as day numbers and values as `double`, instead
+/// of an ApiEntity with string attributes per observation.
+///
+/// - dates are days since 1970-01-01 (see ObservationSeries::toDayNumber)
+/// - missing values (reported by FRED as ".") are stored as NaN
+/// - realtime period is stored once while it is the same for all observations
+///
+/// Fill it directly from the parser by passing it as the entity handler to
+/// Api::get for a `series/observations` request:
+///
+///     ObservationSeries series;
+///     api.get(ApiRequestBuilder::SeriesObservations("GDP"), response, series);
+///
+/// @see ApiRequestBuilder::SeriesObservations
+
+class ObservationSeries : public ApiEntityHandler {
+public:
+  /// Days since 1970-01-01, 32-bit.
+  typedef int DayNumber;
+
+  static const DayNumber INVALID_DAY;
+
+  ObservationSeries();
+  virtual ~ObservationSeries();
+
+  std::size_t size() const;
+  bool empty() const;
+
+  DayNumber date(std::size_t n) const;
+  double value(std::size_t n) const;
+  /// Tests whether the observation value is missing.
+  bool isMissing(std::size_t n) const;
+
+  DayNumber realtimeStart(std::size_t n) const;
+  DayNumber realtimeEnd(std::size_t n) const;
+  /// Tests whether all observations share the same realtime period.
+  bool hasConstantRealtime() const;
+
+  const std::vector<DayNumber>& dates() const;
+  const std::vector<double>& values() const;
+
+  /// Appends an observation.
+  void append(DayNumber date, double value, DayNumber realtimeStart, DayNumber realtimeEnd);
+
+  void reserve(std::size_t count);
+  void clear();
+
+  /// @name ApiEntityHandler
+  /// Appends `observation` entities, other entities are ignored.
+  /// @{
+  void onEntity(const ApiEntity& entity);
+  void onReset();
+  /// @}
+
+  /// Replaces observations with the entities of a parsed `series/observations`
+  /// response, decoding each attribute column with the column decoders.
+  void assign(const ApiResponse& response);
+
+  /// @name Column decoders
+  /// Decode the named attribute of each entity into a packed array, same as
+  /// ObservationSeries::toDayNumber and ObservationSeries::toValue do for a
+  /// single value. A missing attribute decodes as INVALID_DAY or NaN.
+  /// @{
+  static void toDayNumbers(const std::vector<ApiEntity>& entities, const std::string& name,
+                           std::vector<DayNumber>& result);
+  static void toValues(const std::vector<ApiEntity>& entities, const std::string& name,
+                       std::vector<double>& result);
+  /// @}
+
+  /// Converts `YYYY-MM-DD` date to day number, INVALID_DAY if malformed.
+  static DayNumber toDayNumber(const std::string& date);
+  /// Converts day number to `YYYY-MM-DD` date.
+  static std::string toDateString(DayNumber day);
+  /// Converts observation value to `double`, NaN if missing or malformed,
+  /// including a number followed by other characters.
+  static double toValue(const std::string& value);
+
+  virtual std::ostream& print(std::ostream& os) const;
+
+
+private:
+  static const std::string ENTITY_OBSERVATION;
+
+  std::vector<DayNumber> dates_;
+  std::vector<double> values_;
+
+  // realtime period is kept per observation only once it starts to vary
+  DayNumber realtimeStart_;
+  DayNumber realtimeEnd_;
+  std::vector<DayNumber> realtimeStarts_;
+  std::vector<DayNumber> realtimeEnds_;
+};
+
+std::ostream& operator<< (std::ostream& os, const ObservationSeries& object);
+
+} // namespace fredcpp
+
+#endif // FREDCPP_OBSERVATIONSERIES_H_
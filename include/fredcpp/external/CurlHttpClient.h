@@ -33,10 +33,14 @@
 
 #include <fredcpp/internal/HttpRequestExecutor.h>
 #include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/RetryPolicy.h>
 
 #include <curl/curl.h>
 
+#include <cstddef>
+#include <mutex>
 #include <string>
+#include <vector>
 
 
 namespace fredcpp {
@@ -45,11 +49,39 @@ namespace external {
 
 /// HTTP Request Executor Facility instance for `cURL` stack.
 ///
+/// Keeps warm `cURL` handles between requests, so that live connections,
+/// DNS and TLS-session caches are reused by consecutive requests to the same
+/// host. Idle connections are dropped after the configured idle limit.
+///
+/// Responses are requested compressed with any encoding `cURL` supports
+/// (gzip, deflate, brotli), and decompressed as they stream in.
+///
+/// Failed requests are re-tried as decided by the retry policy, with
+/// exponentially growing, jittered delays. Besides the HTTP statuses accepted
+/// by the policy, network issues (time-out, DNS and connect failures) are
+/// re-tried as well.
+///
+/// The client is thread-safe once configured: each request takes a handle
+/// from the pool for its duration, DNS and TLS-session caches are shared under
+/// locks. Connections are kept per handle (and per multi handle of
+/// CurlMultiHttpClient), so concurrent requests open their own connections.
+///
 class CurlHttpClient : public internal::HttpRequestExecutor {
 public:
   /// `cURL` write_data callback type.
   typedef std::size_t (*WriteDataCallback)(void* buf, std::size_t size, std::size_t nmemb, void* userp);
 
+  /// Connection reuse and transfer counters.
+  struct ConnectionStats {
+    unsigned long requests;
+    unsigned long reusedConnections;
+    unsigned long newConnections;
+    unsigned long long transferBytes;  ///< content bytes on the wire, compressed
+    unsigned long long contentBytes;   ///< content bytes after decompression
+
+    ConnectionStats();
+  };
+
   ~CurlHttpClient();
 
   static CurlHttpClient& getInstance();
@@ -57,22 +89,38 @@ public:
   /// @name Configuration Parameters
   /// @{
   CurlHttpClient& withTimeout(unsigned secs);
+  /// Sets delay before the first retry of the default retry policy.
   CurlHttpClient& withRetryWait(unsigned secs);
+  /// Sets maximum number of retries of the default retry policy.
   CurlHttpClient& withRetryCount(unsigned count);
+
+  /// Sets the retry policy, NULL restores the default one.
+  /// The policy must outlive its use by the client.
+  CurlHttpClient& withRetryPolicy(internal::RetryPolicy* policy);
   CurlHttpClient& withCACertFile(const std::string& path);
+
+  /// Sets maximum idle time for a connection to be reused, 0 disables reuse.
+  CurlHttpClient& withMaxIdle(unsigned secs);
+
+  /// Enables compressed transfer of responses, enabled by default.
+  CurlHttpClient& withCompression(bool enable);
   /// @}
 
 
   /// Executes the specified HTTP request and fills HTTP response with resulting content.
-  /// Supports re-try in case the request failed due to network issues.\n
-  /// Will time-out in case the server has not reponded within specified time.
+  /// Supports re-try in case the request failed due to network issues or
+  /// a retryable HTTP status, the calling thread waits between the retries.\n
+  /// Will time-out in case the server has not reponded within specified time,
+  /// or the deadline of the retry policy has passed.
   ///
   bool execute(const internal::HttpRequest& request, internal::HttpResponse& response);
 
+  /// Percent-encodes the URI string, the same as `curl_easy_escape` without
+  /// creating a `cURL` handle.
   std::string encodeURI(const std::string& URI);
 
   /// @{
-  /** Get `cURL` status.
+  /** Get `cURL` status of the last request of the calling thread.
   */
   CURLcode getStatus() const;
   std::string getErrorMsg() const;
@@ -80,30 +128,91 @@ public:
 
   const std::string& getCACertFile() const;
 
+  bool compressionEnabled() const;
 
-private:
+  const internal::RetryPolicy& getRetryPolicy() const;
+
+  /// @{
+  /** Get connection reuse and transfer counters.
+  */
+  ConnectionStats getConnectionStats() const;
+  void resetConnectionStats();
+  /// @}
+
+
+protected:
   CurlHttpClient();
+
+  /// Sets request options on a `cURL` handle, content and headers are written to the response.
+  /// The request headers list must stay valid until the transfer completes.
+  CURLcode setupHandle(CURL* curl, const std::string& URI, bool isHttps, curl_slist* headers, internal::HttpResponse& response, char* errorBuf);
+
+  /// Builds `cURL` list of request headers, NULL if none; caller frees with `curl_slist_free_all`.
+  static curl_slist* makeHeaderList(const internal::HttpRequest& request);
+
+  /// Sets response http-status, content-type and transfer size from a completed transfer.
+  void readResponseInfo(CURL* curl, internal::HttpResponse& response);
+
+  /// Constructs request string from the encoded query kept by the request.
+  std::string getRequestString(const internal::HttpRequest& request);
+
+  void appendEncodedURI(std::string& buf, const std::string& URI);
+
+  /// Tests whether a failed transfer is worth retrying (network issues).
+  static bool isTransientError(CURLcode status);
+
+  /// Tests whether a completed or failed transfer is worth retrying.
+  bool isRetryable(CURLcode status, const internal::HttpResponse& response) const;
+
+  /// Shortens the transfer time-out to the time left before the deadline.
+  /// @param elapsedMillis time since the request was first started.
+  CURLcode limitTimeout(CURL* curl, unsigned long long elapsedMillis) const;
+
+  /// @{
+  /** Take a reset handle from the pool and return it when done.
+  */
+  CURL* acquireHandle();
+  void releaseHandle(CURL* curl);
+  /// @}
+
+  internal::RetryPolicy defaultRetryPolicy_;
+  internal::RetryPolicy* retryPolicy_;
+
+
+private:
   CurlHttpClient(const CurlHttpClient&);
   CurlHttpClient& operator= (const CurlHttpClient&);
 
+  void updateConnectionStats(CURL* curl, const internal::HttpResponse& response);
+
   static internal::HttpResponse::HttpStatus httpStatusFromCode(long code);
+  static void lockShare(CURL* curl, curl_lock_data data, curl_lock_access access, void* userp);
+  static void unlockShare(CURL* curl, curl_lock_data data, void* userp);
   static std::size_t writeData(void* buf, std::size_t size, std::size_t nmemb, void* userp);
+  static std::size_t readHeader(char* buf, std::size_t size, std::size_t nitems, void* userp);
 
   static const unsigned DEFAULT_TIMEOUT_SECS;
-  static const unsigned DEFAULT_RETRY_WAIT_SECS;
-  static const unsigned DEFAULT_RETRY_MAX_COUNT;
+  static const unsigned DEFAULT_MAX_IDLE_SECS;
+  static const std::size_t QUERY_SIZE_HINT;
 
   static const std::string DEFAULT_CA_CERT_FILE;
   static const std::string ENV_CA_CERT_FILE;
 
   long timeoutSecs_;
-  unsigned retryWaitSecs_;
-  unsigned retryMaxCount_;
+  long maxIdleSecs_;
+  bool compression_;
   std::string CACertFile_;
 
+  std::vector<CURL*> handles_;   ///< idle handles
+  std::mutex handlesMutex_;
+
+  CURLSH* share_;
+  std::mutex shareLocks_[CURL_LOCK_DATA_LAST];
+
+  ConnectionStats connectionStats_;
+  mutable std::mutex statsMutex_;
+
   WriteDataCallback writeDataCallback_;
-  CURLcode CURLStatus_;
-  char errorBuf_[CURL_ERROR_SIZE];
 };
 
 } // namespace external
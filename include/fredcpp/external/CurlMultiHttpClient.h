@@ -0,0 +1,100 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_EXTERNAL_CURLMULTIHTTPCLIENT_H_
+#define FREDCPP_EXTERNAL_CURLMULTIHTTPCLIENT_H_
+
+/// @file
+/// Defines `fredcpp` concurrent HTTP Request Executor Facility for `cURL` stack.
+
+
+#include <fredcpp/external/CurlHttpClient.h>
+
+#include <curl/curl.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace fredcpp {
+namespace external {
+
+
+/// Concurrent HTTP Request Executor Facility instance for `cURL` stack.
+/// Executes a batch of requests over a single `cURL` multi event loop, keeping
+/// up to the configured number of requests in flight.\n
+/// Single requests are executed as with CurlHttpClient.
+///
+/// Concurrent batches of several threads run their own event loops.
+///
+/// @see Api::getBatch
+
+class CurlMultiHttpClient : public CurlHttpClient {
+public:
+  ~CurlMultiHttpClient();
+
+  static CurlMultiHttpClient& getInstance();
+
+  /// @name Configuration Parameters
+  /// @{
+  CurlMultiHttpClient& withMaxInFlight(unsigned count);
+  /// @}
+
+  unsigned getMaxInFlight() const;
+
+
+  /// Executes the batch of HTTP requests concurrently.
+  /// Each response is passed to the handler as soon as its request completes.\n
+  /// Failed requests are re-queued as decided by the retry policy; they wait
+  /// for the retry without blocking the other requests in flight.\n
+  /// New requests are started only as fast as the rate limiter allows.
+  bool executeBatch(const internal::HttpRequestVector& requests, internal::HttpResponseHandler& handler, internal::RateLimiter* rateLimiter);
+
+
+private:
+  struct Transfer; // forward
+
+  CurlMultiHttpClient();
+  CurlMultiHttpClient(const CurlMultiHttpClient&);
+  CurlMultiHttpClient& operator= (const CurlMultiHttpClient&);
+
+  CURLM* acquireMulti();
+  void releaseMulti(CURLM* multi);
+
+  /// Starts the request, elapsed time since its first start limits the time-out.
+  bool startTransfer(CURLM* multi, Transfer& transfer, const internal::HttpRequest& request, std::size_t index, unsigned long long elapsedMillis);
+
+  static const unsigned DEFAULT_MAX_IN_FLIGHT;
+  static const int WAIT_TIMEOUT_MILLIS;
+
+  std::vector<CURLM*> multis_;   ///< idle multi handles
+  std::mutex multisMutex_;
+  unsigned maxInFlight_;
+};
+
+} // namespace external
+} // namespace fredcpp
+
+#endif // FREDCPP_EXTERNAL_CURLMULTIHTTPCLIENT_H_
@@ -0,0 +1,181 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_EXTERNAL_DISKCACHEHTTPCLIENT_H_
+#define FREDCPP_EXTERNAL_DISKCACHEHTTPCLIENT_H_
+
+/// @file
+/// Defines `fredcpp` on-disk caching HTTP Request Executor Facility.
+///
+
+
+#include <fredcpp/internal/HttpRequestExecutor.h>
+#include <fredcpp/internal/HttpResponse.h>
+
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace fredcpp {
+namespace external {
+
+
+/// On-disk caching HTTP Request Executor Facility.
+/// Wraps another executor and keeps the content of successful responses in
+/// files of a local cache directory.
+///
+/// Entries are keyed by the request string with the `api_key` parameter
+/// removed, so the cache may be shared between API keys. A cached entry is
+/// served from disk while it is fresh, as set by the time-to-live of its
+/// endpoint. A stale entry is revalidated with a conditional request
+/// (`If-None-Match`, `If-Modified-Since`) when the server supplied an
+/// `ETag` or `Last-Modified` header; otherwise it is fetched again.
+///
+/// Usage:
+/// @code
+///   DiskCacheHttpClient cache(CurlHttpClient::getInstance(), ".fredcpp-cache");
+///   cache.withTTL("category/children", 7 * 24 * 3600);
+///
+///   api.withExecutor(cache);
+/// @endcode
+///
+/// @attention Content of a response is buffered before passing it on to
+/// a content sink, so streaming parsing does not overlap with the transfer.
+
+class DiskCacheHttpClient : public internal::HttpRequestExecutor {
+public:
+  /// Cache effectiveness counters.
+  struct CacheStats {
+    unsigned long hits;         ///< served from disk without a request
+    unsigned long revalidated;  ///< served from disk after not-modified response
+    unsigned long misses;       ///< content fetched with a request
+    unsigned long stores;       ///< entries written to disk
+
+    CacheStats();
+  };
+
+  /// Cache is kept in the specified directory, created when it does not exist.
+  DiskCacheHttpClient(internal::HttpRequestExecutor& executor, const std::string& directory);
+  ~DiskCacheHttpClient();
+
+  /// @name Configuration Parameters
+  /// @{
+  /// Sets time-to-live of the entries of the endpoint (e.g. "series/observations").
+  /// An endpoint matches the trailing path of request URI, the longest match wins.
+  DiskCacheHttpClient& withTTL(const std::string& endpoint, unsigned secs);
+  /// Sets time-to-live of the entries with no matching endpoint.
+  DiskCacheHttpClient& withDefaultTTL(unsigned secs);
+  /// Excludes the query parameter from the cache key.
+  DiskCacheHttpClient& withIgnoredParam(const std::string& name);
+  /// @}
+
+
+  /// Executes HTTP request, serving the content from cache when possible.
+  bool execute(const internal::HttpRequest& request, internal::HttpResponse& response);
+
+  /// Executes HTTP request, serving the content from cache when possible;
+  /// a rate limiter token is acquired only for a request to the wrapped executor.
+  bool executeLimited(const internal::HttpRequest& request, internal::HttpResponse& response, internal::RateLimiter* rateLimiter);
+
+  /// Executes a batch of HTTP requests, serving fresh entries from cache and
+  /// passing the rest to the wrapped executor as a batch.
+  bool executeBatch(const internal::HttpRequestVector& requests, internal::HttpResponseHandler& handler, internal::RateLimiter* rateLimiter);
+
+  /// Encodes URI using the wrapped executor.
+  std::string encodeURI(const std::string& URI);
+
+  /// Removes cached entry of the request.
+  /// @return true when the entry existed.
+  bool invalidate(const internal::HttpRequest& request);
+
+  /// Gets cache key of the request: URI and encoded query without the ignored parameters.
+  std::string getCacheKey(const internal::HttpRequest& request);
+
+  const std::string& getDirectory() const;
+
+  /// @{
+  /** Get cache effectiveness counters.
+  */
+  CacheStats getCacheStats() const;
+  void resetCacheStats();
+  /// @}
+
+
+private:
+  DiskCacheHttpClient(const DiskCacheHttpClient&);
+  DiskCacheHttpClient& operator= (const DiskCacheHttpClient&);
+
+  /// Cached response with its validators.
+  struct CacheEntry {
+    std::string key;
+    std::time_t storedAt;
+    internal::HttpResponse::HttpStatus httpStatus;
+    std::string contentType;
+    std::string eTag;
+    std::string lastModified;
+    std::string content;
+
+    CacheEntry();
+    bool hasValidator() const;
+  };
+
+  class BatchHandler; // forward
+
+  std::string getEntryPath(const std::string& key) const;
+  unsigned getTTL(const internal::HttpRequest& request) const;
+  bool isFresh(const CacheEntry& entry, const internal::HttpRequest& request) const;
+
+  bool loadEntry(const std::string& path, const std::string& key, CacheEntry& entry) const;
+  bool storeEntry(const std::string& path, const CacheEntry& entry);
+
+  static void addConditions(const CacheEntry& entry, internal::HttpRequest& request);
+  static void fillResponse(const CacheEntry& entry, internal::HttpResponse& response);
+
+  /// Completes a fetch: stores or refreshes the entry and fills the response.
+  bool completeFetch(const std::string& path, CacheEntry& entry, bool isCached,
+                     const internal::HttpResponse& fetched, internal::HttpResponse& response);
+
+  void incrementStat(unsigned long& counter);
+
+  static const unsigned DEFAULT_TTL_SECS;
+  static const std::string DEFAULT_IGNORED_PARAM;
+  static const std::string ENTRY_FILE_SIGNATURE;
+
+  internal::HttpRequestExecutor& executor_;
+  std::string directory_;
+  unsigned defaultTTLSecs_;
+  std::map<std::string, unsigned> endpointTTLSecs_;
+  std::set<std::string, internal::lessNoCase> ignoredParams_;
+  CacheStats cacheStats_;
+  mutable std::mutex statsMutex_;
+};
+
+} // namespace external
+} // namespace fredcpp
+
+#endif // FREDCPP_EXTERNAL_DISKCACHEHTTPCLIENT_H_
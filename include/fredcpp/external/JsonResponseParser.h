@@ -0,0 +1,91 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef FREDCPP_EXTERNAL_JSONRESPONSEPARSER_H_
+#define FREDCPP_EXTERNAL_JSONRESPONSEPARSER_H_
+
+/// @file
+/// Defines `fredcpp` JSON Response Parser Facility.
+///
+
+
+#include <fredcpp/internal/ResponseParser.h>
+
+#include <string>
+
+
+namespace fredcpp {
+namespace external {
+
+
+/// JSON Response Parser Facility.
+/// Parses FRED API responses requested with `file_type=json` into the same
+/// ApiResponse as the XML parsers do:
+///
+/// - scalar members of the top-level object become result attributes
+/// - the array member becomes the entities, named by the array name in
+///   singular (`observations` -> `observation`, `seriess` -> `series`);
+///   members of its objects become entity attributes, plain array values
+///   become entity values
+/// - an error response (`error_code`, `error_message`) becomes the `error`
+///   result with `code` and `message` attributes
+///
+/// Numbers, booleans and nulls are kept as their text, nested values within
+/// entities are skipped. The content is scanned in a single pass without
+/// building a document.
+///
+///     api.withParser( fredcpp::external::JsonResponseParser::getInstance() )
+///        .withFileType( "json" );
+///
+/// The parser is thread-safe.
+
+class JsonResponseParser : public internal::ResponseParser {
+public:
+  ~JsonResponseParser();
+
+  static JsonResponseParser& getInstance();
+
+  /// Accepts JSON content (`application/json`).
+  bool accepts(const std::string& contentType) const;
+
+  bool parse(std::istream& json, ApiResponse& response);
+  bool parseInPlace(char* json, std::size_t size, ApiResponse& response);
+
+  /// Gets name of the entities of the named array.
+  static std::string getEntityName(const std::string& arrayName);
+
+
+private:
+  JsonResponseParser();
+  JsonResponseParser(const JsonResponseParser&);
+  JsonResponseParser& operator= (const JsonResponseParser&);
+
+  class Reader; // forward
+
+  static const std::size_t READ_CHUNK_SIZE;
+};
+
+} // namespace external
+} // namespace fredcpp
+
+#endif // FREDCPP_EXTERNAL_JSONRESPONSEPARSER_H_
@@ -35,6 +35,10 @@
 
 #include <fredcpp/third_party/pugixml/pugixml.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
 
 namespace fredcpp {
 namespace external {
@@ -42,22 +46,80 @@ namespace external {
 
 /// XML Response Parser Facility instance for `pugixml` parser.
 ///
+/// The parse buffer is kept for reuse by the next parse of the same thread,
+/// up to the configured high-water mark; the content is parsed in place, with
+/// no further copy.
+///
+/// `pugixml` frees its memory pages with each document. To keep the pages
+/// for reuse by the next parses, install the page pool with
+/// `installMemoryPool()` before any `pugixml` document is created; otherwise
+/// `pugixml` memory management is left as is.
+///
+/// The parser is thread-safe: each thread parses with its own document and
+/// buffer.
+
 class PugiXmlParser : public internal::XmlResponseParser {
 public:
+  /// Parsing statistics.
+  struct ParseStats {
+    ParseStats();
+
+    unsigned long long parses;
+    unsigned long long bytesParsed;
+    unsigned long long parseMicros;
+  };
+
   ~PugiXmlParser();
 
   static PugiXmlParser& getInstance();
 
+  /// Installs the `pugixml` page pool, keeping memory pages of released
+  /// documents for reuse up to the high-water mark.
+  /// Replaces `pugixml` memory management functions of the program, call once
+  /// at start-up before any `pugixml` document is created (e.g. at the start of
+  /// `main`). Pages are allocated with the functions in place at install time.
+  static void installMemoryPool();
+
+  /// Sets maximum memory in bytes kept for reuse between parses, for the parse
+  /// buffer of each thread and for the installed page pool.
+  PugiXmlParser& withMemoryHighWaterMark(std::size_t bytes);
+  std::size_t getMemoryHighWaterMark() const;
+
+  /// Memory in bytes currently kept for reuse by the calling thread,
+  /// including the pages kept by the page pool.
+  std::size_t getPooledMemory() const;
+  /// Releases memory kept for reuse by the calling thread and the pages kept
+  /// by the page pool.
+  void releaseMemory();
+
   bool parse(std::istream& xml, ApiResponse& response);
 
-  /// `pugixml` status.
+  /// Parses the buffer in place with `pugixml`, no copy of the content is made.
+  /// The buffer content is modified by parsing.
+  bool parseInPlace(char* xml, std::size_t size, ApiResponse& response);
+
+  /// `pugixml` status of the last parse of the calling thread.
   pugi::xml_parse_result getParseResult() const;
 
+  /// Statistics of the last parse of the calling thread.
+  const ParseStats& getLastParseStats() const;
+  /// Statistics accumulated over all parses.
+  ParseStats getTotalParseStats() const;
+  void resetParseStats();
+
 
 private:
   PugiXmlParser();
 
-  pugi::xml_parse_result parseResult_;
+  bool parseDocument(char* xml, std::size_t size, ApiResponse& response);
+  bool readDocument(const pugi::xml_document& doc, ApiResponse& response);
+
+  static const std::size_t DEFAULT_MEMORY_HIGH_WATER_MARK;
+
+  std::atomic<std::size_t> highWaterMark_;
+
+  ParseStats totalStats_;
+  mutable std::mutex statsMutex_;
 
 };
 
@@ -0,0 +1,113 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_EXTERNAL_RECORDINGHTTPCLIENT_H_
+#define FREDCPP_EXTERNAL_RECORDINGHTTPCLIENT_H_
+
+/// @file
+/// Defines `fredcpp` recording HTTP Request Executor Facility.
+///
+
+
+#include <fredcpp/internal/HttpRequestExecutor.h>
+
+#include <fstream>
+#include <mutex>
+#include <string>
+
+
+namespace fredcpp {
+
+namespace internal {
+struct ReplayRecord; // forward
+}
+
+namespace external {
+
+
+/// Recording HTTP Request Executor Facility.
+/// Wraps another executor and appends each received response, with the key
+/// of its request, to a replay archive (see internal::ReplayArchive).
+/// The archive is then served by ReplayHttpClient with no network.
+///
+/// Usage:
+/// @code
+///   RecordingHttpClient recorder(CurlHttpClient::getInstance(), "fred.replay");
+///   api.withExecutor(recorder);
+/// @endcode
+///
+/// Responses that failed without an HTTP status (e.g. connection failure)
+/// are not recorded. The `api_key` parameter is not part of the record.
+///
+/// Thread-safe, records of concurrent requests are written whole.
+///
+/// @attention Content of a response is buffered before passing it on to
+/// a content sink, so streaming parsing does not overlap with the transfer.
+
+class RecordingHttpClient : public internal::HttpRequestExecutor {
+public:
+  /// Records to the archive file, appending to it when it exists.
+  RecordingHttpClient(internal::HttpRequestExecutor& executor, const std::string& archivePath);
+  ~RecordingHttpClient();
+
+  /// Tests whether the archive is open for recording.
+  bool good() const;
+
+  /// Executes HTTP request with the wrapped executor and records the response.
+  bool execute(const internal::HttpRequest& request, internal::HttpResponse& response);
+
+  /// Executes a batch of HTTP requests with the wrapped executor, recording
+  /// each response as it completes.
+  bool executeBatch(const internal::HttpRequestVector& requests, internal::HttpResponseHandler& handler, internal::RateLimiter* rateLimiter);
+
+  /// Encodes URI using the wrapped executor.
+  std::string encodeURI(const std::string& URI);
+
+  const std::string& getArchivePath() const;
+  /// Number of responses recorded by this executor.
+  unsigned long getRecordCount() const;
+
+
+private:
+  RecordingHttpClient(const RecordingHttpClient&);
+  RecordingHttpClient& operator= (const RecordingHttpClient&);
+
+  class BatchHandler; // forward
+
+  /// Records the response, then copies it to the target response.
+  bool record(const internal::HttpRequest& request, const internal::HttpResponse& fetched,
+              internal::HttpResponse& response);
+  void writeRecord(const internal::ReplayRecord& record);
+
+  internal::HttpRequestExecutor& executor_;
+  std::string archivePath_;
+  std::ofstream archive_;
+  unsigned long recordCount_;
+  mutable std::mutex mutex_;
+};
+
+} // namespace external
+} // namespace fredcpp
+
+#endif // FREDCPP_EXTERNAL_RECORDINGHTTPCLIENT_H_
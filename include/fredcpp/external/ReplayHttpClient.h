@@ -0,0 +1,163 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_EXTERNAL_REPLAYHTTPCLIENT_H_
+#define FREDCPP_EXTERNAL_REPLAYHTTPCLIENT_H_
+
+/// @file
+/// Defines `fredcpp` replaying HTTP Request Executor Facility.
+///
+
+
+#include <fredcpp/internal/HttpRequestExecutor.h>
+#include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/ReplayArchive.h>
+
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace fredcpp {
+namespace external {
+
+
+/// Replaying HTTP Request Executor Facility.
+/// Serves responses recorded by RecordingHttpClient from memory, with no
+/// network. A request is matched by its key (see internal::ReplayArchive),
+/// a request with no record gets HTTP_NOT_FOUND.
+///
+/// Faults can be injected to test the handling of a slow or unreliable
+/// service: latency, HTTP errors and transfer failures drawn at the configured
+/// rates. Draws come from a seeded generator, so a run can be repeated.
+///
+/// Usage:
+/// @code
+///   ReplayHttpClient replay("fred.replay");
+///   replay.withLatency(20, 80)
+///         .withErrorRate(0.01, internal::HttpResponse::HTTP_SERVICE_UNAVAILABLE);
+///
+///   api.withExecutor(replay);
+/// @endcode
+///
+/// Thread-safe for executing requests; load records before executing.
+
+class ReplayHttpClient : public internal::HttpRequestExecutor {
+public:
+  /// Replay counters.
+  struct ReplayStats {
+    unsigned long replayed;         ///< served from a record
+    unsigned long misses;           ///< no record of the request
+    unsigned long injectedErrors;   ///< HTTP error injected
+    unsigned long injectedFailures; ///< transfer failure injected
+
+    ReplayStats();
+  };
+
+  ReplayHttpClient();
+  /// Loads records of the archive (see ReplayHttpClient::load).
+  explicit ReplayHttpClient(const std::string& archivePath);
+  ~ReplayHttpClient();
+
+  /// Loads records of the archive, adding to the loaded ones.
+  /// A later record of a request replaces the earlier one.
+  /// @return false when the archive can't be read or is malformed.
+  bool load(const std::string& archivePath);
+  /// Adds the record, replacing the one of the same key.
+  void add(const internal::ReplayRecord& record);
+  /// Removes all records.
+  void clear();
+  /// Number of records.
+  std::size_t size() const;
+
+  /// @name Fault Injection
+  /// @{
+  /// Delays each response by a uniformly drawn time.
+  ReplayHttpClient& withLatency(unsigned long minMillis, unsigned long maxMillis);
+  /// Replaces the response by an HTTP error of the status at the rate (0..1).
+  /// May be set for several statuses; the total of all rates is at most 1.
+  ReplayHttpClient& withErrorRate(double rate, internal::HttpResponse::HttpStatus status);
+  /// Fails the request with no response (like a lost connection) at the rate.
+  ReplayHttpClient& withFailureRate(double rate);
+  /// Restarts the draws from the seed.
+  ReplayHttpClient& withSeed(unsigned long seed);
+  /// Removes all injected faults.
+  ReplayHttpClient& withoutFaults();
+  /// @}
+
+
+  /// Executes HTTP request by replaying its recorded response.
+  bool execute(const internal::HttpRequest& request, internal::HttpResponse& response);
+
+  /// Encodes URI, percent-encoding all but the unreserved characters.
+  std::string encodeURI(const std::string& URI);
+
+  /// @{
+  /** Get replay counters.
+  */
+  ReplayStats getReplayStats() const;
+  void resetReplayStats();
+  /// @}
+
+
+protected:
+  void appendEncodedURI(std::string& buf, const std::string& URI);
+
+
+private:
+  ReplayHttpClient(const ReplayHttpClient&);
+  ReplayHttpClient& operator= (const ReplayHttpClient&);
+
+  typedef enum {
+    FAULT_NONE = 0,
+    FAULT_ERROR,
+    FAULT_FAILURE
+  } Fault;
+
+  /// Draws the fault and the latency of a request.
+  Fault drawFault(internal::HttpResponse::HttpStatus& errorStatus, unsigned long& latencyMillis);
+
+  static void fillError(internal::HttpResponse::HttpStatus status, internal::HttpResponse& response);
+
+  typedef std::map<std::string, internal::ReplayRecord> RecordMap;
+  typedef std::vector<std::pair<double, internal::HttpResponse::HttpStatus> > ErrorRateVector;
+
+  RecordMap records_;
+
+  unsigned long minLatencyMillis_;
+  unsigned long maxLatencyMillis_;
+  double failureRate_;
+  ErrorRateVector errorRates_;
+  std::mt19937 random_;
+
+  ReplayStats replayStats_;
+  mutable std::mutex mutex_;
+};
+
+} // namespace external
+} // namespace fredcpp
+
+#endif // FREDCPP_EXTERNAL_REPLAYHTTPCLIENT_H_
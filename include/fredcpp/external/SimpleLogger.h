@@ -32,6 +32,14 @@
 
 
 #include <fredcpp/internal/Logger.h>
+#include <fredcpp/internal/LogRing.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 
 namespace fredcpp {
@@ -45,6 +53,9 @@ public:
   LogChannel(internal::LogLevel::Level level = internal::LogLevel::LOG_NULL, std::ostream& os = std::cout);
 
   void writeLine(const std::string& str);
+  /// Writes lines as is, without flushing.
+  void write(const std::string& lines);
+  void flush();
 
   bool enable();
   bool disable();
@@ -62,7 +73,7 @@ private:
 
   std::ostream* osPtr_;
   internal::LogLevel::Level level_;
-  bool enabled_;
+  std::atomic<bool> enabled_;
 };
 
 //______________________________________________________________________________
@@ -99,11 +110,33 @@ private:
 /// - multiple logging priority levels
 /// - output to standard or file streams
 /// - implements fredcpp::internal::Logger interface
+/// - thread-safe, messages of concurrent threads are written whole
+/// - optional asynchronous mode: messages are queued and written by a
+///   background thread (see startAsync)
 
 class SimpleLogger : public internal::Logger {
 public:
   typedef std::ostream& (*LogFormatter)(std::ostream& os, internal::LogLevel::Level level, const std::string& message, const internal::LogContext& context);
 
+  /// What to do with a message when the asynchronous queue is full.
+  typedef enum {
+    OVERFLOW_DROP = 0,  ///< drop the message
+    OVERFLOW_BLOCK,     ///< wait until the writer makes room
+    OVERFLOW_SAMPLE     ///< wait for one of each sampling-rate messages, drop the others
+  } OverflowPolicy;
+
+  static const std::size_t DEFAULT_ASYNC_CAPACITY;
+  static const unsigned DEFAULT_SAMPLING_RATE;
+
+  /// Counters of the asynchronous mode.
+  struct AsyncStats {
+    unsigned long long queued;   ///< messages queued
+    unsigned long long written;  ///< messages written out
+    unsigned long long dropped;  ///< messages dropped on overflow
+
+    AsyncStats();
+  };
+
   ~SimpleLogger();
 
   static SimpleLogger& getInstance();
@@ -120,6 +153,24 @@ public:
   /// @}
 
 
+  /// @name Asynchronous Mode
+  /// Messages are formatted by the logging thread and queued to a lock-free
+  /// queue; a background thread writes them in batches, flushing the outputs
+  /// once per batch instead of once per message.\n
+  /// Start and stop it while not logging.
+  /// @{
+  void startAsync(std::size_t capacity = DEFAULT_ASYNC_CAPACITY,
+                  OverflowPolicy policy = OVERFLOW_DROP,
+                  unsigned samplingRate = DEFAULT_SAMPLING_RATE);
+  /// Writes out the queued messages and stops the background thread.
+  void stopAsync();
+  bool isAsync() const;
+  /// Waits until the messages queued so far are written.
+  void flush();
+  AsyncStats getAsyncStats() const;
+  /// @}
+
+
   /// @name Priority Level Toggles
   /// @{
   bool levelEnabled(internal::LogLevel::Level level) const;
@@ -158,10 +209,39 @@ private:
 
   bool requireValidLevel(internal::LogLevel::Level level) const;
 
+  void enqueue(internal::LogLevel::Level level, const std::string& line);
+  void waitForRoom(internal::LogLevel::Level level, const std::string& line);
+  void wakeWriter();
+  void runWriter();
+  std::size_t writeBatch(internal::LogRecord& record, std::string& lines);
+
+  static const std::size_t MAX_BATCH_SIZE;
+  static const unsigned WRITER_IDLE_WAIT_MILLIS;
+  static const std::size_t WRITER_WAKE_DEPTH;
+
 
   LogChannel channels_[internal::LogLevel::maxLevel];
   LogFile files_[internal::LogLevel::maxLevel];
   LogFormatter formatter_;
+
+  std::recursive_mutex outputMutex_;  ///< guards channel outputs and files
+
+  std::unique_ptr<internal::LogRing> ring_;
+  std::thread writer_;
+  std::atomic<bool> async_;
+  std::atomic<bool> stopping_;
+  std::atomic<bool> writerIdle_;
+  OverflowPolicy overflowPolicy_;
+  unsigned samplingRate_;
+  std::size_t wakeDepth_;
+
+  std::mutex asyncMutex_;                 ///< guards waiting for the writer
+  std::condition_variable writerWake_;    ///< messages queued, or stopping
+  std::condition_variable batchWritten_;  ///< room made in the queue
+
+  std::atomic<unsigned long long> writtenCount_;
+  std::atomic<unsigned long long> droppedCount_;
+  std::atomic<unsigned long long> overflowCount_;
 };
 
 /// Default Log Formatter.
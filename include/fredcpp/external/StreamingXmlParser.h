@@ -0,0 +1,88 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_EXTERNAL_STREAMINGXMLPARSER_H_
+#define FREDCPP_EXTERNAL_STREAMINGXMLPARSER_H_
+
+/// @file
+/// Defines `fredcpp` streaming XML Response Parser Facility.
+///
+
+
+#include <fredcpp/internal/XmlResponseParser.h>
+#include <fredcpp/ApiResponse.h>
+
+#include <string>
+#include <vector>
+
+
+namespace fredcpp {
+namespace external {
+
+
+/// Streaming XML Response Parser Facility.
+/// Parses the content incrementally as it arrives, keeping only the element
+/// being parsed in memory. Each entity is passed on as soon as its element
+/// completes.
+///
+/// Supports the flat XML schema of FRED API responses: the result element
+/// contains entity elements with attributes and optional text.
+/// DTD and namespaces are not processed.
+///
+/// Use with Api::get overload taking an ApiEntityHandler to overlap parsing
+/// with the network transfer.
+///
+/// The parser is thread-safe, each thread parses with its own context.
+
+class StreamingXmlParser : public internal::XmlResponseParser {
+public:
+  ~StreamingXmlParser();
+
+  static StreamingXmlParser& getInstance();
+
+  bool parse(std::istream& xml, ApiResponse& response);
+  bool parseInPlace(char* xml, std::size_t size, ApiResponse& response);
+
+  void beginParse(ApiResponse& response, ApiEntityHandler* handler);
+  bool parseChunk(const char* xml, std::size_t size);
+  bool endParse();
+
+
+private:
+  StreamingXmlParser();
+
+  class ParseContext;  // forward
+
+  /// Gets parse context of the calling thread.
+  static ParseContext& getContext();
+
+  static void appendDecoded(std::string& out, const char* begin, const char* end, bool isAttribute);
+
+  static const std::size_t READ_CHUNK_SIZE;
+};
+
+} // namespace external
+} // namespace fredcpp
+
+#endif // FREDCPP_EXTERNAL_STREAMINGXMLPARSER_H_
@@ -35,6 +35,9 @@
 #include <fredcpp/Api.h>
 #include <fredcpp/ApiRequestBuilder.h>
 #include <fredcpp/ApiResponse.h>
+#include <fredcpp/ApiResponseCache.h>
+#include <fredcpp/CategoryCrawler.h>
 #include <fredcpp/ApiLog.h>
+#include <fredcpp/ObservationSeries.h>
 
 #endif // FREDCPP_H_
@@ -0,0 +1,164 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_INTERNAL_ATTRIBUTEMAP_H_
+#define FREDCPP_INTERNAL_ATTRIBUTEMAP_H_
+
+/// @file
+/// Defines flat attribute collection with interned attribute names.
+
+
+#include <fredcpp/internal/utils.h>
+
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace fredcpp {
+namespace internal {
+
+
+/// Interned string.
+/// Refers to a single shared copy of the string kept in SymbolTable,
+/// so copying a symbol does not allocate.
+
+class Symbol {
+public:
+  explicit Symbol(const std::string* str = NULL);
+
+  const std::string& str() const;
+  operator const std::string& () const;
+
+  bool operator== (const Symbol& rhs) const;
+  bool operator!= (const Symbol& rhs) const;
+
+private:
+  const std::string* str_;
+};
+
+std::ostream& operator<< (std::ostream& os, const Symbol& symbol);
+
+//______________________________________________________________________________
+
+
+/// Table of interned strings.
+/// Strings are matched case-insensitively; the first interned spelling is kept.
+/// Interned strings are never released, intended for a bounded set of names
+/// (e.g. FRED XML attribute names).
+///
+/// Thread-safe; symbols stay valid for the lifetime of the process.
+
+class SymbolTable {
+public:
+  static SymbolTable& getInstance();
+
+  /// Returns the symbol of the string, interns the string if not found.
+  /// Symbols are looked up first in a per-thread cache, so that repeated
+  /// names take no lock; the cache is bounded.
+  Symbol intern(const std::string& str);
+
+  /// Returns the symbol of a string literal.
+  /// Literals are looked up by address in a per-thread LiteralCache first.
+  Symbol internLiteral(const char* literal);
+
+  /// Finds the symbol of the string, without interning it.
+  /// @return false if the string has not been interned.
+  bool find(const std::string& str, Symbol& symbol) const;
+
+  std::size_t size() const;
+
+private:
+  SymbolTable();
+
+  std::set<std::string, lessNoCase> strings_;
+  mutable std::mutex mutex_;
+};
+
+//______________________________________________________________________________
+
+
+/// Attribute collection stored as a flat vector of (name, value) pairs.
+/// Attribute names are interned, so identical names of many entities share
+/// a single string. Pairs are kept sorted by name, matching is case-insensitive.
+///
+/// Recycled attributes (see AttributeMap::recycle) keep their slots, the value
+/// of a returning name is assigned in place; new names get new slots, so the
+/// slots kept are bounded by the names used.
+///
+/// Provides a subset of `std::map` interface (see KeyValueMap).
+
+class AttributeMap {
+public:
+  typedef std::string key_type;
+  typedef std::string mapped_type;
+  typedef std::pair<Symbol, mapped_type> value_type;
+
+  typedef std::vector<value_type>::iterator iterator;
+  typedef std::vector<value_type>::const_iterator const_iterator;
+
+  AttributeMap();
+  AttributeMap(const AttributeMap& other);
+  AttributeMap& operator= (const AttributeMap& rhs);
+
+  /// Gets value of the specified attribute, adds it if it does not exist.
+  mapped_type& operator[] (const key_type& name);
+
+  iterator find(const key_type& name);
+  const_iterator find(const key_type& name) const;
+
+  /// Removes the specified attribute.
+  void erase(const key_type& name);
+
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  std::size_t size() const;
+  bool empty() const;
+
+  void reserve(std::size_t count);
+  void clear();
+  /// Clears the attributes, keeping their slots and value memory for reuse.
+  void recycle();
+  void swap(AttributeMap& other);
+
+private:
+  iterator lowerBound(const key_type& name);
+
+  /// Attributes in [0, size_), sorted; recycled slots follow.
+  std::vector<value_type> attributes_;
+  std::size_t size_;
+};
+
+
+} // namespace internal
+} // namespace fredcpp
+
+#endif // FREDCPP_INTERNAL_ATTRIBUTEMAP_H_
@@ -32,6 +32,8 @@
 
 #include <fredcpp/internal/Request.h>
 
+#include <atomic>
+#include <cstdint>
 #include <ostream>
 #include <string>
 
@@ -41,7 +43,13 @@ namespace internal {
 
 
 /// HTTP request.
-/// Manages HTTP request URI and query parameters.
+/// Manages HTTP request URI, query parameters, and extra request headers.
+///
+/// URI and parameters may refer to the originating request instead of
+/// copying it (see withURIRef, withParamsRef); parameters added with `with`
+/// then override the referred ones. The merged parameters are built only
+/// when asked for, appendEncodedQuery reuses the encoded query of the
+/// referred request instead.
 ///
 /// @attention Currently only GET method is supported.
 
@@ -54,25 +62,71 @@ public:
 
   explicit HttpRequest(const std::string& URI = "");
   explicit HttpRequest(const std::string& URI, const Request& request);
+  HttpRequest(const HttpRequest& other);
   virtual ~HttpRequest();
 
+  HttpRequest& operator= (const HttpRequest& rhs);
+
   /// @name Configuration
   /// @{
   HttpRequest& withURI(const std::string& URI);
+  /// Sets parameters of the request, reusing its encoded query.
   HttpRequest& withParams(const Request& request);
+  /// Refers to the URI instead of copying it.
+  /// @attention The string must outlive the request.
+  HttpRequest& withURIRef(const std::string& URI);
+  /// Refers to parameters of the request instead of copying them.
+  /// @attention The request must outlive this one and stay unchanged.
+  HttpRequest& withParamsRef(const Request& request);
+  /// Sets request header value, adds it if the header does not exist.
+  HttpRequest& withHeader(const std::string& name, const std::string& value);
   /// @}
 
   const std::string& getURI() const;
+  const KeyValueMap& getHeaders() const;
   Method getMethod() const;
 
+  /// Returns referred parameters merged with own ones.
+  virtual const ParamMap& getParams() const;
+  virtual const std::string& getEncodedQuery() const;
+  virtual std::uint64_t getFingerprint() const;
+
+  /// Appends encoded query to the buffer, same as getEncodedQuery.
+  /// Reuses the encoded query of the referred request, without merging.
+  void appendEncodedQuery(std::string& buf) const;
+
+  virtual void eraseParam(const KeyValueMap::key_type& key);
+  virtual void clear();
+
   bool isHttps() const;
   virtual std::ostream& print(std::ostream& os) const;
 
+protected:
+  virtual void onParamsChange();
+
 private:
+  typedef enum {
+    MERGED_STALE = 0,
+    MERGED_BUILDING,
+    MERGED_READY
+  } MergedState;
+
+  const Request& getMerged() const;
+  void mergeParams() const;
+
+  /// Copies the referred parameters into own ones.
+  void detachParams();
+
   static const char* HTTP_METHODS[maxMethod];
 
   Method method_;
   std::string URI_;
+  const std::string* URIRef_;
+  const Request* paramsRef_;
+  KeyValueMap headers_;
+
+  mutable Request merged_;
+  mutable std::atomic<int> mergedState_;
 };
 
 
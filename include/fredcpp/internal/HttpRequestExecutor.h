@@ -29,14 +29,38 @@
 /// Defines HTTP Request Executor Facility interface.
 
 
+#include <fredcpp/internal/HttpRequest.h>
+
 #include <string>
+#include <vector>
 
 
 namespace fredcpp {
 namespace internal {
 
-class HttpRequest; // forward
 class HttpResponse; // forward
+class RateLimiter; // forward
+
+
+/// Collection of HTTP requests executed as a batch.
+typedef std::vector<HttpRequest> HttpRequestVector;
+
+
+/// HTTP Response Handler interface.
+/// Receives responses of a batch of HTTP requests as each request completes.
+///
+/// @see HttpRequestExecutor::executeBatch
+
+class HttpResponseHandler {
+public:
+  virtual ~HttpResponseHandler();
+
+  /// Called once for each request of the batch, in order of completion.
+  /// The response is valid only for the duration of the call.
+  virtual void onResponse(std::size_t index, const HttpRequest& request, HttpResponse& response) = 0;
+};
+
+//______________________________________________________________________________
 
 
 /// HTTP Request Executor Facility interface.
@@ -60,6 +84,22 @@ public:
     virtual bool execute(const HttpRequest& request, HttpResponse& response) = 0;
 
 
+  /// Executes HTTP request as execute does, limited by the rate limiter.
+  /// By default a token is acquired from the rate limiter (when specified)
+  /// before executing; implementations serving requests without the network
+  /// (e.g. from cache) acquire it only when the network is used.
+  virtual bool executeLimited(const HttpRequest& request, HttpResponse& response, RateLimiter* rateLimiter);
+
+
+  /// Executes a batch of HTTP requests and passes each response to the handler.
+  /// By default requests are executed one after another; implementations
+  /// may execute requests concurrently.\n
+  /// When a rate limiter is specified, each request is started only after
+  /// acquiring a token from it.
+  /// @return true when all requests completed with HTTP OK status.
+  virtual bool executeBatch(const HttpRequestVector& requests, HttpResponseHandler& handler, RateLimiter* rateLimiter);
+
+
   /// Encodes URI string to contain only valid characters.
   /// Converts special characters to HTTP %hex character strings.
   virtual std::string encodeURI(const std::string& URI) = 0;
@@ -71,6 +111,10 @@ protected:
   /// Appends encoded query parameters to request's URI.
   virtual std::string getRequestString(const HttpRequest& request);
 
+  /// Appends encoded URI string to the buffer.
+  /// By default appends the result of encodeURI; override to encode in place.
+  virtual void appendEncodedURI(std::string& buf, const std::string& URI);
+
   char querySeparatorChar_;
   char queryParamSeparatorChar_;
   char queryParamAssignmentChar_;
@@ -29,7 +29,11 @@
 /// Defines HTTP response object.
 
 
-#include <sstream>
+#include <fredcpp/internal/utils.h>
+
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
 #include <string>
 
 
@@ -37,8 +41,35 @@ namespace fredcpp {
 namespace internal {
 
 
+/// Receiver of HTTP response content as it arrives.
+/// Allows to process the content incrementally instead of buffering it.
+///
+/// @see HttpResponse::setContentSink
+
+class HttpContentSink {
+public:
+  virtual ~HttpContentSink();
+
+  /// Called with each next chunk of the content.
+  virtual void onContent(const char* data, std::size_t size) = 0;
+
+  /// Called when the content is cleared, e.g. before a request is re-tried.
+  /// The content received so far should be discarded.
+  virtual void onContentReset() = 0;
+};
+
+//______________________________________________________________________________
+
+
 /// HTTP response.
-/// Stores HTTP response status, content-type, and content.
+/// Stores HTTP response status, content-type, headers, and content.
+///
+/// Content is kept in a single contiguous buffer, so that parsers can read
+/// it in place without copying. When a content sink is set, the content is
+/// passed to the sink instead.
+///
+/// Content is always the decoded one; when it was transferred compressed,
+/// the executor records the size on the wire (HttpResponse::getTransferBytes).
 
 class HttpResponse {
 public:
@@ -84,6 +115,7 @@ public:
     HTTP_UNSUPPORTED_MEDIA_TYPE = 415,
     HTTP_REQUESTED_RANGE_NOT_SATISFIABLE = 416,
     HTTP_EXPECTATION_FAILED = 417,
+    HTTP_TOO_MANY_REQUESTS = 429,
 
     // SERVER-ERROR:5xx
     HTTP_INTERNAL_SERVER_ERROR = 500,
@@ -102,20 +134,70 @@ public:
 
   void setContentType(const std::string contentType);
   void setHttpStatus(HttpStatus status);
+  /// Sets response header value, adds it if the header does not exist.
+  void setHeader(const std::string& name, const std::string& value);
+
+  /// Output stream appending to the content.
+  std::ostream& getContentStream();
+  void appendContent(const char* data, std::size_t size);
+  void reserveContent(std::size_t size);
+
+  /// Sets the sink to receive the content instead of the buffer, NULL to unset.
+  void setContentSink(HttpContentSink* sink);
+
+  /// Sets size of the content as transferred, e.g. compressed.
+  void setTransferBytes(std::size_t bytes);
+
+  const std::string& getContent() const;
+  /// Content buffer for in-place processing, may be modified by the caller.
+  std::string& getContentBuffer();
 
-  std::ostringstream& getContentStream();
   const std::string& getContentType() const;
   HttpStatus getHttpStatus() const;
 
+  /// @{
+  /** Get content size: as received by the buffer or the sink, and as
+      transferred (0 if not known).
+  */
+  std::size_t getContentBytes() const;
+  std::size_t getTransferBytes() const;
+  /// @}
+
+  /// Gets value of the specified header, empty if not found.
+  std::string getHeader(const std::string& name) const;
+  const KeyValueMap& getHeaders() const;
+  void clearHeaders();
+
   bool isBadRequest() const;
   bool isXmlContent() const;
+  bool isJsonContent() const;
 
   void clear();
 
 protected:
-  std::ostringstream content_;
+  /// Stream buffer appending the written characters to the content.
+  class ContentStreamBuf : public std::streambuf {
+  public:
+    explicit ContentStreamBuf(HttpResponse& response);
+
+  protected:
+    int_type overflow(int_type c);
+    std::streamsize xsputn(const char* s, std::streamsize n);
+
+  private:
+    HttpResponse& response_;
+  };
+
+  std::string content_;
+  HttpContentSink* contentSink_;
+  ContentStreamBuf contentStreamBuf_;
+  std::ostream contentStream_;
   std::string contentType_;
   HttpStatus httpStatus_;
+  KeyValueMap headers_;
+
+  std::size_t contentBytes_;
+  std::size_t transferBytes_;
 };
 
 } // namespace internal
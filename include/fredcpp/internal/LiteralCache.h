@@ -0,0 +1,79 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_INTERNAL_LITERALCACHE_H_
+#define FREDCPP_INTERNAL_LITERALCACHE_H_
+
+/// @file
+/// Defines cache of strings interned for string literals.
+
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+
+namespace fredcpp {
+namespace internal {
+
+
+/// Cache of interned strings looked up by the address of a string literal,
+/// so that repeated use takes no lock and does not allocate.
+/// The address may be a reused buffer rather than a literal, so the cached
+/// text is matched against the string; the cache is bounded.
+///
+/// Not thread-safe, intended as a per-thread (`thread_local`) cache in front
+/// of a shared table of interned strings.
+
+class LiteralCache {
+public:
+  /// Matches interned text with a string.
+  typedef bool (*MatchFunction)(const std::string& interned, const char* str);
+
+  explicit LiteralCache(MatchFunction matches);
+
+  /// Finds the interned string cached for the address.
+  /// @return NULL when not cached, or the cached text does not match.
+  const std::string* find(const char* literal) const;
+
+  /// Caches the interned string for the address.
+  void insert(const char* literal, const std::string* interned);
+
+  std::size_t size() const;
+
+  /// Matches text exactly.
+  static bool equals(const std::string& interned, const char* str);
+
+private:
+  static const std::size_t MAX_CACHED_LITERALS;
+
+  std::map<const char*, const std::string*> literals_;
+  MatchFunction matches_;
+};
+
+
+} // namespace internal
+} // namespace fredcpp
+
+#endif // FREDCPP_INTERNAL_LITERALCACHE_H_
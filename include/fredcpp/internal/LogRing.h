@@ -0,0 +1,106 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_INTERNAL_LOGRING_H_
+#define FREDCPP_INTERNAL_LOGRING_H_
+
+/// @file
+/// Defines bounded lock-free queue of log records.
+
+
+#include <fredcpp/internal/Logger.h>
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace fredcpp {
+namespace internal {
+
+
+/// Formatted log record.
+
+struct LogRecord {
+  LogLevel::Level level;
+  std::string line;
+
+  LogRecord();
+};
+
+//______________________________________________________________________________
+
+
+/// Bounded queue of log records, for many producers and a single consumer.
+/// Lock-free: each slot carries a sequence number telling whether it is free
+/// to write or ready to read, producers claim slots with a compare-and-swap.
+///
+/// Record strings stay in the slots and are exchanged with the consumer's
+/// record on pop, so their memory circulates instead of being allocated per
+/// record.
+
+class LogRing {
+public:
+  /// Creates the queue, capacity is rounded up to a power of 2.
+  explicit LogRing(std::size_t capacity);
+
+  /// Adds a record, safe to call from many threads.
+  /// @return false if the queue is full.
+  bool tryPush(LogLevel::Level level, const std::string& line);
+
+  /// Takes the oldest record, call from a single consumer thread only.
+  /// @return false if the queue is empty.
+  bool tryPop(LogRecord& record);
+
+  /// Returns number of records pushed so far.
+  unsigned long long getPushCount() const;
+
+  std::size_t capacity() const;
+
+private:
+  LogRing(const LogRing&);
+  LogRing& operator= (const LogRing&);
+
+  struct Slot {
+    std::atomic<std::size_t> sequence;
+    LogRecord record;
+  };
+
+  std::vector<Slot> slots_;
+  std::size_t mask_;
+
+  // keep producer and consumer positions in separate cache lines
+  static const std::size_t CACHE_LINE_SIZE = 64;
+
+  std::atomic<std::size_t> pushPos_;
+  char pad_[CACHE_LINE_SIZE];
+  std::size_t popPos_;
+};
+
+
+} // namespace internal
+} // namespace fredcpp
+
+#endif // FREDCPP_INTERNAL_LOGRING_H_
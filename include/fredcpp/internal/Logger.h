@@ -29,6 +29,8 @@
 /// Defines Logger interface.
 
 
+#include <atomic>
+#include <cstddef>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -79,6 +81,9 @@ private:
 /// Supports selective togglig of enabled logging priority levels.
 ///
 /// Implement this interface for the specific external logging framework used.
+/// An implementation may cache its enabled levels in the logger
+/// (cacheLevelEnabled), so that isLevelEnabled tests them without a virtual
+/// call; otherwise isLevelEnabled calls levelEnabled.
 
 class Logger {
 public:
@@ -98,10 +103,60 @@ public:
   /// Tests if logging is enabled for specified priority level.
   virtual bool levelEnabled(LogLevel::Level level) const = 0;
 
+  /// Tests if logging is enabled for specified priority level, using the
+  /// cached levels when available.
+  bool isLevelEnabled(LogLevel::Level level) const {
+    unsigned mask(levelMask_.load(std::memory_order_relaxed));
+
+    if (LEVEL_MASK_UNKNOWN & mask) {
+      return (levelEnabled(level));
+    }
+
+    return (0 != (mask & (1U << level)));
+  }
+
+
+protected:
+  /// Caches enabled state of the level.
+  /// Once called, the cached state is used for all levels, so keep it
+  /// updated for every level toggled.
+  void cacheLevelEnabled(LogLevel::Level level, bool enabled);
+
 
 private:
   Logger(const Logger&);
   Logger& operator= (const Logger&);
+
+  static const unsigned LEVEL_MASK_UNKNOWN = 1U << 31;
+
+  std::atomic<unsigned> levelMask_;
+};
+
+//______________________________________________________________________________
+
+
+/// Log message formatting stream.
+/// Formats into a per-thread buffer, which is reused by the next messages,
+/// so that formatting does not allocate once the buffer has grown.
+/// Nested messages (e.g. formatted by a logger while formatting another one)
+/// take the next buffer.
+
+class LogMessage {
+public:
+  class Buffer; // forward
+
+  LogMessage();
+  ~LogMessage();
+
+  std::ostream& stream();
+  const std::string& str() const;
+
+private:
+  LogMessage(const LogMessage&);
+  LogMessage& operator= (const LogMessage&);
+
+  Buffer* buffer_;
+  bool owned_;
 };
 
 
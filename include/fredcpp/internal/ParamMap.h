@@ -0,0 +1,137 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_INTERNAL_PARAMMAP_H_
+#define FREDCPP_INTERNAL_PARAMMAP_H_
+
+/// @file
+/// Defines flat request parameter collection with inline storage.
+
+
+#include <fredcpp/internal/AttributeMap.h>
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace fredcpp {
+namespace internal {
+
+
+/// Parameter value with inline storage.
+/// Values up to INLINE_SIZE characters (dates, ids, API keys) are stored in
+/// place, so setting them does not allocate; longer values go to the heap.
+
+class ParamValue {
+public:
+  enum { INLINE_SIZE = 39 };
+
+  ParamValue();
+  explicit ParamValue(const std::string& value);
+  ParamValue(const char* data, std::size_t size);
+
+  void assign(const char* data, std::size_t size);
+
+  bool equals(const char* data, std::size_t size) const;
+
+  const char* data() const;
+  const char* c_str() const;
+  std::size_t size() const;
+  bool empty() const;
+
+  std::string str() const;
+  operator std::string () const;
+
+private:
+  std::size_t size_;
+  char inline_[INLINE_SIZE + 1];
+  std::string heap_;
+};
+
+std::ostream& operator<< (std::ostream& os, const ParamValue& value);
+
+//______________________________________________________________________________
+
+
+/// Request parameter collection stored as a flat array of (name, value) pairs.
+/// Parameter names are interned symbols. Pairs are kept sorted by name,
+/// matching is case-insensitive.
+///
+/// Up to INLINE_CAPACITY parameters are stored in place, which covers FRED
+/// requests, so building a request does not allocate; more parameters are
+/// moved to the heap.
+///
+/// Provides a subset of `std::map` interface (see KeyValueMap).
+
+class ParamMap {
+public:
+  enum { INLINE_CAPACITY = 8 };
+
+  typedef std::string key_type;
+  typedef ParamValue mapped_type;
+  typedef std::pair<Symbol, mapped_type> value_type;
+
+  typedef value_type* iterator;
+  typedef const value_type* const_iterator;
+
+  ParamMap();
+
+  /// Sets value of the specified parameter, adds it if it does not exist.
+  /// @return iterator to the parameter and whether it was added.
+  std::pair<iterator, bool> set(const Symbol& name, const char* data, std::size_t size);
+
+  iterator find(const key_type& name);
+  const_iterator find(const key_type& name) const;
+
+  /// Removes the specified parameter.
+  void erase(const key_type& name);
+
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  std::size_t size() const;
+  bool empty() const;
+
+  void clear();
+  void swap(ParamMap& other);
+
+private:
+  bool isOnHeap() const;
+  const_iterator lowerBound(const key_type& name) const;
+
+  std::size_t size_;
+  value_type inline_[INLINE_CAPACITY];
+  std::vector<value_type> heap_;
+};
+
+
+} // namespace internal
+} // namespace fredcpp
+
+#endif // FREDCPP_INTERNAL_PARAMMAP_H_
@@ -0,0 +1,113 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_INTERNAL_RATELIMITER_H_
+#define FREDCPP_INTERNAL_RATELIMITER_H_
+
+/// @file
+/// Defines request rate limiter.
+
+
+#include <mutex>
+#include <string>
+
+
+namespace fredcpp {
+namespace internal {
+
+
+/// Token-bucket request rate limiter.
+/// Paces requests to a maximum number of requests per period, allowing
+/// a burst of up to the configured number of requests.
+///
+/// FRED API enforces a request quota per API key, so limiters are shared per
+/// key (see RateLimiter::forKey).
+///
+/// @attention With a burst of N, any period may see up to N requests above
+/// the configured maximum; keep the burst small relative to the quota.
+///
+/// Thread-safe, a limiter may be shared by requests of many threads.
+
+class RateLimiter {
+public:
+  explicit RateLimiter(unsigned maxRequests = 0, unsigned long periodMillis = DEFAULT_PERIOD_MILLIS);
+
+  /// Rate limiter shared by all users of the specified API key.
+  static RateLimiter& forKey(const std::string& key);
+
+  /// @name Configuration
+  /// @{
+  /// Sets maximum requests per period, 0 disables limiting.
+  /// Enabling starts with a full burst; changing the rate keeps the tokens
+  /// left, and setting the same rate has no effect.
+  RateLimiter& withRate(unsigned maxRequests, unsigned long periodMillis = DEFAULT_PERIOD_MILLIS);
+  /// Sets number of requests allowed without pacing, 1 by default.
+  RateLimiter& withBurst(unsigned burst);
+  /// @}
+
+  /// Tests whether limiting is enabled.
+  bool enabled() const;
+
+  /// Takes a request token if available, without waiting.
+  bool tryAcquire();
+
+  /// Waits until a request token is available and takes it.
+  /// @return milliseconds waited.
+  unsigned long acquire();
+
+  /// Gives back a token taken for a request that was not sent after all.
+  void release();
+
+  /// Milliseconds until a request token becomes available, 0 when available now.
+  unsigned long getWaitMillis();
+
+  /// Refills the bucket to the burst size.
+  void reset();
+
+
+private:
+  RateLimiter(const RateLimiter&);
+  RateLimiter& operator= (const RateLimiter&);
+
+  bool isEnabled() const;
+  void refill(unsigned long long now);
+  void resetTokens();
+
+  static const unsigned long DEFAULT_PERIOD_MILLIS;
+
+  unsigned maxRequests_;
+  unsigned long periodMillis_;
+  unsigned burst_;
+
+  double tokens_;
+  unsigned long long lastRefillMillis_;
+
+  mutable std::mutex mutex_;
+};
+
+
+} // namespace internal
+} // namespace fredcpp
+
+#endif // FREDCPP_INTERNAL_RATELIMITER_H_
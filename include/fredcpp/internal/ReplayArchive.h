@@ -0,0 +1,100 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_INTERNAL_REPLAYARCHIVE_H_
+#define FREDCPP_INTERNAL_REPLAYARCHIVE_H_
+
+/// @file
+/// Defines archive format of recorded HTTP responses.
+
+
+#include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/utils.h>
+
+#include <iosfwd>
+#include <string>
+
+
+namespace fredcpp {
+namespace internal {
+
+class HttpRequest; // forward
+
+
+/// Recorded HTTP response of a request.
+struct ReplayRecord {
+  ReplayRecord();
+
+  std::string key;
+  HttpResponse::HttpStatus httpStatus;
+  std::string contentType;
+  KeyValueMap headers;
+  std::string content;
+};
+
+
+/// Archive of recorded HTTP responses.
+/// The archive is a file with a signature line followed by records, each is
+/// a few header lines, a blank line and the content of the stated length:
+///
+///     fredcpp-replay/1
+///     record 200 1347
+///     key https://api.stlouisfed.org/fred/series?series_id=GNPCA
+///     content-type text/xml; charset=UTF-8
+///     header ETag "abc"
+///
+///     <content>
+///
+/// Records are only appended, so an archive can be recorded over many runs.
+///
+/// @see external::RecordingHttpClient, external::ReplayHttpClient
+
+class ReplayArchive {
+public:
+  static const std::string SIGNATURE;
+
+  /// Key of the request: URI and query parameters, except `api_key`, unencoded.
+  static std::string makeKey(const HttpRequest& request);
+
+  /// Writes the signature, done for a new (empty) archive.
+  static bool writeSignature(std::ostream& os);
+  /// Tests the signature at the start of an archive.
+  static bool readSignature(std::istream& is);
+
+  static bool writeRecord(std::ostream& os, const ReplayRecord& record);
+  /// Reads the next record.
+  /// @return false on a malformed or truncated record.
+  static bool readRecord(std::istream& is, ReplayRecord& record);
+
+private:
+  ReplayArchive();
+
+  static const std::string IGNORED_PARAM;
+};
+
+
+} // namespace internal
+} // namespace fredcpp
+
+#endif // FREDCPP_INTERNAL_REPLAYARCHIVE_H_
@@ -29,8 +29,12 @@
 /// Defines a generic request object.
 
 
+#include <fredcpp/internal/ParamMap.h>
 #include <fredcpp/internal/utils.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <string>
 
@@ -42,6 +46,14 @@ namespace internal {
 /// Generic request.
 /// Manages a collection of parameters (key-values).
 ///
+/// Keeps the parameters encoded as a query string with its fingerprint; both
+/// are built on first use and kept until the parameters change, so a request
+/// sent repeatedly is encoded once. A parameter added to an encoded request
+/// is inserted into the query without encoding the others again.
+///
+/// Parameters are kept in a ParamMap; with names given as string literals
+/// (or symbols) and short values, building a request does not allocate.
+///
 /// @attention Currently only one value type is supported.
 
 
@@ -57,17 +69,34 @@ public:
   /// Sets specified parameter value, adds it if the parameter does not exist.
   Request& with(const KeyValueMap::key_type& key, const KeyValueMap::mapped_type& value);
 
+  /// Sets specified parameter value, the name is given as interned symbol.
+  Request& with(const Symbol& key, const KeyValueMap::mapped_type& value);
+
+  /// Sets specified parameter value, the name is given as string literal.
+  template<std::size_t N>
+  Request& with(const char (&key)[N], const KeyValueMap::mapped_type& value) {
+    return (with(SymbolTable::getInstance().internLiteral(key), value));
+  }
+
   /// Gets value of the specified parameter.
   KeyValueMap::mapped_type operator[] (const KeyValueMap::key_type& key) const;
 
   /// Removes the specified parameter.
-  void eraseParam(const KeyValueMap::key_type& key);
+  virtual void eraseParam(const KeyValueMap::key_type& key);
 
   /// Tests whether specified parameter exists.
   bool hasParam(const KeyValueMap::key_type& key) const;
 
   /// Returns reference to the parameter collection.
-  const KeyValueMap& getParams() const;
+  virtual const ParamMap& getParams() const;
+
+  /// Gets parameters as encoded query: `name=value` joined with `&` in
+  /// parameter order, names in lower case, both percent-encoded.\n
+  /// Safe to call from many threads on a request not being modified.
+  virtual const std::string& getEncodedQuery() const;
+
+  /// Gets 64-bit fingerprint of the encoded query.
+  virtual std::uint64_t getFingerprint() const;
 
   /// Removes all parameters.
   virtual void clear();
@@ -75,18 +104,48 @@ public:
   /// Prints parameters in formatted form.
   virtual std::ostream& print(std::ostream& os) const;
 
+  /// Resets parameters from an external collection.
+  void setParams(const ParamMap& params);
+
 
 protected:
-  /// Resets parameters from an external collection.
-  void setParams(const KeyValueMap& params);
+  /// Resets parameters from another request, along with its encoded query.
+  void setParams(const Request& request);
+
+  /// Resets own parameters from another request, ignoring the parameters
+  /// it may refer to (see HttpRequest).
+  void setOwnParams(const Request& request);
+
+  /// Called when own parameters change.
+  virtual void onParamsChange();
+
+  /// Appends encoded `name=value` segment of the parameter.
+  static void appendQueryParam(std::string& buf, const ParamMap::value_type& param);
 
 
 private:
+  typedef enum {
+    QUERY_STALE = 0,
+    QUERY_BUILDING,
+    QUERY_READY
+  } QueryState;
+
   /// Stores parameter value, adds it if the parameter does not exist.
-  void insertParam(const KeyValueMap::key_type& key, const KeyValueMap::mapped_type& value);
+  void insertParam(const Symbol& key, const KeyValueMap::mapped_type& value);
+
+  /// Inserts segment of a newly added parameter into the ready query.
+  void insertQuerySegment(ParamMap::const_iterator itParam);
+
+  void buildQuery() const;
+  void copyQuery(const Request& other);
+  void invalidateQuery();
+
 
+  ParamMap params_;
 
-  KeyValueMap params_;
+  mutable std::string encodedQuery_;
+  mutable std::uint64_t fingerprint_;
+  mutable std::atomic<int> queryState_;
 };
 
 //______________________________________________________________________________
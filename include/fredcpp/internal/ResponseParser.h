@@ -0,0 +1,90 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef FREDCPP_INTERNAL_RESPONSEPARSER_H_
+#define FREDCPP_INTERNAL_RESPONSEPARSER_H_
+
+/// @file
+/// Defines Response Parser Facility interface.
+
+
+#include <cstddef>
+#include <istream>
+#include <string>
+
+namespace fredcpp {
+
+struct ApiResponse; // forward
+class ApiEntityHandler; // forward
+
+
+namespace internal {
+
+/// Response Parser Facility interface.
+/// Parses content of the supplied stream into ApiResponse object.
+///
+/// Implement this interface for the specific content format and parser used,
+/// ResponseParser::accepts tells which content types the parser handles.
+///
+/// Content can also be parsed incrementally, chunk by chunk, as it arrives:
+/// ResponseParser::beginParse, ResponseParser::parseChunk, and
+/// ResponseParser::endParse. By default the chunks are buffered and
+/// parsed at the end; streaming implementations parse them right away.
+///
+/// Implementations are to be thread-safe: the incremental parsing state is
+/// kept per calling thread, so one parser may serve many threads at once.
+///
+/// @see XmlResponseParser
+
+class ResponseParser {
+public:
+  ResponseParser();
+  virtual ~ResponseParser();
+
+  /// Tests whether the parser handles content of the specified content-type.
+  virtual bool accepts(const std::string& contentType) const = 0;
+
+  /// Parses the supplied stream into ApiResponse object.
+  virtual bool parse(std::istream& content, ApiResponse& response) = 0;
+
+  /// Parses the supplied buffer into ApiResponse object.
+  /// Implementations may parse in place, modifying the buffer content.
+  /// By default the buffer is read through an input stream.
+  virtual bool parseInPlace(char* content, std::size_t size, ApiResponse& response);
+
+  /// @name Incremental parsing
+  /// @{
+  /// Starts parsing into the response; when a handler is specified, entities
+  /// are passed to the handler instead of being stored in the response.
+  virtual void beginParse(ApiResponse& response, ApiEntityHandler* handler);
+  /// Parses the next chunk of the content.
+  virtual bool parseChunk(const char* content, std::size_t size);
+  /// Completes parsing of the content.
+  virtual bool endParse();
+  /// @}
+};
+
+} // namespace internal
+} // namespace fredcpp
+
+#endif // FREDCPP_INTERNAL_RESPONSEPARSER_H_
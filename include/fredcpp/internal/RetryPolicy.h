@@ -0,0 +1,125 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_INTERNAL_RETRYPOLICY_H_
+#define FREDCPP_INTERNAL_RETRYPOLICY_H_
+
+/// @file
+/// Defines retry policy of HTTP requests.
+
+
+#include <fredcpp/internal/HttpResponse.h>
+
+#include <ctime>
+#include <string>
+
+
+namespace fredcpp {
+namespace internal {
+
+
+/// Retry policy of HTTP requests.
+/// Decides whether a failed request is re-tried, and how long to wait before
+/// the retry.
+///
+/// Delays grow exponentially from the initial delay, doubling with each retry
+/// up to the maximum delay. A share of each delay is randomized (jitter), so
+/// that requests failed together do not retry together.\n
+/// Responses with HTTP 429 (too many requests) and server errors are retried;
+/// when the response has `Retry-After` header, the delay is no shorter than
+/// requested by the server.\n
+/// A deadline limits the total time of a request including all its retries.
+///
+/// Executors re-try failed transfers (network issues) in addition to the
+/// statuses accepted by the policy. Derive to customize either decision.
+///
+/// Thread-safe once configured.
+
+class RetryPolicy {
+public:
+  RetryPolicy();
+  virtual ~RetryPolicy();
+
+  /// @name Configuration
+  /// @{
+  /// Sets maximum number of retries of a request, 0 disables retries.
+  RetryPolicy& withMaxRetries(unsigned count);
+  /// Sets delay before the first retry.
+  RetryPolicy& withInitialDelay(unsigned long millis);
+  /// Sets upper limit of the delay; longer `Retry-After` gives up the request.
+  RetryPolicy& withMaxDelay(unsigned long millis);
+  /// Sets randomized share of the delay, [0 fixed delay, 1 full jitter].
+  RetryPolicy& withJitter(double ratio);
+  /// Sets total time allowed for a request with its retries, 0 for no deadline.
+  RetryPolicy& withDeadline(unsigned long millis);
+  /// @}
+
+  unsigned getMaxRetries() const;
+  unsigned long getInitialDelay() const;
+  unsigned long getMaxDelay() const;
+  double getJitter() const;
+  unsigned long getDeadline() const;
+
+  /// Tests whether a response with the HTTP status is worth retrying.
+  virtual bool isRetryableStatus(HttpResponse::HttpStatus status) const;
+
+  /// Computes delay before the specified retry (from 1), honors `Retry-After`
+  /// of the failed response.
+  virtual unsigned long getDelayMillis(unsigned retry, const HttpResponse& response) const;
+
+  /// Decides on the specified retry (from 1) of a failed request.
+  /// @param elapsedMillis time since the request was first started.
+  /// @param delayMillis receives the delay before the retry.
+  /// @return false when retries are exhausted, or the retry would not start
+  /// before the deadline.
+  bool nextRetry(unsigned retry, unsigned long long elapsedMillis, const HttpResponse& response, unsigned long& delayMillis) const;
+
+  /// Computes transfer time left before the deadline, 0 when no deadline is set.
+  /// Passed deadline leaves 1 millisecond, so that the transfer times out.
+  unsigned long getRemainingMillis(unsigned long long elapsedMillis) const;
+
+  /// Parses `Retry-After` header value: delay-seconds or HTTP-date.
+  /// @param now current time, for HTTP-date.
+  /// @return false when the value is not valid.
+  static bool parseRetryAfter(const std::string& value, std::time_t now, unsigned long& delayMillis);
+
+  static const unsigned DEFAULT_MAX_RETRIES;
+  static const unsigned long DEFAULT_INITIAL_DELAY_MILLIS;
+  static const unsigned long DEFAULT_MAX_DELAY_MILLIS;
+  static const double DEFAULT_JITTER;
+
+
+private:
+  unsigned maxRetries_;
+  unsigned long initialDelayMillis_;
+  unsigned long maxDelayMillis_;
+  double jitter_;
+  unsigned long deadlineMillis_;
+};
+
+
+} // namespace internal
+} // namespace fredcpp
+
+#endif // FREDCPP_INTERNAL_RETRYPOLICY_H_
@@ -29,28 +29,27 @@
 /// Defines XML Response Parser Facility interface.
 
 
-#include <istream>
-
-namespace fredcpp {
-
-struct ApiResponse; // forward
+#include <fredcpp/internal/ResponseParser.h>
 
+#include <string>
 
+namespace fredcpp {
 namespace internal {
 
 /// XML Response Parser Facility interface.
 /// Parses content of the supplied XML stream into ApiResponse object.
 ///
 /// Implement this interface for the specific XML parser used.
+///
+/// @see ResponseParser
 
-class XmlResponseParser {
+class XmlResponseParser : public ResponseParser {
 public:
   XmlResponseParser();
   virtual ~XmlResponseParser();
 
-  /// Parses the supplied XML stream into ApiResponse object.
-  virtual bool parse(std::istream& xml, ApiResponse& response) = 0;
-
+  /// Accepts XML content (`text/xml`).
+  virtual bool accepts(const std::string& contentType) const;
 };
 
 } // namespace internal
@@ -31,6 +31,8 @@
 
 #include <map>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace fredcpp {
@@ -78,6 +80,46 @@ struct lessNoCase : public std::binary_function<std::string, std::string, bool>
 void sleep(unsigned secs);
 
 
+/// Sleep for number of milliseconds.
+/// Suspends execution of the current thread for specified number of milliseconds.
+void sleepMillis(unsigned long millis);
+
+
+/// Monotonic clock time in milliseconds.
+/// Only the difference between two readings is meaningful.
+unsigned long long monotonicMillis();
+
+
+/// Monotonic clock time in microseconds.
+/// Only the difference between two readings is meaningful.
+unsigned long long monotonicMicros();
+
+
+/// Create directory.
+/// Only the last path component is created, parent directories must exist.
+/// @return true when the directory was created or already exists.
+bool makeDirectory(const std::string& path);
+
+
+/// Percent-encode string for use in URI query.
+/// Keeps unreserved characters (`A-Z a-z 0-9 - . _ ~`), converts any other
+/// byte to `%XX` with upper-case hex digits.
+std::string percentEncode(const std::string& value);
+
+
+/// Append percent-encoded string to the buffer.
+/// Unreserved runs are copied at once, so appending to a reserved buffer does
+/// not allocate.
+void appendPercentEncoded(std::string& buf, const std::string& value);
+void appendPercentEncoded(std::string& buf, const char* data, std::size_t size);
+
+
+/// 64-bit fingerprint of the data, for hashing and quick comparison.
+/// Not cryptographic; equal fingerprints still require comparing the data.
+/// @param seed chains fingerprints of several pieces of data.
+std::uint64_t fingerprint64(const char* data, std::size_t size, std::uint64_t seed = 0);
+
+
 
 } // namespace fredcpp
 } // namespace internal
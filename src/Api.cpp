@@ -32,12 +32,18 @@
 #include <fredcpp/internal/HttpRequestExecutor.h>
 #include <fredcpp/internal/HttpRequest.h>
 #include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/RateLimiter.h>
 
-#include <fredcpp/internal/XmlResponseParser.h>
+#include <fredcpp/internal/ResponseParser.h>
 
 #include <iostream>
 #include <cstdlib>
 #include <string>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 #include <cassert>
 
@@ -47,12 +53,75 @@ namespace fredcpp {
 const std::string Api::DEFAULT_BASE_URI("https://api.stlouisfed.org/fred");
 const std::string Api::FRED_PARAM_API_KEY("api_key");
 const std::string Api::FRED_PARAM_FILE_TYPE("file_type");
+const std::string Api::FRED_PARAM_LIMIT("limit");
+const std::string Api::FRED_PARAM_OFFSET("offset");
+const std::string Api::FRED_RESULT_COUNT("count");
+const unsigned Api::DEFAULT_RATE_PERIOD_SECS(60);
 
 
+namespace {
+
+/// Content reported with a parse error, at most.
+const std::size_t ERROR_CONTENT_LIMIT = 1024;
+
+
+/// Copies the beginning of the content for a parse error, into a per-thread
+/// buffer reused between responses.
+
+const std::string& copyContentHead(const char* content, std::size_t size) {
+  thread_local std::string head;
+
+  head.assign(content, std::min(size, ERROR_CONTENT_LIMIT));
+
+  if (size > ERROR_CONTENT_LIMIT) {
+    head.append("...");
+  }
+
+  return (head);
+}
+
+
+/// Request URIs by API base URI and entity path.
+/// Both sets are small, URIs are built once and kept for the process.
+
+struct EntityURITable {
+  std::map<std::string, std::map<std::string, std::string> > URIs;
+  std::mutex mutex;
+};
+
+
+const std::string& getEntityURI(const std::string& apiURI, const std::string& path) {
+  static EntityURITable table;
+
+  std::lock_guard<std::mutex> lock(table.mutex);
+
+  std::map<std::string, std::string>& paths(table.URIs[apiURI]);
+  std::map<std::string, std::string>::iterator itFound(paths.find(path));
+
+  if (itFound == paths.end()) {
+    itFound = paths.insert(std::make_pair(path, std::string(apiURI).append("/").append(path))).first;
+  }
+
+  return (itFound->second);
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+ApiResponseHandler::~ApiResponseHandler() {
+}
+
+//______________________________________________________________________________
+
 Api::Api(const std::string& apiURI)
   : apiURI_(apiURI)
   , executor_(NULL)
-  , parser_(NULL) {
+  , parser_(NULL)
+  , rateMaxRequests_(0)
+  , ratePeriodSecs_(DEFAULT_RATE_PERIOD_SECS)
+  , rateLimiter_(NULL)
+  , cache_(NULL) {
 }
 
 
@@ -73,7 +142,7 @@ Api& Api::withExecutor(internal::HttpRequestExecutor& executor) {
 }
 
 
-Api& Api::withParser(internal::XmlResponseParser& parser) {
+Api& Api::withParser(internal::ResponseParser& parser) {
   parser_ = &parser;
   return (*this);
 }
@@ -81,6 +150,7 @@ Api& Api::withParser(internal::XmlResponseParser& parser) {
 
 Api& Api::withKey(const std::string& key) {
   apiKey_ = key;
+  bindRateLimiter();
   return (*this);
 }
 
@@ -91,68 +161,452 @@ Api& Api::withFileType(const std::string& type) {
 }
 
 
+Api& Api::withRateLimit(unsigned maxRequests, unsigned periodSecs) {
+  rateMaxRequests_ = maxRequests;
+  ratePeriodSecs_ = periodSecs;
+  bindRateLimiter();
+  return (*this);
+}
+
+
+Api& Api::withCache(ApiResponseCache& cache) {
+  cache_ = &cache;
+  return (*this);
+}
+
+
 bool Api::get(const ApiRequest& request, ApiResponse& response) {
 
+  if (NULL == cache_) {
+    return (fetch(request, response));
+  }
+
+  ApiResponsePtr cached(cache_->find(request, apiURI_));
+
+  if (cached) {
+    FREDCPP_LOG_DEBUG("cache-hit:" << request);
+
+    response = *cached;
+    return (response.good());
+  }
+
+  if (fetch(request, response)) {
+    cache_->insert(request, std::make_shared<const ApiResponse>(response), apiURI_);
+  }
+
+  return (response.good());
+}
+
+
+ApiResponsePtr Api::getShared(const ApiRequest& request) {
+  ApiResponsePtr cached;
+
+  if (NULL != cache_
+      && (cached = cache_->find(request, apiURI_))) {
+    FREDCPP_LOG_DEBUG("cache-hit:" << request);
+
+    return (cached);
+  }
+
+  std::shared_ptr<ApiResponse> response(std::make_shared<ApiResponse>());
+
+  if (fetch(request, *response)
+      && NULL != cache_) {
+    cache_->insert(request, response, apiURI_);
+  }
+
+  return (response);
+}
+
+
+bool Api::fetch(const ApiRequest& request, ApiResponse& response) {
+
   response.clear();
 
-  // validate
+  if (!requireValidFacilities(response)) {
+    return (response.good());
+  }
+
+  FREDCPP_LOG_DEBUG("request:" << request);
+
+
+  // prepare request (ApiRequest >> HttpRequest)
+
+  internal::HttpRequest httpRequest;
+  makeHttpRequest(request, httpRequest);
+
+  FREDCPP_LOG_DEBUG("http-request:" << httpRequest);
+
+
+  // execute request
+
+  internal::HttpResponse httpResponse;
+
+  // a rate limit token is taken only if the request goes to the network
+  executor_->executeLimited(httpRequest, httpResponse, rateLimiter_);
+
+  return (processResponse(request, httpRequest, httpResponse, response));
+}
+
+//______________________________________________________________________________
+
+namespace {
+
+/// Feeds HTTP response content to the parser as it arrives.
+
+class ParserContentSink : public internal::HttpContentSink {
+public:
+  ParserContentSink(internal::ResponseParser& parser, ApiResponse& response, ApiEntityHandler& handler)
+    : parser_(parser)
+    , response_(response)
+    , handler_(handler)
+    , started_(false)
+    , good_(true)
+    , receivedBytes_(0) {
+    parser_.beginParse(response_, &handler_);
+  }
+
+  void onContent(const char* data, std::size_t size) {
+    started_ = true;
+    keepHead(data, size);
+    good_ = parser_.parseChunk(data, size) && good_;
+  }
+
+  void onContentReset() {
+    if (started_) {
+      handler_.onReset();
+      response_.clear();
+    }
+
+    started_ = false;
+    good_ = true;
+    receivedBytes_ = 0;
+    parser_.beginParse(response_, &handler_);
+  }
+
+  bool good() const {
+    return (good_);
+  }
+
+  /// Beginning of the received content, to report a parse error.
+  const std::string& getContentHead() const {
+    return (copyContentHead(head_, receivedBytes_));
+  }
+
+private:
+  void keepHead(const char* data, std::size_t size) {
+    if (receivedBytes_ < ERROR_CONTENT_LIMIT) {
+      std::size_t headSize(std::min(size, ERROR_CONTENT_LIMIT - receivedBytes_));
+      std::copy(data, data + headSize, head_ + receivedBytes_);
+    }
+
+    receivedBytes_ += size;
+  }
+
+  internal::ResponseParser& parser_;
+  ApiResponse& response_;
+  ApiEntityHandler& handler_;
+  bool started_;
+  bool good_;
+
+  // the content is not kept by the response, keep its beginning
+  char head_[ERROR_CONTENT_LIMIT];
+  std::size_t receivedBytes_;
+};
+
+} // namespace
+
+
+bool Api::get(const ApiRequest& request, ApiResponse& response, ApiEntityHandler& handler) {
+
+  response.clear();
+
+  if (!requireValidFacilities(response)) {
+    return (response.good());
+  }
+
+  FREDCPP_LOG_DEBUG("request:" << request);
+
+  internal::HttpRequest httpRequest;
+  makeHttpRequest(request, httpRequest);
+
+  FREDCPP_LOG_DEBUG("http-request:" << httpRequest);
+
+
+  // execute request, parsing the content as it arrives
+
+  internal::HttpResponse httpResponse;
+  ParserContentSink sink(*parser_, response, handler);
+
+  httpResponse.setContentSink(&sink);
+
+  // a rate limit token is taken only if the request goes to the network
+  executor_->executeLimited(httpRequest, httpResponse, rateLimiter_);
+
+  httpResponse.setContentSink(NULL);
+
+
+  // process response
+
+  if (!requireParsableContent(request, httpRequest, httpResponse, response)) {
+    return (response.good());
+  }
+
+  if ( !(parser_->endParse() && sink.good()) ) {
+    response.setError( ErrorParseFailed(request, sink.getContentHead()) );
+    FREDCPP_LOG_ERROR( response.error.message );
+
+    return (response.good());
+  }
+
+  response.setErrorFromResult();
+
+  return ( response.good() );
+}
+
+//______________________________________________________________________________
+
+/// Adapts executor's batch responses to API responses.
+
+class Api::BatchResponseHandler : public internal::HttpResponseHandler {
+public:
+  BatchResponseHandler(Api& api, const ApiRequestVector& requests, ApiResponseHandler& handler)
+    : api_(api)
+    , requests_(requests)
+    , handler_(handler)
+    , allGood_(true) {
+  }
+
+  void onResponse(std::size_t index, const internal::HttpRequest& httpRequest, internal::HttpResponse& httpResponse) {
+    const ApiRequest& request(requests_[index]);
+
+    response_.clear();
+    allGood_ = api_.processResponse(request, httpRequest, httpResponse, response_) && allGood_;
+
+    handler_.onResponse(index, request, response_);
+  }
+
+  bool allGood() const {
+    return (allGood_);
+  }
+
+private:
+  Api& api_;
+  const ApiRequestVector& requests_;
+  ApiResponseHandler& handler_;
+  ApiResponse response_;
+  bool allGood_;
+};
+
+
+namespace {
+
+/// Collects batch responses in request order.
+
+class ApiResponseCollector : public ApiResponseHandler {
+public:
+  explicit ApiResponseCollector(std::vector<ApiResponse>& responses)
+    : responses_(responses) {
+  }
+
+  void onResponse(std::size_t index, const ApiRequest& request, ApiResponse& response) {
+    std::swap(responses_[index], response);
+  }
+
+private:
+  std::vector<ApiResponse>& responses_;
+};
+
+} // namespace
+
+
+bool Api::getBatch(const ApiRequestVector& requests, ApiResponseHandler& handler) {
+  ApiResponse response;
+
+  if (!requireValidFacilities(response)) {
+    for (std::size_t n = 0; n < requests.size(); ++n) {
+      handler.onResponse(n, requests[n], response);
+    }
+    return (response.good());
+  }
+
+  FREDCPP_LOG_DEBUG("batch-requests:" << requests.size());
+
+  internal::HttpRequestVector httpRequests(requests.size());
+
+  for (std::size_t n = 0; n < requests.size(); ++n) {
+    makeHttpRequest(requests[n], httpRequests[n]);
+  }
+
+  BatchResponseHandler batchHandler(*this, requests, handler);
+
+  executor_->executeBatch(httpRequests, batchHandler, rateLimiter_);
+
+  return (batchHandler.allGood());
+}
+
+
+bool Api::getBatch(const ApiRequestVector& requests, std::vector<ApiResponse>& responses) {
+  responses.clear();
+  responses.resize(requests.size());
+
+  ApiResponseCollector collector(responses);
+
+  return (getBatch(requests, collector));
+}
+
+
+bool Api::getAll(const ApiRequest& request, ApiResponse& response) {
+
+  if (!get(request, response)) {
+    return (response.good());
+  }
+
+  unsigned long count(std::strtoul(response.result.attribute(FRED_RESULT_COUNT).c_str(), NULL, 10));
+  unsigned long limit(std::strtoul(response.result.attribute(FRED_PARAM_LIMIT).c_str(), NULL, 10));
+  unsigned long offset(std::strtoul(response.result.attribute(FRED_PARAM_OFFSET).c_str(), NULL, 10));
+
+  if (0 == limit
+      || offset + limit >= count) {
+    return (response.good());
+  }
+
+
+  // request the remaining pages at once
+
+  ApiRequestVector pages;
+
+  for (unsigned long pageOffset = offset + limit; pageOffset < count; pageOffset += limit) {
+    std::ostringstream pageOffsetStr;
+    std::ostringstream limitStr;
+    pageOffsetStr << pageOffset;
+    limitStr << limit;
+
+    pages.push_back(request);
+    pages.back().with(FRED_PARAM_OFFSET, pageOffsetStr.str())
+                .with(FRED_PARAM_LIMIT, limitStr.str());
+  }
+
+  FREDCPP_LOG_DEBUG("paged-request:" << request << " count:" << count
+                    << " pages:" << (pages.size() + 1));
+
+  std::vector<ApiResponse> pageResponses;
+  getBatch(pages, pageResponses);
+
+  for (std::size_t n = 0; n < pageResponses.size(); ++n) {
+    if (!pageResponses[n].good()) {
+      response.setError(pageResponses[n].error);
+      return (response.good());
+    }
+  }
+
+
+  // merge entities in page order
+
+  response.entities.reserve(count - offset);
+
+  for (std::size_t n = 0; n < pageResponses.size(); ++n) {
+    ApiResponse::ApiEntityVector& entities(pageResponses[n].entities);
+
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+      response.appendEntity().swap(entities[i]);
+    }
+  }
+
+  return (response.good());
+}
+
+//______________________________________________________________________________
+
+void Api::bindRateLimiter() {
+  if (0 == rateMaxRequests_) {
+    rateLimiter_ = NULL;
+    return;
+  }
+
+  // the shared limiter takes the rate only when it changes, keeping its tokens
+  rateLimiter_ = &internal::RateLimiter::forKey(apiKey_);
+  rateLimiter_->withRate(rateMaxRequests_, ratePeriodSecs_ * 1000UL);
+}
+
+
+bool Api::requireValidFacilities(ApiResponse& response) const {
+
   bool requireValidExecutor(executor_ != NULL);
   if (!requireValidExecutor) {
     assert(requireValidExecutor && "Valid HttpRequestExecutor implementation expected.");
     response.setError( FatalInternalError("Api Executor is not set.") );
-    return (response.good());
+    return (false);
   }
 
   bool requireValidParser(parser_ != NULL);
   if (!requireValidParser) {
-    assert(requireValidParser && "Valid XmlResponseParser implementation expected.");
+    assert(requireValidParser && "Valid ResponseParser implementation expected.");
     response.setError( FatalInternalError("Api Parser is not set.") );
-    return (response.good());
+    return (false);
   }
 
-  FREDCPP_LOG_DEBUG("request:" << request);
+  return (true);
+}
 
 
-  // prepare request (ApiRequest >> HttpRequest)
+void Api::makeHttpRequest(const ApiRequest& request, internal::HttpRequest& httpRequest) const {
+  // refer to the request instead of copying it, the API parameters are
+  // added on top; the executor merges them with the encoded query of the
+  // request, which is kept for its next uses
 
-  std::string URI(std::string(apiURI_).append("/").append(request.getPath()));
+  static const internal::Symbol PARAM_API_KEY(internal::SymbolTable::getInstance().intern(FRED_PARAM_API_KEY));
+  static const internal::Symbol PARAM_FILE_TYPE(internal::SymbolTable::getInstance().intern(FRED_PARAM_FILE_TYPE));
 
-  internal::HttpRequest httpRequest(URI, request);
-  httpRequest.with(FRED_PARAM_API_KEY, apiKey_);
+  httpRequest.withURIRef(getEntityURI(apiURI_, request.getPath()))
+             .withParamsRef(request);
+
+  httpRequest.with(PARAM_API_KEY, apiKey_);
   if (!apiFileType_.empty()) {
-    httpRequest.with(FRED_PARAM_FILE_TYPE, apiFileType_);
+    httpRequest.with(PARAM_FILE_TYPE, apiFileType_);
   }
+}
 
-  FREDCPP_LOG_DEBUG("http-request:" << httpRequest);
-
-
-  // execute request
 
-  internal::HttpResponse httpResponse;
+bool Api::requireParsableContent(const ApiRequest& request, const internal::HttpRequest& httpRequest,
+                            const internal::HttpResponse& httpResponse, ApiResponse& response) const {
 
-  executor_->execute(httpRequest, httpResponse);
+  FREDCPP_LOG_DEBUG("http-response:" << httpResponse.getHttpStatus()
+                    << " " << "content-type:" << httpResponse.getContentType());
 
-  if (!httpResponse.isXmlContent()) {
+  if (!parser_->accepts(httpResponse.getContentType())) {
     response.setError( ErrorHttpRequestFailed(request, httpRequest, httpResponse) );
     FREDCPP_LOG_ERROR( response.error.message);
 
+    return (false);
+  }
+
+  return (true);
+}
+
+
+bool Api::processResponse(const ApiRequest& request, const internal::HttpRequest& httpRequest,
+                          internal::HttpResponse& httpResponse, ApiResponse& response) {
+
+  if (!requireParsableContent(request, httpRequest, httpResponse, response)) {
     return (response.good());
   }
 
   // process response
 
   //std::ofstream os("fred_dbg.bin",std::ifstream::binary);
-  //os << httpResponse.getContentStream().str();
+  //os << httpResponse.getContent();
 
-  std::istringstream xmlContent(httpResponse.getContentStream().str());
+  // parse the content buffer in place, the content is not valid afterwards,
+  // so its beginning is kept to report a parse error
+  std::string& content(httpResponse.getContentBuffer());
 
-  FREDCPP_LOG_DEBUG("http-response:" << httpResponse.getHttpStatus()
-                    << " " << "content-type:" << httpResponse.getContentType());
+  FREDCPP_LOG_DBGN(2, "content:{\n" << content << "\n}");
 
-  FREDCPP_LOG_DBGN(2, "content:{\n" << xmlContent.str() << "\n}");
+  const std::string& contentHead(copyContentHead(content.data(), content.size()));
 
-  if ( !parser_->parse(xmlContent, response) ) {
-    response.setError( ErrorXmlParseFailed(request, xmlContent) );
+  if ( !parser_->parseInPlace(&content[0], content.size(), response) ) {
+    response.setError( ErrorParseFailed(request, contentHead) );
     FREDCPP_LOG_ERROR( response.error.message );
 
     return (response.good());
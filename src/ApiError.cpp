@@ -28,6 +28,8 @@
 #include <fredcpp/internal/HttpRequest.h>
 #include <fredcpp/internal/HttpResponse.h>
 
+#include <sstream>
+
 
 namespace fredcpp {
 
@@ -85,6 +87,20 @@ ErrorHttpRequestFailed::ErrorHttpRequestFailed(const ApiRequest& request, const
   code = buf.str();
 }
 
+ErrorParseFailed::ErrorParseFailed(const ApiRequest& request, const std::string& content) {
+  status = FREDCPP_FAIL_PARSE;
+
+  std::ostringstream buf;
+  buf << "Bad Response."
+      << " "
+      << " Response from API is invalid or has unexpected schema."
+      << " request:" << request
+      << " content-begin:{\n" << content << "\n}:content-end"
+      ;
+
+  message = buf.str();
+}
+
 ErrorXmlParseFailed::ErrorXmlParseFailed(const ApiRequest& request, const std::istringstream& xmlContent) {
   status = FREDCPP_FAIL_PARSE;
 
@@ -29,6 +29,9 @@
 
 namespace fredcpp {
 
+std::atomic<internal::Logger*> ApiLog::loggerPtr_(NULL);
+std::atomic<int> ApiLog::debugDepth_(0);
+
 
 ApiLog& ApiLog::getInstance() {
   static ApiLog instance;
@@ -49,7 +52,7 @@ ApiLog& ApiLog::withLogger(internal::Logger* loggerPtr) {
     return (*this);
   }
 
-  loggerPtr_ = loggerPtr;
+  loggerPtr_.store(loggerPtr);
 
   return (*this);
 }
@@ -57,54 +60,64 @@ ApiLog& ApiLog::withLogger(internal::Logger* loggerPtr) {
 
 ApiLog& ApiLog::withDebugDepth(int depth) {
 
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
+  internal::Logger* loggerPtr(loggerPtr_.load());
+
+  if (!requireValidLogger(loggerPtr)) {
+    assert(requireValidLogger(loggerPtr) && "Valid logger expected");
     return (*this);
   }
 
-  debugDepth_ = depth;
+  debugDepth_.store(depth);
 
   return (*this);
 }
 
 void ApiLog::info(const std::string& message, const internal::LogContext& context) {
 
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
+  internal::Logger* loggerPtr(loggerPtr_.load());
+
+  if (!requireValidLogger(loggerPtr)) {
+    assert(requireValidLogger(loggerPtr) && "Valid logger expected");
     return;
   }
 
-  loggerPtr_->logMessage(internal::LogLevel::LOG_INFO, message, context);
+  loggerPtr->logMessage(internal::LogLevel::LOG_INFO, message, context);
 }
 
 void ApiLog::warn(const std::string& message, const internal::LogContext& context) {
 
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
+  internal::Logger* loggerPtr(loggerPtr_.load());
+
+  if (!requireValidLogger(loggerPtr)) {
+    assert(requireValidLogger(loggerPtr) && "Valid logger expected");
     return;
   }
 
-  loggerPtr_->logMessage(internal::LogLevel::LOG_WARN, message, context);
+  loggerPtr->logMessage(internal::LogLevel::LOG_WARN, message, context);
 }
 
 void ApiLog::error(const std::string& message, const internal::LogContext& context) {
 
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
+  internal::Logger* loggerPtr(loggerPtr_.load());
+
+  if (!requireValidLogger(loggerPtr)) {
+    assert(requireValidLogger(loggerPtr) && "Valid logger expected");
     return;
   }
 
-  loggerPtr_->logMessage(internal::LogLevel::LOG_ERROR, message, context);
+  loggerPtr->logMessage(internal::LogLevel::LOG_ERROR, message, context);
 }
 
 void ApiLog::fatal(const std::string& message, const internal::LogContext& context) {
 
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
+  internal::Logger* loggerPtr(loggerPtr_.load());
+
+  if (!requireValidLogger(loggerPtr)) {
+    assert(requireValidLogger(loggerPtr) && "Valid logger expected");
     return;
   }
 
-  loggerPtr_->logMessage(internal::LogLevel::LOG_FATAL, message, context);
+  loggerPtr->logMessage(internal::LogLevel::LOG_FATAL, message, context);
 }
 
 void ApiLog::debug(const std::string& message, const internal::LogContext& context) {
@@ -113,76 +126,18 @@ void ApiLog::debug(const std::string& message, const internal::LogContext& conte
 
 void ApiLog::debug(int depth, const std::string& message, const internal::LogContext& context) {
 
-  if (depth > debugDepth_) {
+  if (depth > debugDepth_.load()) {
     return;
   }
 
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
-    return;
-  }
-
-  loggerPtr_->logMessage(internal::LogLevel::LOG_DEBUG, message, context);
-}
-
-bool ApiLog::infoEnabled() const {
-  bool result(false);
-
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
-    return (result);
-  }
-
-  result = loggerPtr_->levelEnabled(internal::LogLevel::LOG_INFO);
-  return (result);
-}
-
-bool ApiLog::warnEnabled() const {
-  bool result(false);
-
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
-    return (result);
-  }
-
-  result = loggerPtr_->levelEnabled(internal::LogLevel::LOG_WARN);
-  return (result);
-}
-
-bool ApiLog::errorEnabled() const {
-  bool result(false);
-
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
-    return (result);
-  }
-
-  result = loggerPtr_->levelEnabled(internal::LogLevel::LOG_ERROR);
-  return (result);
-}
-
-bool ApiLog::fatalEnabled() const {
-  bool result(false);
+  internal::Logger* loggerPtr(loggerPtr_.load());
 
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
-    return (result);
-  }
-
-  result = loggerPtr_->levelEnabled(internal::LogLevel::LOG_FATAL);
-  return (result);
-}
-
-bool ApiLog::debugEnabled() const {
-  bool result(false);
-
-  if (!requireValidLogger(loggerPtr_)) {
-    assert(requireValidLogger(loggerPtr_) && "Valid logger expected");
-    return (result);
+  if (!requireValidLogger(loggerPtr)) {
+    assert(requireValidLogger(loggerPtr) && "Valid logger expected");
+    return;
   }
 
-  result = loggerPtr_->levelEnabled(internal::LogLevel::LOG_DEBUG);
-  return (result);
+  loggerPtr->logMessage(internal::LogLevel::LOG_DEBUG, message, context);
 }
 
 ApiLog::ApiLog() {
@@ -190,8 +145,8 @@ ApiLog::ApiLog() {
 }
 
 void ApiLog::initialize() {
-  loggerPtr_ = NULL;
-  debugDepth_ = 0;
+  loggerPtr_.store(NULL);
+  debugDepth_.store(0);
 }
 
 bool ApiLog::requireValidLogger(internal::Logger* const loggerPtr) const {
@@ -24,10 +24,32 @@
 
 #include <fredcpp/ApiRequest.h>
 
+#include <fredcpp/internal/LiteralCache.h>
+
+#include <mutex>
+#include <set>
+
 namespace fredcpp {
 
+namespace {
+
+/// Interned entity names.
+
+struct EntityTable {
+  std::set<std::string> entities;
+  std::mutex mutex;
+};
+
+EntityTable& getEntityTable() {
+  static EntityTable table;
+  return (table);
+}
+
+} // namespace
+
+
 ApiRequest::ApiRequest(const std::string& entity)
-  : entity_(entity) {
+  : entity_(internEntity(entity)) {
 }
 
 ApiRequest::~ApiRequest() {
@@ -38,17 +60,17 @@ const std::string& ApiRequest::getPath() const {
 }
 
 const std::string& ApiRequest::getEntity() const {
-  return (entity_);
+  return (*entity_);
 }
 
 void ApiRequest::setEntity(const std::string& entity) {
-  entity_ = entity;
+  entity_ = internEntity(entity);
 }
 
 std::ostream& ApiRequest::print(std::ostream& os) const {
   // entity|request
 
-  os << entity_;
+  os << *entity_;
 
   if (getParams().size()) {
      os << "|";
@@ -59,6 +81,27 @@ std::ostream& ApiRequest::print(std::ostream& os) const {
 }
 
 
+const std::string* ApiRequest::internEntity(const std::string& entity) {
+  EntityTable& table(getEntityTable());
+  std::lock_guard<std::mutex> lock(table.mutex);
+
+  return (&*table.entities.insert(entity).first);
+}
+
+const std::string* ApiRequest::internEntityLiteral(const char* entity) {
+  thread_local internal::LiteralCache literals(internal::LiteralCache::equals);
+
+  const std::string* interned(literals.find(entity));
+
+  if (NULL == interned) {
+    interned = internEntity(entity);
+    literals.insert(entity, interned);
+  }
+
+  return (interned);
+}
+
+
 std::ostream& operator<< (std::ostream& os, const ApiRequest& request) {
   return (request.print(os));
 }
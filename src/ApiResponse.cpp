@@ -27,11 +27,11 @@
 namespace fredcpp {
 
 
-internal::KeyValueMap::mapped_type ApiEntity::attribute(const internal::KeyValueMap::key_type& name) const {
-  internal::KeyValueMap::mapped_type nullValue;
-  internal::KeyValueMap::mapped_type& value(nullValue);
+internal::AttributeMap::mapped_type ApiEntity::attribute(const internal::AttributeMap::key_type& name) const {
+  internal::AttributeMap::mapped_type nullValue;
+  internal::AttributeMap::mapped_type& value(nullValue);
 
-  internal::KeyValueMap::const_iterator itFound;
+  internal::AttributeMap::const_iterator itFound;
 
   itFound = attributes.find(name);
   if (itFound != attributes.end()) {
@@ -47,7 +47,7 @@ std::ostream& ApiEntity::print(std::ostream& os) const {
 
   os << name << ":{";
 
-  for (internal::KeyValueMap::const_iterator it = attributes.begin();
+  for (internal::AttributeMap::const_iterator it = attributes.begin();
        it != attributes.end();
        ++it) {
     os << it->first << "=" << it->second
@@ -67,6 +67,20 @@ void ApiEntity::clear() {
 }
 
 
+void ApiEntity::recycle() {
+  name.clear();
+  value.clear();
+  attributes.recycle();
+}
+
+
+void ApiEntity::swap(ApiEntity& other) {
+  name.swap(other.name);
+  value.swap(other.value);
+  attributes.swap(other.attributes);
+}
+
+
 
 std::ostream& operator<< (std::ostream& os, const ApiEntity& object) {
   return (object.print(os));
@@ -74,6 +88,29 @@ std::ostream& operator<< (std::ostream& os, const ApiEntity& object) {
 
 //______________________________________________________________________________
 
+ApiEntityHandler::~ApiEntityHandler() {
+}
+
+
+void ApiEntityHandler::onReset() {
+}
+
+//______________________________________________________________________________
+
+ApiResponse::EntityPool::EntityPool()
+  : enabled(false) {
+}
+
+ApiResponse::EntityPool::EntityPool(const EntityPool& other)
+  : enabled(other.enabled) {
+}
+
+ApiResponse::EntityPool& ApiResponse::EntityPool::operator= (const EntityPool& rhs) {
+  return (*this);
+}
+
+//______________________________________________________________________________
+
 ApiResponse::ApiResponse() {
   clear();
 }
@@ -125,9 +162,60 @@ std::ostream& ApiResponse::print(std::ostream& os) const {
 }
 
 
+ApiEntity& ApiResponse::appendEntity() {
+  if (pool_.entities.empty()) {
+    entities.push_back(ApiEntity());
+    return (entities.back());
+  }
+
+  if (entities.empty()) {
+    entities.reserve(pool_.entities.size());
+  }
+
+  entities.push_back(ApiEntity());
+
+  ApiEntity& entity(entities.back());
+  entity.swap(pool_.entities.back());
+  pool_.entities.pop_back();
+
+  entity.recycle();
+  return (entity);
+}
+
+
+void ApiResponse::setRecycling(bool recycle) {
+  pool_.enabled = recycle;
+
+  if (!recycle) {
+    ApiEntityVector().swap(pool_.entities);
+  }
+}
+
+
+bool ApiResponse::isRecycling() const {
+  return (pool_.enabled);
+}
+
+
 void ApiResponse::clear() {
   error.clear();
   result.clear();
+
+  if (!pool_.enabled) {
+    entities.clear();
+    return;
+  }
+
+  // keep entities for reuse, swapping when possible to avoid moving them one by one
+  if (pool_.entities.size() < entities.size()) {
+    pool_.entities.swap(entities);
+  }
+
+  for (std::size_t n = 0; n < entities.size(); ++n) {
+    pool_.entities.push_back(ApiEntity());
+    pool_.entities.back().swap(entities[n]);
+  }
+
   entities.clear();
 }
 
@@ -0,0 +1,321 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/ApiResponseCache.h>
+
+#include <fredcpp/internal/utils.h>
+
+
+namespace fredcpp {
+
+const std::size_t ApiResponseCache::DEFAULT_MAX_BYTES(8 * 1024 * 1024);
+
+
+namespace {
+
+std::size_t stringBytes(const std::string& str) {
+  return (str.capacity());
+}
+
+
+std::size_t entityBytes(const ApiEntity& entity) {
+  std::size_t bytes(sizeof(ApiEntity)
+                    + stringBytes(entity.name)
+                    + stringBytes(entity.value)
+                    + entity.attributes.size() * sizeof(internal::AttributeMap::value_type));
+
+  // attribute names are interned and shared, count only the values
+
+  for (internal::AttributeMap::const_iterator it = entity.attributes.begin();
+       it != entity.attributes.end();
+       ++it) {
+    bytes += stringBytes(it->second);
+  }
+
+  return (bytes);
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+ApiResponseCache::Stats::Stats()
+  : hits(0)
+  , misses(0)
+  , evictions(0)
+  , insertions(0) {
+}
+
+//______________________________________________________________________________
+
+ApiResponseCache::ApiResponseCache(std::size_t maxBytes)
+  : maxBytes_(maxBytes)
+  , bytes_(0) {
+}
+
+
+ApiResponseCache::~ApiResponseCache() {
+}
+
+
+ApiResponseCache& ApiResponseCache::withMaxBytes(std::size_t maxBytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  maxBytes_ = maxBytes;
+  evict(maxBytes_);
+  return (*this);
+}
+
+
+ApiResponsePtr ApiResponseCache::find(const ApiRequest& request, const std::string& endpoint) {
+  std::uint64_t fingerprint(makeFingerprint(request, endpoint));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  EntryIndex::iterator itFound(findEntry(fingerprint, request, endpoint));
+
+  if (itFound == index_.end()) {
+    ++stats_.misses;
+    return (ApiResponsePtr());
+  }
+
+  ++stats_.hits;
+
+  // move to the front, list iterators stay valid
+  entries_.splice(entries_.begin(), entries_, itFound->second);
+
+  return (itFound->second->response);
+}
+
+
+bool ApiResponseCache::insert(const ApiRequest& request, const ApiResponsePtr& response, const std::string& endpoint) {
+  if (!response) {
+    return (false);
+  }
+
+  std::string key(makeKey(request, endpoint));
+  std::uint64_t fingerprint(makeFingerprint(request, endpoint));
+  std::size_t bytes(estimateBytes(*response) + key.capacity() + sizeof(Entry));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  EntryIndex::iterator itFound(findEntry(fingerprint, request, endpoint));
+
+  if (itFound != index_.end()) {
+    eraseEntry(itFound);
+  }
+
+  if (bytes > maxBytes_) {
+    return (false);
+  }
+
+  evict(maxBytes_ - bytes);
+
+  Entry entry;
+  entry.key = key;
+  entry.fingerprint = fingerprint;
+  entry.response = response;
+  entry.bytes = bytes;
+
+  entries_.push_front(entry);
+  index_.insert(EntryIndex::value_type(fingerprint, entries_.begin()));
+  bytes_ += bytes;
+
+  ++stats_.insertions;
+
+  return (true);
+}
+
+
+bool ApiResponseCache::erase(const ApiRequest& request, const std::string& endpoint) {
+  std::uint64_t fingerprint(makeFingerprint(request, endpoint));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  EntryIndex::iterator itFound(findEntry(fingerprint, request, endpoint));
+
+  if (itFound == index_.end()) {
+    return (false);
+  }
+
+  eraseEntry(itFound);
+
+  return (true);
+}
+
+
+void ApiResponseCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+
+std::size_t ApiResponseCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (index_.size());
+}
+
+
+std::size_t ApiResponseCache::getBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (bytes_);
+}
+
+
+std::size_t ApiResponseCache::getMaxBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (maxBytes_);
+}
+
+
+ApiResponseCache::Stats ApiResponseCache::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (stats_);
+}
+
+
+void ApiResponseCache::resetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_ = Stats();
+}
+
+
+std::string ApiResponseCache::makeKey(const ApiRequest& request, const std::string& endpoint) {
+  // the encoded query has the parameters sorted, and their names lower-cased,
+  // so that the same parameters always produce the same key
+
+  const std::string& query(request.getEncodedQuery());
+
+  std::string key;
+  key.reserve(endpoint.size() + 1 + request.getEntity().size() + 1 + query.size());
+
+  if (!endpoint.empty()) {
+    key.append(endpoint).append(1, '/');
+  }
+
+  key.append(request.getEntity());
+
+  if (!query.empty()) {
+    key.append(1, '?').append(query);
+  }
+
+  return (key);
+}
+
+
+std::uint64_t ApiResponseCache::makeFingerprint(const ApiRequest& request, const std::string& endpoint) {
+  const std::string& entity(request.getEntity());
+
+  std::uint64_t fingerprint(internal::fingerprint64(entity.data(), entity.size(), request.getFingerprint()));
+
+  if (!endpoint.empty()) {
+    fingerprint = internal::fingerprint64(endpoint.data(), endpoint.size(), fingerprint);
+  }
+
+  return (fingerprint);
+}
+
+
+std::size_t ApiResponseCache::estimateBytes(const ApiResponse& response) {
+  std::size_t bytes(sizeof(ApiResponse)
+                    + entityBytes(response.result)
+                    + stringBytes(response.error.code)
+                    + stringBytes(response.error.message)
+                    + (response.entities.capacity() - response.entities.size()) * sizeof(ApiEntity));
+
+  for (ApiResponse::ApiEntityVector::const_iterator it = response.entities.begin();
+       it != response.entities.end();
+       ++it) {
+    bytes += entityBytes(*it);
+  }
+
+  return (bytes);
+}
+
+
+ApiResponseCache::EntryIndex::iterator ApiResponseCache::findEntry(std::uint64_t fingerprint, const ApiRequest& request, const std::string& endpoint) {
+  std::pair<EntryIndex::iterator, EntryIndex::iterator> range(index_.equal_range(fingerprint));
+
+  for (EntryIndex::iterator it = range.first; it != range.second; ++it) {
+    if (matchesKey(it->second->key, request, endpoint)) {
+      return (it);
+    }
+  }
+
+  return (index_.end());
+}
+
+
+ApiResponseCache::EntryIndex::iterator ApiResponseCache::findEntry(EntryList::iterator itEntry) {
+  std::pair<EntryIndex::iterator, EntryIndex::iterator> range(index_.equal_range(itEntry->fingerprint));
+
+  for (EntryIndex::iterator it = range.first; it != range.second; ++it) {
+    if (it->second == itEntry) {
+      return (it);
+    }
+  }
+
+  return (index_.end());
+}
+
+
+void ApiResponseCache::evict(std::size_t maxBytes) {
+  while (bytes_ > maxBytes && !entries_.empty()) {
+    eraseEntry(findEntry(--entries_.end()));
+    ++stats_.evictions;
+  }
+}
+
+
+void ApiResponseCache::eraseEntry(EntryIndex::iterator itIndex) {
+  bytes_ -= itIndex->second->bytes;
+  entries_.erase(itIndex->second);
+  index_.erase(itIndex);
+}
+
+
+bool ApiResponseCache::matchesKey(const std::string& key, const ApiRequest& request, const std::string& endpoint) {
+  // compares with the key of the request, without making it
+
+  const std::string& entity(request.getEntity());
+  const std::string& query(request.getEncodedQuery());
+
+  std::size_t pos(endpoint.empty() ? 0 : endpoint.size() + 1);
+
+  if (key.size() != pos + entity.size() + (query.empty() ? 0 : query.size() + 1)
+      || (pos && (0 != key.compare(0, endpoint.size(), endpoint) || '/' != key[pos - 1]))
+      || 0 != key.compare(pos, entity.size(), entity)) {
+    return (false);
+  }
+
+  pos += entity.size();
+
+  return (query.empty()
+          || ('?' == key[pos]
+              && 0 == key.compare(pos + 1, std::string::npos, query)));
+}
+
+
+} // namespace fredcpp
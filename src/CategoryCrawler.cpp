@@ -0,0 +1,317 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/CategoryCrawler.h>
+
+#include <fredcpp/Api.h>
+#include <fredcpp/ApiLog.h>
+#include <fredcpp/ApiRequestBuilder.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+
+namespace fredcpp {
+
+const std::size_t CategoryCrawler::DEFAULT_MAX_BATCH_SIZE(64);
+const unsigned long CategoryCrawler::DEFAULT_SERIES_PAGE_SIZE(1000);
+
+
+namespace {
+
+std::string toString(unsigned long number) {
+  std::ostringstream buf;
+  buf << number;
+  return (buf.str());
+}
+
+
+unsigned long attributeNumber(const ApiEntity& entity, const std::string& name) {
+  return (std::strtoul(entity.attribute(name).c_str(), NULL, 10));
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+CategoryCrawlerSink::~CategoryCrawlerSink() {
+}
+
+
+void CategoryCrawlerSink::onCategory(const ApiEntity& category, const std::string& parentId) {
+}
+
+
+bool CategoryCrawlerSink::onError(const ApiRequest& request, const ApiResponse& response) {
+  return (false);
+}
+
+//______________________________________________________________________________
+
+CategoryCrawler::Stats::Stats()
+  : categories(0)
+  , series(0)
+  , duplicateSeries(0)
+  , requests(0)
+  , batches(0)
+  , failedRequests(0) {
+}
+
+
+CategoryCrawler::Task::Task(TaskKind taskKind, const std::string& id, const ApiRequest& apiRequest)
+  : kind(taskKind)
+  , categoryId(id)
+  , request(apiRequest) {
+}
+
+//______________________________________________________________________________
+
+/// Dispatches responses of a batch of tasks.
+
+class CategoryCrawler::BatchHandler : public ApiResponseHandler {
+public:
+  BatchHandler(CategoryCrawler& crawler, const TaskVector& tasks, std::size_t firstTask,
+               std::vector<std::string>& nextLevel, TaskVector& moreTasks)
+    : crawler_(crawler)
+    , tasks_(tasks)
+    , firstTask_(firstTask)
+    , nextLevel_(nextLevel)
+    , moreTasks_(moreTasks) {
+  }
+
+  void onResponse(std::size_t index, const ApiRequest& request, ApiResponse& response) {
+    if (crawler_.stopped_) {
+      return;
+    }
+
+    const Task& task(tasks_[firstTask_ + index]);
+
+    if (!response.good()) {
+      ++crawler_.stats_.failedRequests;
+
+      FREDCPP_LOG_DEBUG("crawler:request failed:" << request << " error:" << response.error);
+
+      if (!crawler_.sink_->onError(request, response)) {
+        crawler_.stopped_ = true;
+      }
+      return;
+    }
+
+    if (TASK_CHILDREN == task.kind) {
+      crawler_.onChildren(task, response, nextLevel_);
+
+    } else {
+      crawler_.onSeries(task, response, moreTasks_);
+    }
+  }
+
+private:
+  CategoryCrawler& crawler_;
+  const TaskVector& tasks_;
+  std::size_t firstTask_;
+  std::vector<std::string>& nextLevel_;
+  TaskVector& moreTasks_;
+};
+
+//______________________________________________________________________________
+
+CategoryCrawler::CategoryCrawler(Api& api)
+  : api_(api)
+  , maxBatchSize_(DEFAULT_MAX_BATCH_SIZE)
+  , maxDepth_(0)
+  , listSeries_(true)
+  , seriesPageSize_(DEFAULT_SERIES_PAGE_SIZE)
+  , sink_(NULL)
+  , stopped_(false) {
+}
+
+
+CategoryCrawler::~CategoryCrawler() {
+}
+
+
+CategoryCrawler& CategoryCrawler::withMaxBatchSize(std::size_t size) {
+  maxBatchSize_ = std::max(size, static_cast<std::size_t>(1));
+  return (*this);
+}
+
+
+CategoryCrawler& CategoryCrawler::withMaxDepth(unsigned depth) {
+  maxDepth_ = depth;
+  return (*this);
+}
+
+
+CategoryCrawler& CategoryCrawler::withSeries(bool listSeries) {
+  listSeries_ = listSeries;
+  return (*this);
+}
+
+
+CategoryCrawler& CategoryCrawler::withSeriesPageSize(unsigned long size) {
+  seriesPageSize_ = size;
+  return (*this);
+}
+
+
+bool CategoryCrawler::crawl(const std::string& rootCategory, CategoryCrawlerSink& sink) {
+  bool result(true);
+
+  sink_ = &sink;
+  stopped_ = false;
+  stats_ = Stats();
+  visitedCategories_.clear();
+  visitedSeries_.clear();
+
+  visitedCategories_.insert(rootCategory);
+  ++stats_.categories;
+
+  std::vector<std::string> level(1, rootCategory);
+  unsigned depth(0);
+
+  while (!level.empty() && !stopped_) {
+    bool expand(0 == maxDepth_ || depth < maxDepth_);
+
+    FREDCPP_LOG_DEBUG("crawler:level:" << depth << " categories:" << level.size());
+
+    TaskVector tasks;
+
+    for (std::size_t n = 0; n < level.size(); ++n) {
+      if (expand) {
+        tasks.push_back(Task(TASK_CHILDREN, level[n], ApiRequestBuilder::CategoryChildren(level[n])));
+      }
+
+      if (listSeries_) {
+        tasks.push_back(Task(TASK_SERIES, level[n],
+                             ApiRequestBuilder::CategorySeries(level[n])
+                               .withLimit(toString(seriesPageSize_))));
+      }
+    }
+
+    std::vector<std::string> nextLevel;
+    result = runTasks(tasks, nextLevel) && result;
+
+    level.swap(nextLevel);
+    ++depth;
+  }
+
+  FREDCPP_LOG_DEBUG("crawler:root:" << rootCategory
+                    << " categories:" << stats_.categories
+                    << " series:" << stats_.series
+                    << " requests:" << stats_.requests
+                    << " batches:" << stats_.batches);
+
+  sink_ = NULL;
+
+  return (result && !stopped_);
+}
+
+
+const CategoryCrawler::Stats& CategoryCrawler::getStats() const {
+  return (stats_);
+}
+
+
+bool CategoryCrawler::runTasks(TaskVector& tasks, std::vector<std::string>& nextLevel) {
+  bool result(true);
+
+  // tasks may grow with further pages of series, these run in later batches
+
+  for (std::size_t pos = 0; pos < tasks.size() && !stopped_; ) {
+    std::size_t count(std::min(maxBatchSize_, tasks.size() - pos));
+
+    ApiRequestVector requests;
+    requests.reserve(count);
+
+    for (std::size_t n = pos; n < pos + count; ++n) {
+      requests.push_back(tasks[n].request);
+    }
+
+    TaskVector moreTasks;
+    BatchHandler handler(*this, tasks, pos, nextLevel, moreTasks);
+
+    result = api_.getBatch(requests, handler) && result;
+
+    ++stats_.batches;
+    stats_.requests += count;
+
+    pos += count;
+    tasks.insert(tasks.end(), moreTasks.begin(), moreTasks.end());
+  }
+
+  return (result);
+}
+
+
+void CategoryCrawler::onChildren(const Task& task, const ApiResponse& response, std::vector<std::string>& nextLevel) {
+  for (std::size_t n = 0; n < response.entities.size(); ++n) {
+    const ApiEntity& category(response.entities[n]);
+    std::string categoryId(category.attribute("id"));
+
+    if (!visitedCategories_.insert(categoryId).second) {
+      continue;
+    }
+
+    ++stats_.categories;
+    sink_->onCategory(category, task.categoryId);
+
+    nextLevel.push_back(categoryId);
+  }
+}
+
+
+void CategoryCrawler::onSeries(const Task& task, const ApiResponse& response, TaskVector& tasks) {
+
+  // a series may belong to many categories, pass it on only once
+
+  for (std::size_t n = 0; n < response.entities.size(); ++n) {
+    const ApiEntity& series(response.entities[n]);
+
+    if (!visitedSeries_.insert(series.attribute("id")).second) {
+      ++stats_.duplicateSeries;
+      continue;
+    }
+
+    ++stats_.series;
+    sink_->onSeries(series, task.categoryId);
+  }
+
+
+  // request the next page
+
+  unsigned long count(attributeNumber(response.result, "count"));
+  unsigned long offset(attributeNumber(response.result, "offset"));
+  unsigned long limit(attributeNumber(response.result, "limit"));
+
+  if (limit && offset + limit < count) {
+    Task nextPage(task);
+    nextPage.request.with("offset", toString(offset + limit));
+
+    tasks.push_back(nextPage);
+  }
+}
+
+
+} // namespace fredcpp
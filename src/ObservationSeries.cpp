@@ -0,0 +1,485 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/ObservationSeries.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <ostream>
+
+
+namespace fredcpp {
+
+namespace {
+
+bool isDigit(char c) {
+  return (c >= '0' && c <= '9');
+}
+
+
+// Date digits are validated and combined a whole 8-byte word at a time
+// (SWAR), a `YYYY-MM-DD` date is read as two overlapping words:
+// "YYYY-MM-" and "YY-MM-DD".
+
+const std::uint64_t ZERO_BYTES(0x3030303030303030ULL);
+const std::uint64_t DASH_BYTES(0x2D2D2D2D2D2D2D2DULL);
+const std::uint64_t HIGH_BITS(0x8080808080808080ULL);
+const std::uint64_t ABOVE_NINE(0x4646464646464646ULL);   // '9' + 0x46 == 0x7F
+
+const std::uint64_t HEAD_DASHES(0xFF0000FF00000000ULL);  // "YYYY-MM-"
+const std::uint64_t TAIL_DASHES(0x0000FF0000FF0000ULL);  // "YY-MM-DD"
+
+
+// Loads 8 bytes as a little-endian word, compiles into a single load.
+std::uint64_t loadWord(const char* str) {
+  const unsigned char* p(reinterpret_cast<const unsigned char*>(str));
+
+  return (  static_cast<std::uint64_t>(p[0])
+          | static_cast<std::uint64_t>(p[1]) << 8
+          | static_cast<std::uint64_t>(p[2]) << 16
+          | static_cast<std::uint64_t>(p[3]) << 24
+          | static_cast<std::uint64_t>(p[4]) << 32
+          | static_cast<std::uint64_t>(p[5]) << 40
+          | static_cast<std::uint64_t>(p[6]) << 48
+          | static_cast<std::uint64_t>(p[7]) << 56);
+}
+
+
+// Tests that the word bytes are digits, except the masked bytes that must be
+// dashes. Returns digit values per byte, dash bytes as zero.
+bool readDigits(std::uint64_t word, std::uint64_t dashMask, std::uint64_t& digits) {
+  if ((word & dashMask) != (DASH_BYTES & dashMask)) {
+    return (false);
+  }
+
+  word = (word & ~dashMask) | (ZERO_BYTES & dashMask);
+  digits = word - ZERO_BYTES;
+
+  // a byte below '0' borrows into its high bit, a byte above '9' carries
+  // into it; the lowest invalid byte is always flagged
+  return (0 == (((word + ABOVE_NINE) | digits) & HIGH_BITS));
+}
+
+
+// Combines each byte with the next one: byte n = 10 * digit n + digit n+1.
+std::uint64_t pairDigits(std::uint64_t digits) {
+  return (digits * 10 + (digits >> 8));
+}
+
+
+int byteAt(std::uint64_t word, int n) {
+  return (static_cast<int>((word >> (8 * n)) & 0xFF));
+}
+
+
+// Days from civil date, proleptic Gregorian calendar (year >= 0).
+int daysFromCivil(int y, int m, int d) {
+  y -= (m <= 2);
+  int era(y / 400);
+  int yoe(y - era * 400);
+  int doy((153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1);
+  int doe(yoe * 365 + yoe / 4 - yoe / 100 + doy);
+
+  return (era * 146097 + doe - 719468);
+}
+
+
+ObservationSeries::DayNumber decodeDate(const std::string& date) {
+  // YYYY-MM-DD
+
+  std::uint64_t head(0);
+  std::uint64_t tail(0);
+
+  if (10 != date.size()
+      || !readDigits(loadWord(date.data()), HEAD_DASHES, head)
+      || !readDigits(loadWord(date.data() + 2), TAIL_DASHES, tail)) {
+    return (ObservationSeries::INVALID_DAY);
+  }
+
+  head = pairDigits(head);
+  tail = pairDigits(tail);
+
+  int y(byteAt(head, 0) * 100 + byteAt(head, 2));
+  int m(byteAt(head, 5));
+  int d(byteAt(tail, 6));
+
+  if (m < 1 || m > 12 || d < 1 || d > 31) {
+    return (ObservationSeries::INVALID_DAY);
+  }
+
+  return (daysFromCivil(y, m, d));
+}
+
+//______________________________________________________________________________
+
+// Powers of ten exactly representable as double.
+const double EXACT_POWERS_OF_TEN[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+  1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+const int MAX_DIGITS(19);                                // fit in 64 bits
+const std::uint64_t MAX_EXACT_MANTISSA(1ULL << 53);
+
+
+double decodeValueSlow(const std::string& value) {
+  const char* begin(value.c_str());
+  char* end(NULL);
+
+  double result(std::strtod(begin, &end));
+
+  if (end == begin || end != begin + value.size()) {
+    // missing value ".", malformed or followed by trailing characters
+    return (std::numeric_limits<double>::quiet_NaN());
+  }
+
+  return (result);
+}
+
+
+double decodeValue(const std::string& value) {
+  // fast path: [-]digits[.digits] with the digits fitting into double mantissa
+  // is converted exactly by a single division (Clinger's fast path);
+  // anything else (exponent, long mantissa, spaces...) is left to strtod
+
+  const char* p(value.data());
+  const char* end(p + value.size());
+
+  if (1 == value.size() && '.' == *p) {
+    return (std::numeric_limits<double>::quiet_NaN());
+  }
+
+  bool negative(p != end && '-' == *p);
+  if (negative) {
+    ++p;
+  }
+
+  std::uint64_t mantissa(0);
+
+  const char* integerBegin(p);
+  for (; p != end && isDigit(*p); ++p) {
+    mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+  }
+  std::ptrdiff_t digitCount(p - integerBegin);
+
+  std::ptrdiff_t fractionCount(0);
+  if (p != end && '.' == *p) {
+    const char* fractionBegin(++p);
+    for (; p != end && isDigit(*p); ++p) {
+      mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+    }
+    fractionCount = p - fractionBegin;
+    digitCount += fractionCount;
+  }
+
+  if (p != end || 0 == digitCount || digitCount > MAX_DIGITS
+      || mantissa > MAX_EXACT_MANTISSA) {
+    return (decodeValueSlow(value));
+  }
+
+  double result(static_cast<double>(mantissa) / EXACT_POWERS_OF_TEN[fractionCount]);
+
+  return (negative ? -result : result);
+}
+
+//______________________________________________________________________________
+
+// Finds attribute value by interned name, comparing symbols only.
+const std::string* findAttribute(const internal::AttributeMap& attributes,
+                                 const internal::Symbol& name) {
+  for (internal::AttributeMap::const_iterator it = attributes.begin();
+       it != attributes.end(); ++it) {
+    if (it->first == name) {
+      return (&it->second);
+    }
+  }
+
+  return (NULL);
+}
+
+
+template <typename Value>
+void decodeColumn(const std::vector<ApiEntity>& entities, const std::string& name,
+                  Value (*decode)(const std::string&), Value missing,
+                  std::vector<Value>& result) {
+  result.resize(entities.size());
+
+  internal::Symbol symbol;
+  if (!internal::SymbolTable::getInstance().find(name, symbol)) {
+    // no entity has the attribute
+    std::fill(result.begin(), result.end(), missing);
+    return;
+  }
+
+  for (std::size_t n = 0; n < entities.size(); ++n) {
+    const std::string* value(findAttribute(entities[n].attributes, symbol));
+    result[n] = (value ? decode(*value) : missing);
+  }
+}
+
+
+template <typename Value>
+bool isConstant(const std::vector<Value>& values) {
+  for (std::size_t n = 1; n < values.size(); ++n) {
+    if (values[n] != values[0]) {
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+void writeNumber(char* buf, int number, std::size_t count) {
+  for (std::size_t n = count; n > 0; --n) {
+    buf[n - 1] = static_cast<char>('0' + number % 10);
+    number /= 10;
+  }
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+const ObservationSeries::DayNumber ObservationSeries::INVALID_DAY(INT_MIN);
+const std::string ObservationSeries::ENTITY_OBSERVATION("observation");
+
+
+ObservationSeries::ObservationSeries() {
+  clear();
+}
+
+
+ObservationSeries::~ObservationSeries() {
+}
+
+
+std::size_t ObservationSeries::size() const {
+  return (dates_.size());
+}
+
+
+bool ObservationSeries::empty() const {
+  return (dates_.empty());
+}
+
+
+ObservationSeries::DayNumber ObservationSeries::date(std::size_t n) const {
+  return (dates_[n]);
+}
+
+
+double ObservationSeries::value(std::size_t n) const {
+  return (values_[n]);
+}
+
+
+bool ObservationSeries::isMissing(std::size_t n) const {
+  return (values_[n] != values_[n]);   // NaN
+}
+
+
+ObservationSeries::DayNumber ObservationSeries::realtimeStart(std::size_t n) const {
+  return (realtimeStarts_.empty() ? realtimeStart_ : realtimeStarts_[n]);
+}
+
+
+ObservationSeries::DayNumber ObservationSeries::realtimeEnd(std::size_t n) const {
+  return (realtimeEnds_.empty() ? realtimeEnd_ : realtimeEnds_[n]);
+}
+
+
+bool ObservationSeries::hasConstantRealtime() const {
+  return (realtimeStarts_.empty());
+}
+
+
+const std::vector<ObservationSeries::DayNumber>& ObservationSeries::dates() const {
+  return (dates_);
+}
+
+
+const std::vector<double>& ObservationSeries::values() const {
+  return (values_);
+}
+
+
+void ObservationSeries::append(DayNumber date, double value, DayNumber realtimeStart, DayNumber realtimeEnd) {
+  if (dates_.empty()) {
+    realtimeStart_ = realtimeStart;
+    realtimeEnd_ = realtimeEnd;
+
+  } else if (realtimeStarts_.empty()
+             && (realtimeStart != realtimeStart_ || realtimeEnd != realtimeEnd_)) {
+    // realtime period varies, keep it per observation from now on
+    realtimeStarts_.assign(dates_.size(), realtimeStart_);
+    realtimeEnds_.assign(dates_.size(), realtimeEnd_);
+  }
+
+  if (!realtimeStarts_.empty()) {
+    realtimeStarts_.push_back(realtimeStart);
+    realtimeEnds_.push_back(realtimeEnd);
+  }
+
+  dates_.push_back(date);
+  values_.push_back(value);
+}
+
+
+void ObservationSeries::reserve(std::size_t count) {
+  dates_.reserve(count);
+  values_.reserve(count);
+}
+
+
+void ObservationSeries::clear() {
+  dates_.clear();
+  values_.clear();
+
+  realtimeStart_ = INVALID_DAY;
+  realtimeEnd_ = INVALID_DAY;
+  realtimeStarts_.clear();
+  realtimeEnds_.clear();
+}
+
+
+void ObservationSeries::onEntity(const ApiEntity& entity) {
+  if (ENTITY_OBSERVATION != entity.name) {
+    return;
+  }
+
+  append(toDayNumber(entity.attribute("date")),
+         toValue(entity.attribute("value")),
+         toDayNumber(entity.attribute("realtime_start")),
+         toDayNumber(entity.attribute("realtime_end")));
+}
+
+
+void ObservationSeries::onReset() {
+  clear();
+}
+
+
+void ObservationSeries::assign(const ApiResponse& response) {
+  clear();
+
+  toDayNumbers(response.entities, "date", dates_);
+  toValues(response.entities, "value", values_);
+  toDayNumbers(response.entities, "realtime_start", realtimeStarts_);
+  toDayNumbers(response.entities, "realtime_end", realtimeEnds_);
+
+  if (!empty()) {
+    realtimeStart_ = realtimeStarts_[0];
+    realtimeEnd_ = realtimeEnds_[0];
+  }
+
+  if (isConstant(realtimeStarts_) && isConstant(realtimeEnds_)) {
+    realtimeStarts_.clear();
+    realtimeEnds_.clear();
+  }
+}
+
+
+ObservationSeries::DayNumber ObservationSeries::toDayNumber(const std::string& date) {
+  return (decodeDate(date));
+}
+
+
+std::string ObservationSeries::toDateString(DayNumber day) {
+  if (INVALID_DAY == day) {
+    return (std::string());
+  }
+
+  // civil date from days, proleptic Gregorian calendar (year >= 0)
+  int z(day + 719468);
+  int era(z / 146097);
+  int doe(z - era * 146097);
+  int yoe((doe - doe / 1460 + doe / 36524 - doe / 146096) / 365);
+  int doy(doe - (365 * yoe + yoe / 4 - yoe / 100));
+  int mp((5 * doy + 2) / 153);
+  int d(doy - (153 * mp + 2) / 5 + 1);
+  int m(mp < 10 ? mp + 3 : mp - 9);
+  int y(yoe + era * 400 + (m <= 2));
+
+  char buf[10];
+  writeNumber(buf, y, 4);
+  buf[4] = '-';
+  writeNumber(buf + 5, m, 2);
+  buf[7] = '-';
+  writeNumber(buf + 8, d, 2);
+
+  return (std::string(buf, sizeof(buf)));
+}
+
+
+double ObservationSeries::toValue(const std::string& value) {
+  return (decodeValue(value));
+}
+
+
+void ObservationSeries::toDayNumbers(const std::vector<ApiEntity>& entities, const std::string& name,
+                                     std::vector<DayNumber>& result) {
+  decodeColumn(entities, name, &decodeDate, INVALID_DAY, result);
+}
+
+
+void ObservationSeries::toValues(const std::vector<ApiEntity>& entities, const std::string& name,
+                                 std::vector<double>& result) {
+  decodeColumn(entities, name, &decodeValue, std::numeric_limits<double>::quiet_NaN(), result);
+}
+
+
+std::ostream& ObservationSeries::print(std::ostream& os) const {
+  // observation:{date=...|value=...|realtime_start=...|realtime_end=...}
+
+  for (std::size_t n = 0; n < size(); ++n) {
+    os << ENTITY_OBSERVATION << ":{"
+       << "date=" << toDateString(date(n)) << "|"
+       << "value=";
+
+    if (isMissing(n)) {
+      os << ".";
+    } else {
+      os << value(n);
+    }
+
+    os << "|"
+       << "realtime_start=" << toDateString(realtimeStart(n)) << "|"
+       << "realtime_end=" << toDateString(realtimeEnd(n))
+       << "}" << std::endl;
+  }
+
+  return (os);
+}
+
+
+std::ostream& operator<< (std::ostream& os, const ObservationSeries& object) {
+  return (object.print(os));
+}
+
+
+} // namespace fredcpp
@@ -36,24 +36,65 @@
 namespace fredcpp {
 namespace external {
 
+namespace {
+
+/// Outcome of the last request of a thread.
+
+struct LastResult {
+  CURLcode status;
+  char errorBuf[CURL_ERROR_SIZE];
+};
+
+thread_local LastResult lastResult = { CURLE_FAILED_INIT, "" };
+
+} // namespace
+
+
 const unsigned CurlHttpClient::DEFAULT_TIMEOUT_SECS(15);
-const unsigned CurlHttpClient::DEFAULT_RETRY_WAIT_SECS(5);
-const unsigned CurlHttpClient::DEFAULT_RETRY_MAX_COUNT(3);
+const unsigned CurlHttpClient::DEFAULT_MAX_IDLE_SECS(60);
+const std::size_t CurlHttpClient::QUERY_SIZE_HINT(256);
 
 const std::string CurlHttpClient::DEFAULT_CA_CERT_FILE("cacert.pem");
 const std::string CurlHttpClient::ENV_CA_CERT_FILE("CURL_CA_BUNDLE");
 
 
+CurlHttpClient::ConnectionStats::ConnectionStats()
+  : requests(0)
+  , reusedConnections(0)
+  , newConnections(0)
+  , transferBytes(0)
+  , contentBytes(0) {
+}
+
+//______________________________________________________________________________
+
 CurlHttpClient::CurlHttpClient()
   : internal::HttpRequestExecutor("libcurl-agent/1.0")
+  , retryPolicy_(&defaultRetryPolicy_)
   , timeoutSecs_(DEFAULT_TIMEOUT_SECS)
-  , retryWaitSecs_(DEFAULT_RETRY_WAIT_SECS)
-  , retryMaxCount_(DEFAULT_RETRY_MAX_COUNT)
-  , CURLStatus_(CURLE_FAILED_INIT)
+  , maxIdleSecs_(DEFAULT_MAX_IDLE_SECS)
+  , compression_(true)
+  , share_(NULL)
   , writeDataCallback_(writeData) {
 
   curl_global_init(CURL_GLOBAL_ALL);
-  errorBuf_[0] = '\0';
+
+  // Share DNS and TLS-session caches between handles, handles of concurrent
+  // requests access them under locks.
+  // The connection cache is not shared: `cURL` does not support using a
+  // shared connection cache from concurrent threads. Each pooled handle
+  // keeps its own connections instead, and the pool hands out the most
+  // recently used (warm) handle first.
+
+  share_ = curl_share_init();
+
+  if (NULL != share_) {
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, shareLocks_);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
 
   // Initialize CACertFile
   CACertFile_.assign(DEFAULT_CA_CERT_FILE);
@@ -72,6 +113,14 @@ CurlHttpClient::CurlHttpClient()
 
 
 CurlHttpClient::~CurlHttpClient() {
+  for (std::size_t n = 0; n < handles_.size(); ++n) {
+    curl_easy_cleanup(handles_[n]);
+  }
+
+  if (NULL != share_) {
+    curl_share_cleanup(share_);
+  }
+
   curl_global_cleanup();
 }
 
@@ -89,13 +138,19 @@ CurlHttpClient& CurlHttpClient::withTimeout(unsigned secs) {
 
 
 CurlHttpClient& CurlHttpClient::withRetryWait(unsigned secs) {
-  retryWaitSecs_ = secs;
+  defaultRetryPolicy_.withInitialDelay(secs * 1000UL);
   return (*this);
 }
 
 
 CurlHttpClient& CurlHttpClient::withRetryCount(unsigned count) {
-  retryMaxCount_ = count;
+  defaultRetryPolicy_.withMaxRetries(count);
+  return (*this);
+}
+
+
+CurlHttpClient& CurlHttpClient::withRetryPolicy(internal::RetryPolicy* policy) {
+  retryPolicy_ = (NULL != policy ? policy : &defaultRetryPolicy_);
   return (*this);
 }
 
@@ -106,16 +161,42 @@ CurlHttpClient& CurlHttpClient::withCACertFile(const std::string& path) {
 }
 
 
+CurlHttpClient& CurlHttpClient::withMaxIdle(unsigned secs) {
+  maxIdleSecs_ = secs;
+  return (*this);
+}
+
+
+CurlHttpClient& CurlHttpClient::withCompression(bool enable) {
+  compression_ = enable;
+  return (*this);
+}
+
+
+bool CurlHttpClient::compressionEnabled() const {
+  return (compression_);
+}
+
+
+const internal::RetryPolicy& CurlHttpClient::getRetryPolicy() const {
+  return (*retryPolicy_);
+}
+
+
 bool CurlHttpClient::execute(const internal::HttpRequest& request, internal::HttpResponse& response) {
-  CURLStatus_ = CURLE_FAILED_INIT;
-  errorBuf_[0] = '\0';
+  CURLcode& status(lastResult.status);
+  char* errorBuf(lastResult.errorBuf);
+
+  status = CURLE_FAILED_INIT;
+  errorBuf[0] = '\0';
 
   bool retry(false);
   unsigned retryCount(0);
+  unsigned long long startedAt(internal::monotonicMillis());
 
   response.clear();
 
-  CURL* curl = curl_easy_init();
+  CURL* curl = acquireHandle();
 
   if (NULL == curl) {
     return (internal::HttpResponse::HTTP_OK == response.getHttpStatus());
@@ -130,120 +211,302 @@ bool CurlHttpClient::execute(const internal::HttpRequest& request, internal::Htt
     FREDCPP_LOG_DEBUG("CURL:CACertFile:" << CACertFile_ << " found:" << ifs.good());
   }
 
-  if (CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_USERAGENT, userAgent_.c_str()))
-      && CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeDataCallback_))
-      && CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L))
-      && CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L))
-      && CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_FILE, &response.getContentStream()))
-      && CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeoutSecs_))
-      && CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_URL, URI.c_str()))
-      && CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errorBuf_))
-      && (!request.isHttps()
-          || CURLE_OK == (CURLStatus_ = curl_easy_setopt(curl, CURLOPT_CAINFO, CACertFile_.c_str())))
-      ) {
+  curl_slist* headers(makeHeaderList(request));
+
+  if (CURLE_OK == (status = setupHandle(curl, URI, request.isHttps(), headers, response, errorBuf))) {
 
     do {
-      CURLStatus_ = curl_easy_perform(curl);
+      unsigned long long elapsed(internal::monotonicMillis() - startedAt);
 
-      if (CURLE_OK == CURLStatus_) {
-        // on successfull call get http-status and content-type
-
-        long code(0L);
-        char *strInfo(NULL);
-        if (CURLE_OK == curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code)
-            && CURLE_OK == curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &strInfo)) {
-          response.setHttpStatus(httpStatusFromCode(code));
-          response.setContentType(strInfo);
-        }
+      if (CURLE_OK != (status = limitTimeout(curl, elapsed))
+          || CURLE_OK != (status = curl_easy_perform(curl))) {
+        FREDCPP_LOG_DEBUG("CURL:Request failed CURLStatus:" << status
+                          << "|" << errorBuf);
 
       } else {
-        FREDCPP_LOG_DEBUG("CURL:Request failed CURLStatus:" << CURLStatus_
-                          << "|" << errorBuf_);
+        // on successfull call get http-status and content-type
+        readResponseInfo(curl, response);
       }
 
-      retry = (CURLE_OPERATION_TIMEDOUT == CURLStatus_
-               || CURLE_COULDNT_RESOLVE_HOST == CURLStatus_
-               || CURLE_COULDNT_RESOLVE_PROXY == CURLStatus_
-               || CURLE_COULDNT_CONNECT == CURLStatus_);
+      retry = isRetryable(status, response);
 
       if (retry) {
-        if (retryCount < retryMaxCount_) {
+        unsigned long delayMillis(0);
+        elapsed = internal::monotonicMillis() - startedAt;
+
+        if (retryPolicy_->nextRetry(retryCount + 1, elapsed, response, delayMillis)) {
           ++retryCount;
-          FREDCPP_LOG_DEBUG("CURL:Waiting " << retryWaitSecs_ << "ms"
+          FREDCPP_LOG_DEBUG("CURL:Waiting " << delayMillis << "ms"
                             << " before request retry " << retryCount << " ...");
-          internal::sleep(retryWaitSecs_);
+          internal::sleepMillis(delayMillis);
+
+          // discard the content received by the failed attempt
+          response.clear();
 
         } else {
           retry = false;
-          FREDCPP_LOG_DEBUG("CURL:Retry maximum count " << retryMaxCount_ << " reached - giving up.");
+          FREDCPP_LOG_DEBUG("CURL:Giving up after " << retryCount << " retries"
+                            << " in " << elapsed << "ms");
         }
       }
 
     } while (retry);
   }
 
-  if (CURLE_OK == CURLStatus_) {
-    FREDCPP_LOG_DEBUG("CURL:http-response:" << response.getHttpStatus()
-                      << " " << "content-type:" << response.getContentType());
+  // the handle no longer refers to the thread's error buffer
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, NULL);
+  releaseHandle(curl);
 
+  if (NULL != headers) {
+    curl_slist_free_all(headers);
   }
 
-  curl_easy_cleanup(curl);
+  if (CURLE_OK == status) {
+    FREDCPP_LOG_DEBUG("CURL:http-response:" << response.getHttpStatus()
+                      << " " << "content-type:" << response.getContentType()
+                      << " " << "bytes:" << response.getTransferBytes()
+                      << "/" << response.getContentBytes());
+
+  }
 
   return (internal::HttpResponse::HTTP_OK == response.getHttpStatus());
 }
 
 
 std::string CurlHttpClient::encodeURI(const std::string& URI) {
+  return (internal::percentEncode(URI));
+}
+
+
+std::string CurlHttpClient::getRequestString(const internal::HttpRequest& request) {
+  // the request query is percent-encoded the same way as encodeURI does;
+  // reserve enough for a typical FRED query to avoid growing the string
+
   std::string result;
+  result.reserve(request.getURI().size() + 1 + QUERY_SIZE_HINT);
+  result.append(request.getURI()).append(1, querySeparatorChar_);
 
-  CURL* curl = curl_easy_init();
+  std::size_t querySize(result.size());
+  request.appendEncodedQuery(result);
 
-  char* buf = curl_easy_escape(curl, URI.c_str(), URI.size());
-  if (NULL == buf ) {
-    //error
-    return result;
+  if (result.size() == querySize) {
+    result.resize(querySize - 1);
   }
 
-  result = std::string(buf);
-  curl_free(buf);
+  return (result);
+}
 
-  curl_easy_cleanup(curl);
 
+void CurlHttpClient::appendEncodedURI(std::string& buf, const std::string& URI) {
+  internal::appendPercentEncoded(buf, URI);
+}
 
-  // FIXUP: curl appears to also encode '_' (%5F), so need to undo this
 
-  struct URIEncodeDef {
-    std::string raw, encoded;
-  };
-  const URIEncodeDef UNDERSCORE = {"_","%5F"};
+CURLcode CurlHttpClient::getStatus() const {
+  return (lastResult.status);
+}
+
 
-  const std::string& search = UNDERSCORE.encoded;
-  const std::string& replaceWith = UNDERSCORE.raw;
+std::string CurlHttpClient::getErrorMsg() const {
+  return (std::string(lastResult.errorBuf));
+}
 
-  size_t pos = 0;
 
-  while ((pos = result.find(search, pos)) != std::string::npos) {
-    result.replace(pos, search.length(), replaceWith);
-    pos += replaceWith.length();
+const std::string& CurlHttpClient::getCACertFile() const {
+  return (CACertFile_);
+}
+
+
+CurlHttpClient::ConnectionStats CurlHttpClient::getConnectionStats() const {
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  return (connectionStats_);
+}
+
+
+void CurlHttpClient::resetConnectionStats() {
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  connectionStats_ = ConnectionStats();
+}
+
+
+CURLcode CurlHttpClient::setupHandle(CURL* curl, const std::string& URI, bool isHttps, curl_slist* headers, internal::HttpResponse& response, char* errorBuf) {
+  CURLcode status(CURLE_FAILED_INIT);
+
+  if (CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_USERAGENT, userAgent_.c_str()))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeDataCallback_))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_FILE, &response))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, readHeader))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeoutSecs_))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_URL, URI.c_str()))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errorBuf))
+      && (!isHttps
+          || CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_CAINFO, CACertFile_.c_str())))
+      && (NULL == share_
+          || CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_SHARE, share_)))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L))
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, (maxIdleSecs_ ? 0L : 1L)))
+#if LIBCURL_VERSION_NUM >= 0x074100
+      && (!maxIdleSecs_
+          || CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, maxIdleSecs_)))
+#endif
+      // empty list requests all encodings supported by the build, NULL none
+#if LIBCURL_VERSION_NUM >= 0x071506
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, (compression_ ? "" : NULL)))
+#else
+      && CURLE_OK == (status = curl_easy_setopt(curl, CURLOPT_ENCODING, (compression_ ? "" : NULL)))
+#endif
+      ) {
+    status = CURLE_OK;
   }
 
-  return (result);
+  return (status);
 }
 
 
-CURLcode CurlHttpClient::getStatus() const {
-  return (CURLStatus_);
+curl_slist* CurlHttpClient::makeHeaderList(const internal::HttpRequest& request) {
+  curl_slist* headers(NULL);
+
+  for (internal::KeyValueMap::const_iterator it = request.getHeaders().begin();
+       it != request.getHeaders().end();
+       ++it) {
+    std::string line(it->first + ": " + it->second);
+    curl_slist* appended(curl_slist_append(headers, line.c_str()));
+
+    if (NULL == appended) {
+      break;
+    }
+
+    headers = appended;
+  }
+
+  return (headers);
 }
 
 
-std::string CurlHttpClient::getErrorMsg() const {
-  return (std::string(errorBuf_));
+void CurlHttpClient::readResponseInfo(CURL* curl, internal::HttpResponse& response) {
+  long code(0L);
+  char *strInfo(NULL);
+
+  if (CURLE_OK == curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code)
+      && CURLE_OK == curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &strInfo)) {
+    response.setHttpStatus(httpStatusFromCode(code));
+    // no content-type with responses that have no content (e.g. not-modified)
+    response.setContentType(NULL != strInfo ? strInfo : "");
+  }
+
+  // downloaded size counts the content as received, before decompression
+
+#if LIBCURL_VERSION_NUM >= 0x073700
+  curl_off_t downloaded(0);
+
+  if (CURLE_OK == curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded)) {
+    response.setTransferBytes(static_cast<std::size_t>(downloaded));
+  }
+#else
+  double downloaded(0.0);
+
+  if (CURLE_OK == curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD, &downloaded)) {
+    response.setTransferBytes(static_cast<std::size_t>(downloaded));
+  }
+#endif
+
+  updateConnectionStats(curl, response);
 }
 
 
-const std::string& CurlHttpClient::getCACertFile() const {
-  return (CACertFile_);
+bool CurlHttpClient::isTransientError(CURLcode status) {
+  return (CURLE_OPERATION_TIMEDOUT == status
+          || CURLE_COULDNT_RESOLVE_HOST == status
+          || CURLE_COULDNT_RESOLVE_PROXY == status
+          || CURLE_COULDNT_CONNECT == status);
+}
+
+
+bool CurlHttpClient::isRetryable(CURLcode status, const internal::HttpResponse& response) const {
+  return (isTransientError(status)
+          || (CURLE_OK == status && retryPolicy_->isRetryableStatus(response.getHttpStatus())));
+}
+
+
+CURLcode CurlHttpClient::limitTimeout(CURL* curl, unsigned long long elapsedMillis) const {
+  unsigned long remaining(retryPolicy_->getRemainingMillis(elapsedMillis));
+  unsigned long timeoutMillis(static_cast<unsigned long>(timeoutSecs_) * 1000UL);
+
+  if (remaining && (!timeoutMillis || remaining < timeoutMillis)) {
+    timeoutMillis = remaining;
+  }
+
+  return (curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(timeoutMillis)));
+}
+
+
+CURL* CurlHttpClient::acquireHandle() {
+  // Keep the handles warm between requests; reset only clears the options,
+  // live connections and caches are retained.
+
+  CURL* curl(NULL);
+
+  {
+    std::lock_guard<std::mutex> lock(handlesMutex_);
+
+    if (!handles_.empty()) {
+      curl = handles_.back();
+      handles_.pop_back();
+    }
+  }
+
+  if (NULL == curl) {
+    curl = curl_easy_init();
+
+  } else {
+    curl_easy_reset(curl);
+  }
+
+  return (curl);
+}
+
+
+void CurlHttpClient::releaseHandle(CURL* curl) {
+  if (NULL != curl) {
+    std::lock_guard<std::mutex> lock(handlesMutex_);
+    handles_.push_back(curl);
+  }
+}
+
+
+void CurlHttpClient::updateConnectionStats(CURL* curl, const internal::HttpResponse& response) {
+  long connects(0L);
+
+  if (CURLE_OK != curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects)) {
+    return;
+  }
+
+  ConnectionStats stats;
+
+  {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+
+    ++connectionStats_.requests;
+
+    if (0L == connects) {
+      ++connectionStats_.reusedConnections;
+
+    } else {
+      connectionStats_.newConnections += connects;
+    }
+
+    connectionStats_.transferBytes += response.getTransferBytes();
+    connectionStats_.contentBytes += response.getContentBytes();
+
+    stats = connectionStats_;
+  }
+
+  FREDCPP_LOG_DEBUG("CURL:connections reused:" << stats.reusedConnections
+                    << " new:" << stats.newConnections);
 }
 
 
@@ -260,7 +523,18 @@ internal::HttpResponse::HttpStatus CurlHttpClient::httpStatusFromCode(long code)
 }
 
 
-// callback function writes data to a std::ostream
+// callback functions guard the data shared between handles
+void CurlHttpClient::lockShare(CURL* curl, curl_lock_data data, curl_lock_access access, void* userp) {
+  static_cast<std::mutex*>(userp)[data].lock();
+}
+
+
+void CurlHttpClient::unlockShare(CURL* curl, curl_lock_data data, void* userp) {
+  static_cast<std::mutex*>(userp)[data].unlock();
+}
+
+
+// callback function appends data to the content of internal::HttpResponse
 size_t CurlHttpClient::writeData(void* buf, size_t size, size_t nmemb, void* userp)
 {
   if (userp == NULL) {
@@ -268,18 +542,54 @@ size_t CurlHttpClient::writeData(void* buf, size_t size, size_t nmemb, void* use
     return 0;
   }
 
-  std::ostream& os = *static_cast<std::ostream*>(userp);
-  std::streamsize len = size * nmemb;
+  internal::HttpResponse& response = *static_cast<internal::HttpResponse*>(userp);
+  size_t len = size * nmemb;
+
+  response.appendContent(static_cast<char*>(buf), len);
 
-  if (!(os.write(static_cast<char*>(buf), len)) ) {
+  return (len);
+}
+
+
+// callback function stores a received header line in internal::HttpResponse
+size_t CurlHttpClient::readHeader(char* buf, size_t size, size_t nitems, void* userp)
+{
+  size_t len = size * nitems;
+
+  if (userp == NULL) {
     // error
     return 0;
   }
 
+  internal::HttpResponse& response = *static_cast<internal::HttpResponse*>(userp);
+  std::string line(buf, len);
+
+  // a status line starts a new response (redirect, 100-continue)
+  if (0 == line.compare(0, 5, "HTTP/")) {
+    response.clearHeaders();
+    return (len);
+  }
+
+  std::string::size_type colon(line.find(':'));
+
+  if (std::string::npos == colon) {
+    return (len);
+  }
+
+  std::string::size_type valueBegin(line.find_first_not_of(" \t", colon + 1));
+  std::string::size_type valueEnd(line.find_last_not_of(" \t\r\n"));
+
+  std::string value;
+
+  if (std::string::npos != valueBegin && valueEnd >= valueBegin) {
+    value.assign(line, valueBegin, valueEnd - valueBegin + 1);
+  }
+
+  response.setHeader(line.substr(0, colon), value);
+
   return (len);
 }
 
 
 } // namespace external
 } // namespace fredcpp
-
@@ -0,0 +1,357 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/external/CurlMultiHttpClient.h>
+
+#include <fredcpp/ApiLog.h>
+
+#include <fredcpp/internal/HttpRequest.h>
+#include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/RateLimiter.h>
+#include <fredcpp/internal/utils.h>
+
+#include <algorithm>
+#include <map>
+
+
+namespace fredcpp {
+namespace external {
+
+const unsigned CurlMultiHttpClient::DEFAULT_MAX_IN_FLIGHT(16);
+const int CurlMultiHttpClient::WAIT_TIMEOUT_MILLIS(100);
+
+
+/// State of a single transfer within the multi event loop.
+
+struct CurlMultiHttpClient::Transfer {
+  std::size_t index;
+  CURL* curl;
+  std::string URI;
+  curl_slist* headers;
+  internal::HttpResponse response;
+  char errorBuf[CURL_ERROR_SIZE];
+
+  Transfer()
+    : index(0)
+    , curl(NULL)
+    , headers(NULL) {
+    errorBuf[0] = '\0';
+  }
+
+  void freeHeaders() {
+    if (NULL != headers) {
+      curl_slist_free_all(headers);
+      headers = NULL;
+    }
+  }
+
+  ~Transfer() {
+    freeHeaders();
+  }
+};
+
+//______________________________________________________________________________
+
+CurlMultiHttpClient::CurlMultiHttpClient()
+  : CurlHttpClient()
+  , maxInFlight_(DEFAULT_MAX_IN_FLIGHT) {
+}
+
+
+CurlMultiHttpClient::~CurlMultiHttpClient() {
+  for (std::size_t n = 0; n < multis_.size(); ++n) {
+    curl_multi_cleanup(multis_[n]);
+  }
+}
+
+
+CurlMultiHttpClient& CurlMultiHttpClient::getInstance() {
+  static CurlMultiHttpClient instance;
+  return (instance);
+}
+
+
+CurlMultiHttpClient& CurlMultiHttpClient::withMaxInFlight(unsigned count) {
+  maxInFlight_ = (count ? count : 1);
+  return (*this);
+}
+
+
+unsigned CurlMultiHttpClient::getMaxInFlight() const {
+  return (maxInFlight_);
+}
+
+
+bool CurlMultiHttpClient::executeBatch(const internal::HttpRequestVector& requests, internal::HttpResponseHandler& handler, internal::RateLimiter* rateLimiter) {
+
+  CURLM* multi(requests.size() > 1 ? acquireMulti() : NULL);
+
+  if (NULL == multi) {
+    return (internal::HttpRequestExecutor::executeBatch(requests, handler, rateLimiter));
+  }
+
+  bool result(true);
+
+#if LIBCURL_VERSION_NUM >= 0x071E00
+  curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(maxInFlight_));
+#endif
+
+  std::size_t numTransfers(std::min(static_cast<std::size_t>(maxInFlight_), requests.size()));
+
+  std::vector<Transfer*> transfers;
+  std::vector<Transfer*> idle;
+
+  for (std::size_t n = 0; n < numTransfers; ++n) {
+    transfers.push_back(new Transfer());
+  }
+  idle = transfers;
+
+  // requests waiting to be re-started after a failed attempt, by ready time;
+  // they wait without holding a transfer slot, so other requests go on
+
+  std::vector<unsigned> retryCounts(requests.size(), 0);
+  std::vector<unsigned long long> startedAt(requests.size(), 0ULL);
+  std::multimap<unsigned long long, std::size_t> retries;
+
+  std::size_t next(0);
+  std::size_t completed(0);
+
+  FREDCPP_LOG_DEBUG("CURL:multi:batch-size:" << requests.size()
+                    << " max-in-flight:" << numTransfers);
+
+  while (completed < requests.size()) {
+
+    // Fill idle transfer slots with pending retries first, then new requests,
+    // as long as the rate limit allows
+
+    unsigned long long now(internal::monotonicMillis());
+    bool rateLimited(false);
+
+    while (!idle.empty()) {
+      std::size_t index(0);
+
+      bool haveReadyRetry(!retries.empty() && retries.begin()->first <= now);
+
+      if (!haveReadyRetry && next >= requests.size()) {
+        break;
+      }
+
+      if (NULL != rateLimiter && !rateLimiter->tryAcquire()) {
+        rateLimited = true;
+        break;
+      }
+
+      if (haveReadyRetry) {
+        index = retries.begin()->second;
+        retries.erase(retries.begin());
+
+      } else {
+        index = next++;
+        startedAt[index] = now;
+      }
+
+      Transfer& transfer = *idle.back();
+      idle.pop_back();
+
+      if (!startTransfer(multi, transfer, requests[index], index, now - startedAt[index])) {
+        FREDCPP_LOG_DEBUG("CURL:multi:Unable to start request:" << index);
+
+        // nothing was sent, the token is not used up
+        if (NULL != rateLimiter) {
+          rateLimiter->release();
+        }
+
+        result = false;
+        handler.onResponse(index, requests[index], transfer.response);
+        ++completed;
+
+        idle.push_back(&transfer);
+      }
+    }
+
+
+    // Drive transfers and collect the completed ones
+
+    int running(0);
+    curl_multi_perform(multi, &running);
+
+    CURLMsg* msg(NULL);
+    int msgsLeft(0);
+
+    while (NULL != (msg = curl_multi_info_read(multi, &msgsLeft))) {
+      if (CURLMSG_DONE != msg->msg) {
+        continue;
+      }
+
+      char* privatePtr(NULL);
+      curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &privatePtr);
+      Transfer& transfer = *reinterpret_cast<Transfer*>(privatePtr);
+
+      CURLcode status(msg->data.result);
+
+      curl_multi_remove_handle(multi, transfer.curl);
+
+      if (CURLE_OK == status) {
+        readResponseInfo(transfer.curl, transfer.response);
+
+      } else {
+        FREDCPP_LOG_DEBUG("CURL:multi:Request failed CURLStatus:" << status
+                          << "|" << transfer.errorBuf);
+      }
+
+      releaseHandle(transfer.curl);
+      transfer.curl = NULL;
+      transfer.freeHeaders();
+
+      std::size_t index(transfer.index);
+
+      unsigned long delayMillis(0);
+      unsigned long long elapsed(internal::monotonicMillis() - startedAt[index]);
+
+      if (isRetryable(status, transfer.response)
+          && retryPolicy_->nextRetry(retryCounts[index] + 1, elapsed, transfer.response, delayMillis)) {
+        ++retryCounts[index];
+
+        FREDCPP_LOG_DEBUG("CURL:multi:Request " << index << " re-queued for retry "
+                          << retryCounts[index] << " in " << delayMillis << "ms ...");
+
+        retries.insert(std::make_pair(internal::monotonicMillis() + delayMillis, index));
+
+      } else {
+        result = (internal::HttpResponse::HTTP_OK == transfer.response.getHttpStatus()) && result;
+
+        handler.onResponse(index, requests[index], transfer.response);
+        ++completed;
+      }
+
+      idle.push_back(&transfer);
+    }
+
+
+    // Wait for activity, but no longer than the next scheduled retry
+    // or the next available rate limit token
+
+    if (completed < requests.size()) {
+      int timeout(WAIT_TIMEOUT_MILLIS);
+
+      if (!retries.empty()) {
+        now = internal::monotonicMillis();
+        unsigned long long readyAt(retries.begin()->first);
+        unsigned long long waitMillis(readyAt > now ? readyAt - now : 0ULL);
+
+        timeout = static_cast<int>(std::min(waitMillis, static_cast<unsigned long long>(timeout)));
+      }
+
+      if (rateLimited) {
+        unsigned long waitMillis(rateLimiter->getWaitMillis());
+
+        timeout = static_cast<int>(std::min(waitMillis, static_cast<unsigned long>(timeout)));
+      }
+
+#if LIBCURL_VERSION_NUM >= 0x074200
+      curl_multi_poll(multi, NULL, 0, timeout, NULL);
+#else
+      curl_multi_wait(multi, NULL, 0, timeout, NULL);
+#endif
+    }
+  }
+
+  for (std::size_t n = 0; n < transfers.size(); ++n) {
+    delete transfers[n];
+  }
+
+  releaseMulti(multi);
+
+  return (result);
+}
+
+
+CURLM* CurlMultiHttpClient::acquireMulti() {
+  // Keep the multi handles, and so their connection caches, between batches;
+  // each batch in progress takes its own.
+
+  {
+    std::lock_guard<std::mutex> lock(multisMutex_);
+
+    if (!multis_.empty()) {
+      CURLM* multi(multis_.back());
+      multis_.pop_back();
+
+      return (multi);
+    }
+  }
+
+  CURLM* multi(curl_multi_init());
+
+#if LIBCURL_VERSION_NUM >= 0x072B00
+  if (NULL != multi) {
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+  }
+#endif
+
+  return (multi);
+}
+
+
+void CurlMultiHttpClient::releaseMulti(CURLM* multi) {
+  if (NULL != multi) {
+    std::lock_guard<std::mutex> lock(multisMutex_);
+    multis_.push_back(multi);
+  }
+}
+
+
+bool CurlMultiHttpClient::startTransfer(CURLM* multi, Transfer& transfer, const internal::HttpRequest& request, std::size_t index, unsigned long long elapsedMillis) {
+  transfer.index = index;
+  transfer.response.clear();
+  transfer.errorBuf[0] = '\0';
+  transfer.URI = getRequestString(request);
+  transfer.freeHeaders();
+  transfer.headers = makeHeaderList(request);
+
+  transfer.curl = acquireHandle();
+
+  if (NULL == transfer.curl) {
+    return (false);
+  }
+
+  FREDCPP_LOG_DEBUG("CURL:multi:URI:" << transfer.URI);
+
+  if (CURLE_OK != setupHandle(transfer.curl, transfer.URI, request.isHttps(), transfer.headers, transfer.response, transfer.errorBuf)
+      || CURLE_OK != limitTimeout(transfer.curl, elapsedMillis)
+      || CURLE_OK != curl_easy_setopt(transfer.curl, CURLOPT_PRIVATE, &transfer)
+      || CURLM_OK != curl_multi_add_handle(multi, transfer.curl)) {
+
+    releaseHandle(transfer.curl);
+    transfer.curl = NULL;
+
+    return (false);
+  }
+
+  return (true);
+}
+
+
+} // namespace external
+} // namespace fredcpp
@@ -0,0 +1,587 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/external/DiskCacheHttpClient.h>
+
+#include <fredcpp/ApiLog.h>
+
+#include <fredcpp/internal/HttpRequest.h>
+#include <fredcpp/internal/utils.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+
+namespace fredcpp {
+namespace external {
+
+const unsigned DiskCacheHttpClient::DEFAULT_TTL_SECS(3600);
+const std::string DiskCacheHttpClient::DEFAULT_IGNORED_PARAM("api_key");
+const std::string DiskCacheHttpClient::ENTRY_FILE_SIGNATURE("fredcpp-cache/1");
+
+
+namespace {
+
+const std::string HEADER_ETAG("ETag");
+const std::string HEADER_LAST_MODIFIED("Last-Modified");
+const std::string HEADER_IF_NONE_MATCH("If-None-Match");
+const std::string HEADER_IF_MODIFIED_SINCE("If-Modified-Since");
+
+
+/// FNV-1a 64-bit hash as hex string, names the entry file.
+
+std::string hashKey(const std::string& key) {
+  unsigned long long hash(14695981039346656037ULL);
+
+  for (std::string::const_iterator it = key.begin(); it != key.end(); ++it) {
+    hash ^= static_cast<unsigned char>(*it);
+    hash *= 1099511628211ULL;
+  }
+
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  std::string result(16, '0');
+
+  for (int i = 15; i >= 0; --i) {
+    result[i] = HEX_DIGITS[hash & 0xF];
+    hash >>= 4;
+  }
+
+  return (result);
+}
+
+
+void copyResponse(const internal::HttpResponse& from, internal::HttpResponse& to) {
+  to.clear();
+  to.setHttpStatus(from.getHttpStatus());
+  to.setContentType(from.getContentType());
+
+  for (internal::KeyValueMap::const_iterator it = from.getHeaders().begin();
+       it != from.getHeaders().end();
+       ++it) {
+    to.setHeader(it->first, it->second);
+  }
+
+  to.appendContent(from.getContent().data(), from.getContent().size());
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+DiskCacheHttpClient::CacheStats::CacheStats()
+  : hits(0)
+  , revalidated(0)
+  , misses(0)
+  , stores(0) {
+}
+
+
+DiskCacheHttpClient::CacheEntry::CacheEntry()
+  : storedAt(0)
+  , httpStatus(internal::HttpResponse::HTTP_UNKNOWN) {
+}
+
+
+bool DiskCacheHttpClient::CacheEntry::hasValidator() const {
+  return (!eTag.empty() || !lastModified.empty());
+}
+
+//______________________________________________________________________________
+
+/// Passes on responses of the requests forwarded to the wrapped executor,
+/// completing their cache entries.
+
+class DiskCacheHttpClient::BatchHandler : public internal::HttpResponseHandler {
+public:
+  BatchHandler(DiskCacheHttpClient& cache,
+               const internal::HttpRequestVector& requests,
+               internal::HttpResponseHandler& handler)
+    : cache_(cache)
+    , requests_(requests)
+    , handler_(handler)
+    , result_(true) {
+  }
+
+  void add(std::size_t index, const std::string& path, const CacheEntry& entry, bool isCached) {
+    indices_.push_back(index);
+    paths_.push_back(path);
+    entries_.push_back(entry);
+    cached_.push_back(isCached);
+  }
+
+  void onResponse(std::size_t index, const internal::HttpRequest& request, internal::HttpResponse& response) {
+    result_ = cache_.completeFetch(paths_[index], entries_[index], cached_[index], response, served_)
+              && result_;
+
+    handler_.onResponse(indices_[index], requests_[indices_[index]], served_);
+  }
+
+  bool getResult() const {
+    return (result_);
+  }
+
+
+private:
+  DiskCacheHttpClient& cache_;
+  const internal::HttpRequestVector& requests_;
+  internal::HttpResponseHandler& handler_;
+
+  std::vector<std::size_t> indices_;
+  std::vector<std::string> paths_;
+  std::vector<CacheEntry> entries_;
+  std::vector<bool> cached_;
+
+  internal::HttpResponse served_;
+  bool result_;
+};
+
+//______________________________________________________________________________
+
+DiskCacheHttpClient::DiskCacheHttpClient(internal::HttpRequestExecutor& executor, const std::string& directory)
+  : executor_(executor)
+  , directory_(directory)
+  , defaultTTLSecs_(DEFAULT_TTL_SECS) {
+
+  ignoredParams_.insert(DEFAULT_IGNORED_PARAM);
+
+  if (!internal::makeDirectory(directory_)) {
+    FREDCPP_LOG_WARN("CACHE:Failed to create cache directory:" << directory_);
+  }
+}
+
+
+DiskCacheHttpClient::~DiskCacheHttpClient() {
+}
+
+
+DiskCacheHttpClient& DiskCacheHttpClient::withTTL(const std::string& endpoint, unsigned secs) {
+  endpointTTLSecs_[endpoint] = secs;
+  return (*this);
+}
+
+
+DiskCacheHttpClient& DiskCacheHttpClient::withDefaultTTL(unsigned secs) {
+  defaultTTLSecs_ = secs;
+  return (*this);
+}
+
+
+DiskCacheHttpClient& DiskCacheHttpClient::withIgnoredParam(const std::string& name) {
+  ignoredParams_.insert(name);
+  return (*this);
+}
+
+
+bool DiskCacheHttpClient::execute(const internal::HttpRequest& request, internal::HttpResponse& response) {
+  return (executeLimited(request, response, NULL));
+}
+
+
+bool DiskCacheHttpClient::executeLimited(const internal::HttpRequest& request, internal::HttpResponse& response, internal::RateLimiter* rateLimiter) {
+  std::string key(getCacheKey(request));
+  std::string path(getEntryPath(key));
+
+  CacheEntry entry;
+  bool isCached(loadEntry(path, key, entry));
+
+  if (!isCached) {
+    entry = CacheEntry();
+    entry.key = key;
+  }
+
+  if (isCached && isFresh(entry, request)) {
+    FREDCPP_LOG_DEBUG("CACHE:hit:" << key);
+
+    incrementStat(cacheStats_.hits);
+    fillResponse(entry, response);
+
+    return (internal::HttpResponse::HTTP_OK == response.getHttpStatus());
+  }
+
+  internal::HttpRequest conditional(request);
+
+  if (isCached) {
+    addConditions(entry, conditional);
+  }
+
+  internal::HttpResponse fetched;
+  executor_.executeLimited(conditional, fetched, rateLimiter);
+
+  return (completeFetch(path, entry, isCached, fetched, response));
+}
+
+
+bool DiskCacheHttpClient::executeBatch(const internal::HttpRequestVector& requests, internal::HttpResponseHandler& handler, internal::RateLimiter* rateLimiter) {
+  bool result(true);
+
+  internal::HttpRequestVector pending;
+  BatchHandler pendingHandler(*this, requests, handler);
+  internal::HttpResponse served;
+
+  for (std::size_t n = 0; n < requests.size(); ++n) {
+    std::string key(getCacheKey(requests[n]));
+    std::string path(getEntryPath(key));
+
+    CacheEntry entry;
+    bool isCached(loadEntry(path, key, entry));
+
+    if (!isCached) {
+      entry = CacheEntry();
+      entry.key = key;
+    }
+
+    if (isCached && isFresh(entry, requests[n])) {
+      FREDCPP_LOG_DEBUG("CACHE:hit:" << key);
+
+      incrementStat(cacheStats_.hits);
+      fillResponse(entry, served);
+
+      result = (internal::HttpResponse::HTTP_OK == served.getHttpStatus()) && result;
+
+      handler.onResponse(n, requests[n], served);
+      continue;
+    }
+
+    pending.push_back(requests[n]);
+
+    if (isCached) {
+      addConditions(entry, pending.back());
+      entry.content.clear();  // reloaded when revalidated, no need to hold it
+    }
+
+    pendingHandler.add(n, path, entry, isCached);
+  }
+
+  if (!pending.empty()) {
+    executor_.executeBatch(pending, pendingHandler, rateLimiter);
+    result = pendingHandler.getResult() && result;
+  }
+
+  return (result);
+}
+
+
+std::string DiskCacheHttpClient::encodeURI(const std::string& URI) {
+  return (executor_.encodeURI(URI));
+}
+
+
+bool DiskCacheHttpClient::invalidate(const internal::HttpRequest& request) {
+  return (0 == std::remove(getEntryPath(getCacheKey(request)).c_str()));
+}
+
+
+std::string DiskCacheHttpClient::getCacheKey(const internal::HttpRequest& request) {
+  // reuse the encoded query of the request, its segments follow the
+  // parameter order, so that the ignored ones are skipped by position
+
+  const std::string& query(request.getEncodedQuery());
+
+  std::string buf;
+  buf.reserve(request.getURI().size() + 1 + query.size());
+  buf.append(request.getURI());
+
+  const internal::ParamMap& params(request.getParams());
+
+  std::size_t begin(0);
+  char separator(querySeparatorChar_);
+
+  for (internal::ParamMap::const_iterator it = params.begin();
+       it != params.end();
+       ++it) {
+
+    std::size_t end(query.find('&', begin));
+
+    if (std::string::npos == end) {
+      end = query.size();
+    }
+
+    if (!ignoredParams_.count(it->first)) {
+      buf.append(1, separator).append(query, begin, end - begin);
+      separator = queryParamSeparatorChar_;
+    }
+
+    begin = end + 1;
+  }
+
+  return (buf);
+}
+
+
+const std::string& DiskCacheHttpClient::getDirectory() const {
+  return (directory_);
+}
+
+
+DiskCacheHttpClient::CacheStats DiskCacheHttpClient::getCacheStats() const {
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  return (cacheStats_);
+}
+
+
+void DiskCacheHttpClient::resetCacheStats() {
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  cacheStats_ = CacheStats();
+}
+
+
+std::string DiskCacheHttpClient::getEntryPath(const std::string& key) const {
+  return (directory_ + "/" + hashKey(key) + ".cache");
+}
+
+
+unsigned DiskCacheHttpClient::getTTL(const internal::HttpRequest& request) const {
+  const std::string& URI(request.getURI());
+
+  unsigned ttl(defaultTTLSecs_);
+  std::size_t matchLength(0);
+
+  for (std::map<std::string, unsigned>::const_iterator it = endpointTTLSecs_.begin();
+       it != endpointTTLSecs_.end();
+       ++it) {
+    const std::string& endpoint(it->first);
+
+    if (endpoint.size() <= matchLength
+        || endpoint.size() > URI.size()
+        || 0 != URI.compare(URI.size() - endpoint.size(), endpoint.size(), endpoint)) {
+      continue;
+    }
+
+    // match whole path segments only
+    if (endpoint.size() < URI.size()
+        && '/' != URI[URI.size() - endpoint.size() - 1]) {
+      continue;
+    }
+
+    ttl = it->second;
+    matchLength = endpoint.size();
+  }
+
+  return (ttl);
+}
+
+
+bool DiskCacheHttpClient::isFresh(const CacheEntry& entry, const internal::HttpRequest& request) const {
+  std::time_t now(std::time(NULL));
+
+  return (now >= entry.storedAt
+          && static_cast<unsigned long>(now - entry.storedAt) < getTTL(request));
+}
+
+
+bool DiskCacheHttpClient::loadEntry(const std::string& path, const std::string& key, CacheEntry& entry) const {
+  std::ifstream ifs(path.c_str(), std::ios::in | std::ios::binary);
+
+  if (!ifs) {
+    return (false);
+  }
+
+  std::string line;
+
+  if (!std::getline(ifs, line) || ENTRY_FILE_SIGNATURE != line) {
+    return (false);
+  }
+
+  // header lines "name value" up to a blank line, then the content
+
+  while (std::getline(ifs, line) && !line.empty()) {
+    std::string::size_type space(line.find(' '));
+    std::string name(line.substr(0, space));
+    std::string value(std::string::npos == space ? std::string() : line.substr(space + 1));
+
+    if ("key" == name) {
+      entry.key = value;
+
+    } else if ("stored" == name) {
+      entry.storedAt = static_cast<std::time_t>(std::strtol(value.c_str(), NULL, 10));
+
+    } else if ("status" == name) {
+      entry.httpStatus = static_cast<internal::HttpResponse::HttpStatus>(std::atoi(value.c_str()));
+
+    } else if ("content-type" == name) {
+      entry.contentType = value;
+
+    } else if ("etag" == name) {
+      entry.eTag = value;
+
+    } else if ("last-modified" == name) {
+      entry.lastModified = value;
+    }
+  }
+
+  // different keys may share the hash
+  if (key != entry.key) {
+    return (false);
+  }
+
+  std::ostringstream content;
+
+  if (ifs.peek() != std::ifstream::traits_type::eof()) {
+    content << ifs.rdbuf();
+  }
+
+  entry.content = content.str();
+
+  return (true);
+}
+
+
+bool DiskCacheHttpClient::storeEntry(const std::string& path, const CacheEntry& entry) {
+  // write to a temporary file first, so that readers never see a partial entry;
+  // the name is unique, as other threads may be storing the same entry
+
+  static std::atomic<unsigned long> tempCount(0);
+
+  std::ostringstream tempPathStream;
+  tempPathStream << path << '.' << ++tempCount << ".tmp";
+
+  std::string tempPath(tempPathStream.str());
+
+  {
+    std::ofstream ofs(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    ofs << ENTRY_FILE_SIGNATURE << '\n'
+        << "key " << entry.key << '\n'
+        << "stored " << static_cast<long>(entry.storedAt) << '\n'
+        << "status " << static_cast<int>(entry.httpStatus) << '\n'
+        << "content-type " << entry.contentType << '\n'
+        << "etag " << entry.eTag << '\n'
+        << "last-modified " << entry.lastModified << '\n'
+        << '\n';
+
+    ofs.write(entry.content.data(), static_cast<std::streamsize>(entry.content.size()));
+
+    if (!ofs) {
+      FREDCPP_LOG_WARN("CACHE:Failed to write cache entry:" << tempPath);
+      std::remove(tempPath.c_str());
+      return (false);
+    }
+  }
+
+  if (0 != std::rename(tempPath.c_str(), path.c_str())) {
+    // some platforms do not replace an existing file
+    std::remove(path.c_str());
+
+    if (0 != std::rename(tempPath.c_str(), path.c_str())) {
+      FREDCPP_LOG_WARN("CACHE:Failed to replace cache entry:" << path);
+      std::remove(tempPath.c_str());
+      return (false);
+    }
+  }
+
+  incrementStat(cacheStats_.stores);
+
+  return (true);
+}
+
+
+void DiskCacheHttpClient::incrementStat(unsigned long& counter) {
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  ++counter;
+}
+
+
+void DiskCacheHttpClient::addConditions(const CacheEntry& entry, internal::HttpRequest& request) {
+  if (!entry.eTag.empty()) {
+    request.withHeader(HEADER_IF_NONE_MATCH, entry.eTag);
+  }
+
+  if (!entry.lastModified.empty()) {
+    request.withHeader(HEADER_IF_MODIFIED_SINCE, entry.lastModified);
+  }
+}
+
+
+void DiskCacheHttpClient::fillResponse(const CacheEntry& entry, internal::HttpResponse& response) {
+  response.clear();
+  response.setHttpStatus(entry.httpStatus);
+  response.setContentType(entry.contentType);
+
+  if (!entry.eTag.empty()) {
+    response.setHeader(HEADER_ETAG, entry.eTag);
+  }
+
+  if (!entry.lastModified.empty()) {
+    response.setHeader(HEADER_LAST_MODIFIED, entry.lastModified);
+  }
+
+  response.appendContent(entry.content.data(), entry.content.size());
+}
+
+
+bool DiskCacheHttpClient::completeFetch(const std::string& path, CacheEntry& entry, bool isCached,
+                                        const internal::HttpResponse& fetched, internal::HttpResponse& response) {
+
+  if (isCached
+      && internal::HttpResponse::HTTP_NOT_MODIFIED == fetched.getHttpStatus()) {
+    FREDCPP_LOG_DEBUG("CACHE:not-modified:" << entry.key);
+
+    // the batch drops content of stale entries, reload it
+    if (entry.content.empty()) {
+      CacheEntry reloaded;
+
+      if (loadEntry(path, entry.key, reloaded)) {
+        entry.content.swap(reloaded.content);
+      }
+    }
+
+    incrementStat(cacheStats_.revalidated);
+
+    entry.storedAt = std::time(NULL);
+    storeEntry(path, entry);
+
+    fillResponse(entry, response);
+
+    return (internal::HttpResponse::HTTP_OK == response.getHttpStatus());
+  }
+
+  incrementStat(cacheStats_.misses);
+
+  if (internal::HttpResponse::HTTP_OK != fetched.getHttpStatus()) {
+    copyResponse(fetched, response);
+    return (false);
+  }
+
+  FREDCPP_LOG_DEBUG("CACHE:store:" << entry.key);
+
+  entry.storedAt = std::time(NULL);
+  entry.httpStatus = fetched.getHttpStatus();
+  entry.contentType = fetched.getContentType();
+  entry.eTag = fetched.getHeader(HEADER_ETAG);
+  entry.lastModified = fetched.getHeader(HEADER_LAST_MODIFIED);
+  entry.content = fetched.getContent();
+
+  storeEntry(path, entry);
+
+  fillResponse(entry, response);
+
+  return (true);
+}
+
+
+} // namespace external
+} // namespace fredcpp
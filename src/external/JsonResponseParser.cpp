@@ -0,0 +1,514 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#include <fredcpp/external/JsonResponseParser.h>
+
+#include <fredcpp/ApiResponse.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+
+namespace fredcpp {
+namespace external {
+
+namespace {
+
+bool isSpace(char c) {
+  return (' ' == c || '\t' == c || '\n' == c || '\r' == c);
+}
+
+
+bool isDelimiter(char c) {
+  return (',' == c || '}' == c || ']' == c || isSpace(c));
+}
+
+
+void appendUtf8(std::string& out, unsigned long code) {
+  if (code < 0x80) {
+    out += static_cast<char>(code);
+
+  } else if (code < 0x800) {
+    out += static_cast<char>(0xC0 | (code >> 6));
+    out += static_cast<char>(0x80 | (code & 0x3F));
+
+  } else if (code < 0x10000) {
+    out += static_cast<char>(0xE0 | (code >> 12));
+    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code & 0x3F));
+
+  } else {
+    out += static_cast<char>(0xF0 | (code >> 18));
+    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code & 0x3F));
+  }
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+/// Single-pass reader of a FRED API JSON response.
+
+class JsonResponseParser::Reader {
+public:
+  Reader(const char* begin, const char* end)
+    : p_(begin)
+    , end_(end) {
+  }
+
+  bool readResponse(ApiResponse& response);
+
+private:
+  bool skipSpace();
+  bool expect(char c);
+  bool readString(std::string& out);
+  bool readEscape(std::string& out);
+  bool readHex(unsigned long& code);
+  bool readScalar(std::string& out);
+  bool skipValue();
+  bool readEntities(const std::string& entityName, ApiResponse& response);
+  bool readEntity(ApiEntity& entity);
+
+  const char* p_;
+  const char* end_;
+  std::string key_;
+  std::string skipped_;
+};
+
+
+bool JsonResponseParser::Reader::readResponse(ApiResponse& response) {
+  if (!expect('{') || !skipSpace()) {
+    return (false);
+  }
+
+  bool hasEntities(false);
+  bool isError(false);
+
+  if ('}' == *p_) {
+    ++p_;
+    return (!skipSpace());
+  }
+
+  while (true) {
+    if (!readString(key_) || !expect(':') || !skipSpace()) {
+      return (false);
+    }
+
+    bool good(true);
+
+    if ('[' == *p_ && !hasEntities) {
+      // the first array holds the entities
+      hasEntities = true;
+      response.result.name = key_;
+      good = readEntities(getEntityName(key_), response);
+
+    } else if ('[' == *p_ || '{' == *p_) {
+      good = skipValue();
+
+    } else if ("error_code" == key_) {
+      isError = true;
+      good = readScalar(response.result.attributes["code"]);
+
+    } else if ("error_message" == key_) {
+      good = readScalar(response.result.attributes["message"]);
+
+    } else {
+      good = readScalar(response.result.attributes[key_]);
+    }
+
+    if (!good || !skipSpace()) {
+      return (false);
+    }
+
+    char c(*p_++);
+
+    if ('}' == c) {
+      break;
+    }
+
+    if (',' != c) {
+      return (false);
+    }
+  }
+
+  if (isError) {
+    response.result.name = "error";
+  }
+
+  // nothing but space may follow
+  return (!skipSpace());
+}
+
+
+bool JsonResponseParser::Reader::skipSpace() {
+  while (p_ < end_ && isSpace(*p_)) {
+    ++p_;
+  }
+
+  return (p_ < end_);
+}
+
+
+bool JsonResponseParser::Reader::expect(char c) {
+  if (!skipSpace() || c != *p_) {
+    return (false);
+  }
+
+  ++p_;
+  return (true);
+}
+
+
+bool JsonResponseParser::Reader::readString(std::string& out) {
+  if (!expect('"')) {
+    return (false);
+  }
+
+  out.clear();
+
+  while (true) {
+    const char* quote(static_cast<const char*>(std::memchr(p_, '"', end_ - p_)));
+
+    if (NULL == quote) {
+      return (false);
+    }
+
+    // most strings have no escapes, copy them in one go
+    const char* escape(static_cast<const char*>(std::memchr(p_, '\\', quote - p_)));
+
+    if (NULL == escape) {
+      out.append(p_, quote);
+      p_ = quote + 1;
+      return (true);
+    }
+
+    out.append(p_, escape);
+    p_ = escape + 1;
+
+    if (!readEscape(out)) {
+      return (false);
+    }
+  }
+}
+
+
+bool JsonResponseParser::Reader::readEscape(std::string& out) {
+  if (p_ == end_) {
+    return (false);
+  }
+
+  char c(*p_++);
+
+  switch (c) {
+  case '"':
+  case '\\':
+  case '/':
+    out += c;
+    return (true);
+  case 'b':
+    out += '\b';
+    return (true);
+  case 'f':
+    out += '\f';
+    return (true);
+  case 'n':
+    out += '\n';
+    return (true);
+  case 'r':
+    out += '\r';
+    return (true);
+  case 't':
+    out += '\t';
+    return (true);
+  case 'u':
+    break;
+  default:
+    return (false);
+  }
+
+  unsigned long code(0);
+
+  if (!readHex(code)) {
+    return (false);
+  }
+
+  // combine surrogate pair
+  if (code >= 0xD800 && code < 0xDC00
+      && end_ - p_ >= 6 && '\\' == p_[0] && 'u' == p_[1]) {
+    const char* pairBegin(p_);
+    unsigned long low(0);
+
+    p_ += 2;
+
+    if (readHex(low) && low >= 0xDC00 && low < 0xE000) {
+      code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    } else {
+      p_ = pairBegin;
+    }
+  }
+
+  appendUtf8(out, code);
+  return (true);
+}
+
+
+bool JsonResponseParser::Reader::readHex(unsigned long& code) {
+  if (end_ - p_ < 4) {
+    return (false);
+  }
+
+  code = 0;
+
+  for (int n = 0; n < 4; ++n) {
+    char c(*p_++);
+    code <<= 4;
+
+    if (c >= '0' && c <= '9') {
+      code |= c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      code |= c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      code |= c - 'A' + 10;
+    } else {
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+bool JsonResponseParser::Reader::readScalar(std::string& out) {
+  if (!skipSpace()) {
+    return (false);
+  }
+
+  if ('"' == *p_) {
+    return (readString(out));
+  }
+
+  // number, true, false or null kept as text
+  const char* begin(p_);
+
+  while (p_ < end_ && !isDelimiter(*p_)) {
+    ++p_;
+  }
+
+  if (p_ == begin) {
+    return (false);
+  }
+
+  if (4 == p_ - begin && 0 == std::memcmp(begin, "null", 4)) {
+    out.clear();
+  } else {
+    out.assign(begin, p_);
+  }
+
+  return (true);
+}
+
+
+bool JsonResponseParser::Reader::skipValue() {
+  int depth(0);
+
+  do {
+    if (!skipSpace()) {
+      return (false);
+    }
+
+    switch (*p_) {
+    case '"':
+      if (!readString(skipped_)) {
+        return (false);
+      }
+      break;
+    case '{':
+    case '[':
+      ++depth;
+      ++p_;
+      break;
+    case '}':
+    case ']':
+      --depth;
+      ++p_;
+      break;
+    default:
+      ++p_;
+    }
+  } while (depth > 0);
+
+  return (true);
+}
+
+
+bool JsonResponseParser::Reader::readEntities(const std::string& entityName, ApiResponse& response) {
+  if (!expect('[') || !skipSpace()) {
+    return (false);
+  }
+
+  if (']' == *p_) {
+    ++p_;
+    return (true);
+  }
+
+  while (true) {
+    if (!skipSpace()) {
+      return (false);
+    }
+
+    bool good(true);
+
+    if ('{' == *p_) {
+      ApiEntity& entity(response.appendEntity());
+      entity.name = entityName;
+      good = readEntity(entity);
+
+    } else if ('[' == *p_) {
+      good = skipValue();
+
+    } else {
+      ApiEntity& entity(response.appendEntity());
+      entity.name = entityName;
+      good = readScalar(entity.value);
+    }
+
+    if (!good || !skipSpace()) {
+      return (false);
+    }
+
+    char c(*p_++);
+
+    if (']' == c) {
+      return (true);
+    }
+
+    if (',' != c) {
+      return (false);
+    }
+  }
+}
+
+
+bool JsonResponseParser::Reader::readEntity(ApiEntity& entity) {
+  if (!expect('{') || !skipSpace()) {
+    return (false);
+  }
+
+  if ('}' == *p_) {
+    ++p_;
+    return (true);
+  }
+
+  while (true) {
+    if (!readString(key_) || !expect(':') || !skipSpace()) {
+      return (false);
+    }
+
+    bool good(true);
+
+    if ('{' == *p_ || '[' == *p_) {
+      good = skipValue();
+    } else {
+      good = readScalar(entity.attributes[key_]);
+    }
+
+    if (!good || !skipSpace()) {
+      return (false);
+    }
+
+    char c(*p_++);
+
+    if ('}' == c) {
+      return (true);
+    }
+
+    if (',' != c) {
+      return (false);
+    }
+  }
+}
+
+//______________________________________________________________________________
+
+const std::size_t JsonResponseParser::READ_CHUNK_SIZE(64 * 1024);
+
+
+JsonResponseParser::JsonResponseParser() {
+}
+
+JsonResponseParser::~JsonResponseParser() {
+}
+
+JsonResponseParser& JsonResponseParser::getInstance() {
+  static JsonResponseParser instance;
+
+  return (instance);
+}
+
+
+bool JsonResponseParser::accepts(const std::string& contentType) const {
+  return (std::string::npos != contentType.find("json"));
+}
+
+
+bool JsonResponseParser::parse(std::istream& json, ApiResponse& response) {
+  std::string content;
+  std::vector<char> buf(READ_CHUNK_SIZE);
+
+  while (json.read(&buf[0], buf.size()) || json.gcount() > 0) {
+    content.append(&buf[0], static_cast<std::size_t>(json.gcount()));
+  }
+
+  return (parseInPlace(&content[0], content.size(), response));
+}
+
+
+bool JsonResponseParser::parseInPlace(char* json, std::size_t size, ApiResponse& response) {
+  Reader reader(json, json + size);
+
+  return (reader.readResponse(response));
+}
+
+
+std::string JsonResponseParser::getEntityName(const std::string& arrayName) {
+  std::string name(arrayName);
+  std::size_t size(name.size());
+
+  // categories -> category, seriess -> series, observations -> observation
+
+  if (size > 3 && 0 == name.compare(size - 3, 3, "ies")) {
+    name.replace(size - 3, 3, "y");
+
+  } else if (size > 1 && 's' == name[size - 1]) {
+    name.erase(size - 1);
+  }
+
+  return (name);
+}
+
+
+} // namespace external
+} // namespace fredcpp
@@ -26,11 +26,189 @@
 
 #include <fredcpp/ApiResponse.h>
 
+#include <fredcpp/internal/utils.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 
 namespace fredcpp {
 namespace external {
 
-PugiXmlParser::PugiXmlParser() {
+namespace {
+
+/// Parse context of a thread: the document and the buffer reused by
+/// the next parse of the same thread.
+
+struct ParseContext {
+  pugi::xml_document doc;
+  std::vector<char> buffer;
+
+  pugi::xml_parse_result parseResult;
+  PugiXmlParser::ParseStats lastStats;
+};
+
+
+ParseContext& getParseContext() {
+  thread_local ParseContext context;
+  return (context);
+}
+
+
+/// Cache of `pugixml` memory pages, kept for reuse by the next documents
+/// up to the high-water mark.
+///
+/// Blocks are allocated with the allocation function in place at install
+/// time; blocks allocated before the install are forwarded to the former
+/// deallocation function.
+
+class PagePool {
+public:
+  PagePool()
+    : allocate_(pugi::get_memory_allocation_function())
+    , deallocate_(pugi::get_memory_deallocation_function())
+    , highWaterMark_(0)
+    , pooledBytes_(0) {
+  }
+
+  void* allocate(std::size_t size) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      FreeBlocks::iterator it(free_.find(size));
+
+      if (it != free_.end() && !it->second.empty()) {
+        void* block(it->second.back());
+        it->second.pop_back();
+        pooledBytes_ -= size;
+        return (block);
+      }
+    }
+
+    void* block(allocate_(size));
+
+    if (NULL != block) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      owned_[block] = size;
+    }
+
+    return (block);
+  }
+
+  void deallocate(void* block) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      OwnedBlocks::iterator it(owned_.find(block));
+
+      if (it != owned_.end()) {
+        std::size_t size(it->second);
+
+        if (pooledBytes_ + size <= highWaterMark_) {
+          free_[size].push_back(block);
+          pooledBytes_ += size;
+          return;
+        }
+
+        owned_.erase(it);
+      }
+    }
+
+    deallocate_(block);
+  }
+
+  void setHighWaterMark(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    highWaterMark_ = bytes;
+    trim();
+  }
+
+  std::size_t getPooledBytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (pooledBytes_);
+  }
+
+  void release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::size_t highWaterMark(highWaterMark_);
+    highWaterMark_ = 0;
+    trim();
+    highWaterMark_ = highWaterMark;
+  }
+
+private:
+  typedef std::unordered_map<void*, std::size_t> OwnedBlocks;
+  typedef std::map<std::size_t, std::vector<void*> > FreeBlocks;
+
+  // frees pooled blocks over the high-water mark, called under the lock
+  void trim() {
+    for (FreeBlocks::iterator it = free_.begin();
+         it != free_.end() && pooledBytes_ > highWaterMark_;
+         ++it) {
+      while (!it->second.empty() && pooledBytes_ > highWaterMark_) {
+        void* block(it->second.back());
+        it->second.pop_back();
+        owned_.erase(block);
+        pooledBytes_ -= it->first;
+        deallocate_(block);
+      }
+    }
+  }
+
+  pugi::allocation_function allocate_;
+  pugi::deallocation_function deallocate_;
+
+  OwnedBlocks owned_;
+  FreeBlocks free_;
+  std::size_t highWaterMark_;
+  std::size_t pooledBytes_;
+  std::mutex mutex_;
+};
+
+
+// never destroyed: documents may still be freed during static destruction
+std::atomic<PagePool*> pagePool(NULL);
+std::once_flag pagePoolFlag;
+
+
+void* allocatePage(std::size_t size) {
+  return (pagePool.load()->allocate(size));
+}
+
+void deallocatePage(void* block) {
+  pagePool.load()->deallocate(block);
+}
+
+void createPagePool(std::size_t highWaterMark) {
+  PagePool* pool(new PagePool());
+  pool->setHighWaterMark(highWaterMark);
+  pagePool.store(pool);
+
+  pugi::set_memory_management_functions(allocatePage, deallocatePage);
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+const std::size_t PugiXmlParser::DEFAULT_MEMORY_HIGH_WATER_MARK(4 * 1024 * 1024);
+
+
+PugiXmlParser::ParseStats::ParseStats()
+  : parses(0)
+  , bytesParsed(0)
+  , parseMicros(0) {
+}
+
+//______________________________________________________________________________
+
+PugiXmlParser::PugiXmlParser()
+  : highWaterMark_(DEFAULT_MEMORY_HIGH_WATER_MARK) {
 }
 
 PugiXmlParser::~PugiXmlParser() {
@@ -42,19 +220,118 @@ PugiXmlParser& PugiXmlParser::getInstance() {
   return (instance);
 }
 
+void PugiXmlParser::installMemoryPool() {
+  std::call_once(pagePoolFlag, createPagePool, getInstance().getMemoryHighWaterMark());
+}
+
+PugiXmlParser& PugiXmlParser::withMemoryHighWaterMark(std::size_t bytes) {
+  highWaterMark_.store(bytes);
+
+  PagePool* pool(pagePool.load());
+
+  if (NULL != pool) {
+    pool->setHighWaterMark(bytes);
+  }
+
+  ParseContext& context(getParseContext());
+
+  if (context.buffer.capacity() > bytes) {
+    std::vector<char>().swap(context.buffer);
+  }
+
+  return (*this);
+}
+
+std::size_t PugiXmlParser::getMemoryHighWaterMark() const {
+  return (highWaterMark_.load());
+}
+
+std::size_t PugiXmlParser::getPooledMemory() const {
+  std::size_t pooled(getParseContext().buffer.capacity());
+
+  PagePool* pool(pagePool.load());
+
+  if (NULL != pool) {
+    pooled += pool->getPooledBytes();
+  }
+
+  return (pooled);
+}
+
+void PugiXmlParser::releaseMemory() {
+  ParseContext& context(getParseContext());
+
+  context.doc.reset();
+  std::vector<char>().swap(context.buffer);
+
+  PagePool* pool(pagePool.load());
+
+  if (NULL != pool) {
+    pool->release();
+  }
+}
+
 bool PugiXmlParser::parse(std::istream& xml, ApiResponse& response) {
+  // read into the reusable buffer, then parse it in place
+
+  std::vector<char>& buffer(getParseContext().buffer);
+
+  buffer.clear();
+
+  char chunk[8192];
+  while (xml.read(chunk, sizeof(chunk)) || xml.gcount() > 0) {
+    buffer.insert(buffer.end(), chunk, chunk + xml.gcount());
+  }
+
+  char empty('\0');
+  bool result(parseDocument((buffer.empty() ? &empty : &buffer[0]), buffer.size(), response));
+
+  if (buffer.capacity() > getMemoryHighWaterMark()) {
+    std::vector<char>().swap(buffer);
+  }
+
+  return (result);
+}
+
+bool PugiXmlParser::parseInPlace(char* xml, std::size_t size, ApiResponse& response) {
+  return (parseDocument(xml, size, response));
+}
+
+bool PugiXmlParser::parseDocument(char* xml, std::size_t size, ApiResponse& response) {
   bool result(false);
 
-  pugi::xml_document doc;
+  unsigned long long startMicros(internal::monotonicMicros());
 
-  parseResult_ = doc.load(xml);
+  ParseContext& context(getParseContext());
 
-  //check error
-  if (!parseResult_) {
-    // error
-    return (result);
+  context.parseResult = context.doc.load_buffer_inplace(xml, size);
+
+  if (context.parseResult) {
+    result = readDocument(context.doc, response);
   }
 
+  // the document refers to the buffer, release it; its pages go back to
+  // the page pool when installed
+  context.doc.reset();
+
+  ParseStats& lastStats(context.lastStats);
+
+  lastStats.parses = 1;
+  lastStats.bytesParsed = size;
+  lastStats.parseMicros = internal::monotonicMicros() - startMicros;
+
+  std::lock_guard<std::mutex> lock(statsMutex_);
+
+  totalStats_.parses += lastStats.parses;
+  totalStats_.bytesParsed += lastStats.bytesParsed;
+  totalStats_.parseMicros += lastStats.parseMicros;
+
+  return (result);
+}
+
+bool PugiXmlParser::readDocument(const pugi::xml_document& doc, ApiResponse& response) {
+  bool result(false);
+
   pugi::xml_node resultNode = doc.first_child();  // should be only one result container
 
   //TODO:check if valid resultNode
@@ -72,14 +349,12 @@ bool PugiXmlParser::parse(std::istream& xml, ApiResponse& response) {
 
   pugi::xml_node_iterator it;
 
-  ApiEntity entity;
-
-  // get entities
+  // get entities, filling recycled entities in place
   for ( it = resultNode.begin();
         it != resultNode.end();
         ++it) {
 
-    entity.clear();
+    ApiEntity& entity(response.appendEntity());
 
     // get node and it's first data
     entity.name = it->name();
@@ -91,8 +366,6 @@ bool PugiXmlParser::parse(std::istream& xml, ApiResponse& response) {
          ++ait) {
       entity.attributes[ait->name()] = ait->value();
     }
-
-    response.entities.push_back(entity);
   }
 
   result = true;
@@ -101,7 +374,23 @@ bool PugiXmlParser::parse(std::istream& xml, ApiResponse& response) {
 }
 
 pugi::xml_parse_result PugiXmlParser::getParseResult() const {
-  return (parseResult_);
+  return (getParseContext().parseResult);
+}
+
+const PugiXmlParser::ParseStats& PugiXmlParser::getLastParseStats() const {
+  return (getParseContext().lastStats);
+}
+
+PugiXmlParser::ParseStats PugiXmlParser::getTotalParseStats() const {
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  return (totalStats_);
+}
+
+void PugiXmlParser::resetParseStats() {
+  getParseContext().lastStats = ParseStats();
+
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  totalStats_ = ParseStats();
 }
 
 
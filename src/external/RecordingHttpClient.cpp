@@ -0,0 +1,191 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/external/RecordingHttpClient.h>
+
+#include <fredcpp/ApiLog.h>
+
+#include <fredcpp/internal/HttpRequest.h>
+#include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/ReplayArchive.h>
+
+
+namespace fredcpp {
+namespace external {
+
+namespace {
+
+void makeRecord(const internal::HttpRequest& request, const internal::HttpResponse& response,
+                internal::ReplayRecord& record) {
+  record.key = internal::ReplayArchive::makeKey(request);
+  record.httpStatus = response.getHttpStatus();
+  record.contentType = response.getContentType();
+  record.headers = response.getHeaders();
+  record.content = response.getContent();
+}
+
+
+bool isRecordable(const internal::HttpResponse& response) {
+  return (internal::HttpResponse::HTTP_UNKNOWN != response.getHttpStatus());
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+/// Records responses of the batch before passing them on.
+
+class RecordingHttpClient::BatchHandler : public internal::HttpResponseHandler {
+public:
+  BatchHandler(RecordingHttpClient& recorder, internal::HttpResponseHandler& handler)
+    : recorder_(recorder)
+    , handler_(handler) {
+  }
+
+  void onResponse(std::size_t index, const internal::HttpRequest& request, internal::HttpResponse& response) {
+    if (isRecordable(response)) {
+      makeRecord(request, response, record_);
+      recorder_.writeRecord(record_);
+    }
+
+    handler_.onResponse(index, request, response);
+  }
+
+
+private:
+  RecordingHttpClient& recorder_;
+  internal::HttpResponseHandler& handler_;
+  internal::ReplayRecord record_;
+};
+
+//______________________________________________________________________________
+
+RecordingHttpClient::RecordingHttpClient(internal::HttpRequestExecutor& executor, const std::string& archivePath)
+  : executor_(executor)
+  , archivePath_(archivePath)
+  , recordCount_(0) {
+
+  archive_.open(archivePath_.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+
+  if (!archive_) {
+    FREDCPP_LOG_WARN("REPLAY:Failed to open archive for recording:" << archivePath_);
+    return;
+  }
+
+  // a new archive starts with the signature
+  archive_.seekp(0, std::ios::end);
+  if (0 == archive_.tellp()) {
+    internal::ReplayArchive::writeSignature(archive_);
+    archive_.flush();
+  }
+}
+
+
+RecordingHttpClient::~RecordingHttpClient() {
+}
+
+
+bool RecordingHttpClient::good() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (archive_.is_open() && archive_.good());
+}
+
+
+bool RecordingHttpClient::execute(const internal::HttpRequest& request, internal::HttpResponse& response) {
+  internal::HttpResponse fetched;
+  executor_.execute(request, fetched);
+
+  return (record(request, fetched, response));
+}
+
+
+bool RecordingHttpClient::executeBatch(const internal::HttpRequestVector& requests, internal::HttpResponseHandler& handler, internal::RateLimiter* rateLimiter) {
+  BatchHandler recordingHandler(*this, handler);
+
+  return (executor_.executeBatch(requests, recordingHandler, rateLimiter));
+}
+
+
+std::string RecordingHttpClient::encodeURI(const std::string& URI) {
+  return (executor_.encodeURI(URI));
+}
+
+
+const std::string& RecordingHttpClient::getArchivePath() const {
+  return (archivePath_);
+}
+
+
+unsigned long RecordingHttpClient::getRecordCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (recordCount_);
+}
+
+
+bool RecordingHttpClient::record(const internal::HttpRequest& request, const internal::HttpResponse& fetched,
+                                 internal::HttpResponse& response) {
+  internal::ReplayRecord record;
+
+  if (isRecordable(fetched)) {
+    makeRecord(request, fetched, record);
+    writeRecord(record);
+  }
+
+  // pass on the buffered response, also to the content sink if set
+  response.clear();
+  response.setHttpStatus(fetched.getHttpStatus());
+  response.setContentType(fetched.getContentType());
+  response.setTransferBytes(fetched.getTransferBytes());
+
+  for (internal::KeyValueMap::const_iterator it = fetched.getHeaders().begin();
+       it != fetched.getHeaders().end();
+       ++it) {
+    response.setHeader(it->first, it->second);
+  }
+
+  response.appendContent(fetched.getContent().data(), fetched.getContent().size());
+
+  return (internal::HttpResponse::HTTP_OK == response.getHttpStatus());
+}
+
+
+void RecordingHttpClient::writeRecord(const internal::ReplayRecord& record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!archive_.is_open()) {
+    return;
+  }
+
+  if (!internal::ReplayArchive::writeRecord(archive_, record) || !archive_.flush()) {
+    FREDCPP_LOG_WARN("REPLAY:Failed to record response:" << record.key);
+    return;
+  }
+
+  FREDCPP_LOG_DEBUG("REPLAY:recorded:" << record.key);
+  ++recordCount_;
+}
+
+
+} // namespace external
+} // namespace fredcpp
@@ -0,0 +1,295 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/external/ReplayHttpClient.h>
+
+#include <fredcpp/ApiLog.h>
+
+#include <fredcpp/internal/HttpRequest.h>
+#include <fredcpp/internal/utils.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+
+namespace fredcpp {
+namespace external {
+
+//______________________________________________________________________________
+
+ReplayHttpClient::ReplayStats::ReplayStats()
+  : replayed(0)
+  , misses(0)
+  , injectedErrors(0)
+  , injectedFailures(0) {
+}
+
+//______________________________________________________________________________
+
+ReplayHttpClient::ReplayHttpClient()
+  : minLatencyMillis_(0)
+  , maxLatencyMillis_(0)
+  , failureRate_(0) {
+}
+
+
+ReplayHttpClient::ReplayHttpClient(const std::string& archivePath)
+  : minLatencyMillis_(0)
+  , maxLatencyMillis_(0)
+  , failureRate_(0) {
+  load(archivePath);
+}
+
+
+ReplayHttpClient::~ReplayHttpClient() {
+}
+
+
+bool ReplayHttpClient::load(const std::string& archivePath) {
+  std::ifstream ifs(archivePath.c_str(), std::ios::in | std::ios::binary);
+
+  if (!ifs || !internal::ReplayArchive::readSignature(ifs)) {
+    FREDCPP_LOG_WARN("REPLAY:Failed to read archive:" << archivePath);
+    return (false);
+  }
+
+  internal::ReplayRecord record;
+  std::size_t count(0);
+
+  while (std::ifstream::traits_type::eof() != ifs.peek()) {
+    if (!internal::ReplayArchive::readRecord(ifs, record)) {
+      FREDCPP_LOG_WARN("REPLAY:Malformed archive:" << archivePath << " after records:" << count);
+      return (false);
+    }
+
+    add(record);
+    ++count;
+  }
+
+  FREDCPP_LOG_DEBUG("REPLAY:loaded records:" << count << " from:" << archivePath);
+
+  return (true);
+}
+
+
+void ReplayHttpClient::add(const internal::ReplayRecord& record) {
+  records_[record.key] = record;
+}
+
+
+void ReplayHttpClient::clear() {
+  records_.clear();
+}
+
+
+std::size_t ReplayHttpClient::size() const {
+  return (records_.size());
+}
+
+
+ReplayHttpClient& ReplayHttpClient::withLatency(unsigned long minMillis, unsigned long maxMillis) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  minLatencyMillis_ = minMillis;
+  maxLatencyMillis_ = (maxMillis < minMillis ? minMillis : maxMillis);
+
+  return (*this);
+}
+
+
+ReplayHttpClient& ReplayHttpClient::withErrorRate(double rate, internal::HttpResponse::HttpStatus status) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  errorRates_.push_back(std::make_pair(rate, status));
+  return (*this);
+}
+
+
+ReplayHttpClient& ReplayHttpClient::withFailureRate(double rate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  failureRate_ = rate;
+  return (*this);
+}
+
+
+ReplayHttpClient& ReplayHttpClient::withSeed(unsigned long seed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  random_.seed(static_cast<std::mt19937::result_type>(seed));
+  return (*this);
+}
+
+
+ReplayHttpClient& ReplayHttpClient::withoutFaults() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  minLatencyMillis_ = 0;
+  maxLatencyMillis_ = 0;
+  failureRate_ = 0;
+  errorRates_.clear();
+
+  return (*this);
+}
+
+
+bool ReplayHttpClient::execute(const internal::HttpRequest& request, internal::HttpResponse& response) {
+  response.clear();
+
+  internal::HttpResponse::HttpStatus errorStatus(internal::HttpResponse::HTTP_UNKNOWN);
+  unsigned long latencyMillis(0);
+
+  Fault fault(drawFault(errorStatus, latencyMillis));
+
+  if (latencyMillis) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(latencyMillis));
+  }
+
+  std::string key(internal::ReplayArchive::makeKey(request));
+
+  if (FAULT_FAILURE == fault) {
+    FREDCPP_LOG_DEBUG("REPLAY:injected failure:" << key);
+    return (false);
+  }
+
+  if (FAULT_ERROR == fault) {
+    FREDCPP_LOG_DEBUG("REPLAY:injected error:" << errorStatus << " " << key);
+    fillError(errorStatus, response);
+    return (false);
+  }
+
+  RecordMap::const_iterator itFound(records_.find(key));
+
+  if (itFound == records_.end()) {
+    FREDCPP_LOG_WARN("REPLAY:No record of request:" << key);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++replayStats_.misses;
+    }
+
+    response.setHttpStatus(internal::HttpResponse::HTTP_NOT_FOUND);
+    return (false);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++replayStats_.replayed;
+  }
+
+  const internal::ReplayRecord& record(itFound->second);
+
+  response.setHttpStatus(record.httpStatus);
+  response.setContentType(record.contentType);
+
+  for (internal::KeyValueMap::const_iterator it = record.headers.begin();
+       it != record.headers.end();
+       ++it) {
+    response.setHeader(it->first, it->second);
+  }
+
+  response.appendContent(record.content.data(), record.content.size());
+
+  return (internal::HttpResponse::HTTP_OK == response.getHttpStatus());
+}
+
+
+std::string ReplayHttpClient::encodeURI(const std::string& URI) {
+  return (internal::percentEncode(URI));
+}
+
+
+void ReplayHttpClient::appendEncodedURI(std::string& buf, const std::string& URI) {
+  internal::appendPercentEncoded(buf, URI);
+}
+
+
+ReplayHttpClient::ReplayStats ReplayHttpClient::getReplayStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (replayStats_);
+}
+
+
+void ReplayHttpClient::resetReplayStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  replayStats_ = ReplayStats();
+}
+
+
+ReplayHttpClient::Fault ReplayHttpClient::drawFault(internal::HttpResponse::HttpStatus& errorStatus,
+                                                    unsigned long& latencyMillis) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  latencyMillis = minLatencyMillis_;
+  if (maxLatencyMillis_ > minLatencyMillis_) {
+    latencyMillis = std::uniform_int_distribution<unsigned long>(minLatencyMillis_, maxLatencyMillis_)(random_);
+  }
+
+  if (0 == failureRate_ && errorRates_.empty()) {
+    return (FAULT_NONE);
+  }
+
+  double draw(std::uniform_real_distribution<double>(0, 1)(random_));
+
+  if (draw < failureRate_) {
+    ++replayStats_.injectedFailures;
+    return (FAULT_FAILURE);
+  }
+
+  double bound(failureRate_);
+
+  for (ErrorRateVector::const_iterator it = errorRates_.begin(); it != errorRates_.end(); ++it) {
+    bound += it->first;
+
+    if (draw < bound) {
+      errorStatus = it->second;
+      ++replayStats_.injectedErrors;
+      return (FAULT_ERROR);
+    }
+  }
+
+  return (FAULT_NONE);
+}
+
+
+void ReplayHttpClient::fillError(internal::HttpResponse::HttpStatus status, internal::HttpResponse& response) {
+  // error in the form returned by FRED API
+
+  std::ostringstream buf;
+  buf << "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
+      << "<error code=\"" << static_cast<int>(status)
+      << "\" message=\"Injected error of ReplayHttpClient.\"/>\n";
+
+  std::string content(buf.str());
+
+  response.setHttpStatus(status);
+  response.setContentType("text/xml; charset=UTF-8");
+  response.appendContent(content.data(), content.size());
+}
+
+
+} // namespace external
+} // namespace fredcpp
@@ -24,7 +24,9 @@
 
 #include <fredcpp/external/SimpleLogger.h>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 
 #include <sstream>
 #include <string>
@@ -35,7 +37,8 @@ namespace external {
 
 LogChannel::LogChannel(internal::LogLevel::Level level, std::ostream& os)
   : osPtr_(&os)
-  , level_(level) {
+  , level_(level)
+  , enabled_(false) {
   enable();
 }
 
@@ -48,17 +51,27 @@ void LogChannel::writeLine(const std::string& str) {
 }
 
 
+void LogChannel::write(const std::string& lines) {
+  if (enabled_) {
+    (*osPtr_) << lines;
+  }
+}
+
+
+void LogChannel::flush() {
+  if (enabled_) {
+    osPtr_->flush();
+  }
+}
+
+
 bool LogChannel::enable() {
-  bool wasEnabled(enabled_);
-  enabled_ = ( !isNull() );
-  return (wasEnabled);
+  return (enabled_.exchange( !isNull() ));
 }
 
 
 bool LogChannel::disable() {
-  bool wasEnabled(enabled_);
-  enabled_ = false;
-  return (wasEnabled);
+  return (enabled_.exchange(false));
 }
 
 
@@ -149,7 +162,30 @@ bool LogFile::open(std::ios_base::openmode mode) {
 
 //______________________________________________________________________________
 
-SimpleLogger::SimpleLogger() {
+const std::size_t SimpleLogger::DEFAULT_ASYNC_CAPACITY = 8192;
+const unsigned SimpleLogger::DEFAULT_SAMPLING_RATE = 100;
+const std::size_t SimpleLogger::MAX_BATCH_SIZE = 256;
+const unsigned SimpleLogger::WRITER_IDLE_WAIT_MILLIS = 10;
+const std::size_t SimpleLogger::WRITER_WAKE_DEPTH = 64;
+
+
+SimpleLogger::AsyncStats::AsyncStats()
+  : queued(0)
+  , written(0)
+  , dropped(0) {
+}
+
+
+SimpleLogger::SimpleLogger()
+  : async_(false)
+  , stopping_(false)
+  , writerIdle_(false)
+  , overflowPolicy_(OVERFLOW_DROP)
+  , samplingRate_(DEFAULT_SAMPLING_RATE)
+  , wakeDepth_(1)
+  , writtenCount_(0)
+  , droppedCount_(0)
+  , overflowCount_(0) {
   setupChannel(internal::LogLevel::LOG_INFO);
   setupChannel(internal::LogLevel::LOG_WARN);
   setupChannel(internal::LogLevel::LOG_ERROR);
@@ -178,6 +214,7 @@ SimpleLogger::SimpleLogger() {
 
 
 SimpleLogger::~SimpleLogger() {
+  stopAsync();
 }
 
 
@@ -194,14 +231,23 @@ void SimpleLogger::logMessage(internal::LogLevel::Level level, const std::string
     return;
   }
 
-  std::ostringstream buf;
-  formatMessage(buf, channel.getLevel(), message, context);
+  internal::LogMessage buf;
+  formatMessage(buf.stream(), channel.getLevel(), message, context);
+
+  if (async_.load(std::memory_order_acquire)) {
+    enqueue(channel.getLevel(), buf.str());
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(outputMutex_);
 
   channel.writeLine(buf.str());
 }
 
 
 void SimpleLogger::setOutput(internal::LogLevel::Level level, std::ostream& os) {
+  std::lock_guard<std::recursive_mutex> lock(outputMutex_);
+
   LogChannel& channel = useChannel(level);
   LogFile& file = useFile(level);
 
@@ -217,6 +263,8 @@ void SimpleLogger::setOutput(internal::LogLevel::Level level, const std::string&
   // First check if path has already been opened and then use its stream
   // otherwise open new file
 
+  std::lock_guard<std::recursive_mutex> lock(outputMutex_);
+
   LogFile* foundFilePtr = findFile(path);
 
   if (foundFilePtr) {
@@ -239,6 +287,8 @@ void SimpleLogger::setOutput(internal::LogLevel::Level level, const std::string&
 void SimpleLogger::setOutput(std::ostream& os) {
   // Set all enabled channels to write to the same stream
 
+  std::lock_guard<std::recursive_mutex> lock(outputMutex_);
+
   std::size_t numChannels = sizeof(channels_) / sizeof(channels_[0]);
 
   for (std::size_t n = 0; n < numChannels; ++n) {
@@ -256,6 +306,8 @@ void SimpleLogger::setOutput(const std::string& path) {
   // first set LOG_INFO channel to the path,
   // then use its file stream to set the others
 
+  std::lock_guard<std::recursive_mutex> lock(outputMutex_);
+
   LogChannel& infoChannel = useChannel(internal::LogLevel::LOG_INFO);
   setOutput(internal::LogLevel::LOG_INFO, path);
 
@@ -279,6 +331,193 @@ void SimpleLogger::setFormatter(SimpleLogger::LogFormatter formatter) {
 }
 
 
+void SimpleLogger::startAsync(std::size_t capacity, OverflowPolicy policy, unsigned samplingRate) {
+  stopAsync();
+
+  overflowPolicy_ = policy;
+  samplingRate_ = std::max(samplingRate, 1U);
+
+  ring_.reset(new internal::LogRing(capacity));
+  wakeDepth_ = std::min(WRITER_WAKE_DEPTH, ring_->capacity() / 2);
+  writtenCount_.store(0);
+  droppedCount_.store(0);
+  overflowCount_.store(0);
+  stopping_.store(false);
+  writerIdle_.store(false);
+
+  writer_ = std::thread(&SimpleLogger::runWriter, this);
+  async_.store(true, std::memory_order_release);
+}
+
+
+void SimpleLogger::stopAsync() {
+  if (!writer_.joinable()) {
+    return;
+  }
+
+  async_.store(false, std::memory_order_release);
+
+  {
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+    stopping_.store(true);
+  }
+  writerWake_.notify_one();
+
+  // writer drains the queue before exiting
+  writer_.join();
+}
+
+
+bool SimpleLogger::isAsync() const {
+  return (async_.load(std::memory_order_acquire));
+}
+
+
+void SimpleLogger::flush() {
+  if (!isAsync()) {
+    return;
+  }
+
+  unsigned long long queued(ring_->getPushCount());
+
+  wakeWriter();
+
+  std::unique_lock<std::mutex> lock(asyncMutex_);
+
+  while (writtenCount_.load() < queued && !stopping_.load()) {
+    batchWritten_.wait_for(lock, std::chrono::milliseconds(WRITER_IDLE_WAIT_MILLIS));
+  }
+}
+
+
+SimpleLogger::AsyncStats SimpleLogger::getAsyncStats() const {
+  AsyncStats stats;
+
+  if (ring_) {
+    stats.queued = ring_->getPushCount();
+    stats.written = writtenCount_.load();
+    stats.dropped = droppedCount_.load();
+  }
+
+  return (stats);
+}
+
+
+void SimpleLogger::enqueue(internal::LogLevel::Level level, const std::string& line) {
+  if (!ring_->tryPush(level, line)) {
+    // SAMPLE keeps the first of each samplingRate_ overflowing messages
+    if (OVERFLOW_DROP == overflowPolicy_
+        || (OVERFLOW_SAMPLE == overflowPolicy_
+            && 0 != overflowCount_.fetch_add(1, std::memory_order_relaxed) % samplingRate_)) {
+      droppedCount_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    waitForRoom(level, line);
+  }
+
+  // an idle writer is woken once enough messages are queued, otherwise it
+  // picks them up on its idle timeout
+  if (writerIdle_.load()
+      && ring_->getPushCount() - writtenCount_.load() >= wakeDepth_) {
+    wakeWriter();
+  }
+}
+
+
+void SimpleLogger::waitForRoom(internal::LogLevel::Level level, const std::string& line) {
+  std::unique_lock<std::mutex> lock(asyncMutex_);
+
+  while (!ring_->tryPush(level, line)) {
+    writerWake_.notify_one();
+    batchWritten_.wait_for(lock, std::chrono::milliseconds(1));
+  }
+}
+
+
+void SimpleLogger::wakeWriter() {
+  {
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+  }
+  writerWake_.notify_one();
+}
+
+
+void SimpleLogger::runWriter() {
+  internal::LogRecord record;
+  std::string lines;
+  unsigned long long written(0);
+
+  for (;;) {
+    std::size_t count(writeBatch(record, lines));
+
+    if (count) {
+      written += count;
+
+      {
+        std::lock_guard<std::mutex> lock(asyncMutex_);
+        writtenCount_.store(written);
+      }
+      batchWritten_.notify_all();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(asyncMutex_);
+
+    if (stopping_.load() && ring_->getPushCount() == written) {
+      break;
+    }
+
+    // the timeout is a safety net against a missed wake-up
+    writerIdle_.store(true);
+    writerWake_.wait_for(lock, std::chrono::milliseconds(WRITER_IDLE_WAIT_MILLIS));
+    writerIdle_.store(false);
+  }
+}
+
+
+std::size_t SimpleLogger::writeBatch(internal::LogRecord& record, std::string& lines) {
+  // Consecutive records of the same channel are written with a single call,
+  // the used channels are flushed once at the end of the batch.
+
+  std::size_t count(0);
+  LogChannel* linesChannel(NULL);
+  LogChannel* usedChannels[sizeof(channels_) / sizeof(channels_[0])];
+  std::size_t numUsed(0);
+
+  std::lock_guard<std::recursive_mutex> lock(outputMutex_);
+
+  while (count < MAX_BATCH_SIZE && ring_->tryPop(record)) {
+    LogChannel& channel = useChannel(record.level);
+
+    if (&channel != linesChannel) {
+      if (linesChannel) {
+        linesChannel->write(lines);
+      }
+      lines.clear();
+      linesChannel = &channel;
+
+      if (usedChannels + numUsed == std::find(usedChannels, usedChannels + numUsed, &channel)) {
+        usedChannels[numUsed++] = &channel;
+      }
+    }
+
+    lines.append(record.line).append(1, '\n');
+    ++count;
+  }
+
+  if (linesChannel) {
+    linesChannel->write(lines);
+  }
+
+  for (std::size_t n = 0; n < numUsed; ++n) {
+    usedChannels[n]->flush();
+  }
+
+  return (count);
+}
+
+
 bool SimpleLogger::levelEnabled(internal::LogLevel::Level level) const {
   const LogChannel& channel = getChannel(level);
   return (channel.enabled());
@@ -287,13 +526,19 @@ bool SimpleLogger::levelEnabled(internal::LogLevel::Level level) const {
 
 bool SimpleLogger::enableLevel(internal::LogLevel::Level level) {
   LogChannel& channel = useChannel(level);
-  return (channel.enable());
+  bool result(channel.enable());
+
+  cacheLevelEnabled(level, channel.enabled());
+  return (result);
 }
 
 
 bool SimpleLogger::disableLevel(internal::LogLevel::Level level) {
   LogChannel& channel = useChannel(level);
-  return (channel.disable());
+  bool result(channel.disable());
+
+  cacheLevelEnabled(level, channel.enabled());
+  return (result);
 }
 
 
@@ -351,6 +596,8 @@ void SimpleLogger::setupChannel(internal::LogLevel::Level level) {
   LogChannel& channel(useChannel(level));
   channel.setLevel(level);
   channel.enable();
+
+  cacheLevelEnabled(level, channel.enabled());
 }
 
 
@@ -0,0 +1,560 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/external/StreamingXmlParser.h>
+
+#include <cstdlib>
+#include <cstring>
+
+
+namespace fredcpp {
+namespace external {
+
+namespace {
+
+bool isSpace(char c) {
+  return (' ' == c || '\t' == c || '\n' == c || '\r' == c);
+}
+
+
+bool isBlank(const std::string& str) {
+  for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+    if (!isSpace(*it)) {
+      return (false);
+    }
+  }
+  return (true);
+}
+
+
+bool startsWith(const std::string& str, const char* prefix) {
+  return (0 == str.compare(0, std::strlen(prefix), prefix));
+}
+
+
+bool endsWith(const std::string& str, const char* suffix) {
+  std::size_t len(std::strlen(suffix));
+  return (str.size() >= len && 0 == str.compare(str.size() - len, len, suffix));
+}
+
+
+void appendUtf8(std::string& out, unsigned long code) {
+  if (code < 0x80) {
+    out += static_cast<char>(code);
+
+  } else if (code < 0x800) {
+    out += static_cast<char>(0xC0 | (code >> 6));
+    out += static_cast<char>(0x80 | (code & 0x3F));
+
+  } else if (code < 0x10000) {
+    out += static_cast<char>(0xE0 | (code >> 12));
+    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code & 0x3F));
+
+  } else {
+    out += static_cast<char>(0xF0 | (code >> 18));
+    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code & 0x3F));
+  }
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+/// Incremental parsing state of a thread.
+
+class StreamingXmlParser::ParseContext {
+public:
+  ParseContext();
+
+  void beginParse(ApiResponse& response, ApiEntityHandler* handler);
+  bool parseChunk(const char* xml, std::size_t size);
+  bool endParse();
+
+private:
+  bool isMarkupComplete() const;
+  bool processMarkup();
+  bool processStartTag();
+  bool processEndTag(const std::string& name);
+  void flushText();
+
+  typedef enum {
+    STATE_TEXT,
+    STATE_MARKUP,
+  } State;
+
+  ApiResponse* response_;
+  ApiEntityHandler* handler_;
+
+  State state_;
+  char quote_;
+  bool failed_;
+  bool done_;
+
+  std::string markup_;
+  std::string pendingText_;
+  std::string text_;
+  std::vector<std::string> openElements_;
+
+  ApiEntity entity_;
+};
+
+//______________________________________________________________________________
+
+const std::size_t StreamingXmlParser::READ_CHUNK_SIZE(64 * 1024);
+
+
+StreamingXmlParser::StreamingXmlParser() {
+}
+
+StreamingXmlParser::~StreamingXmlParser() {
+}
+
+StreamingXmlParser& StreamingXmlParser::getInstance() {
+  static StreamingXmlParser instance;
+
+  return (instance);
+}
+
+
+bool StreamingXmlParser::parse(std::istream& xml, ApiResponse& response) {
+  beginParse(response, NULL);
+
+  std::vector<char> buf(READ_CHUNK_SIZE);
+
+  while (xml.read(&buf[0], buf.size()) || xml.gcount() > 0) {
+    if (!parseChunk(&buf[0], static_cast<std::size_t>(xml.gcount()))) {
+      break;
+    }
+  }
+
+  return (endParse());
+}
+
+
+bool StreamingXmlParser::parseInPlace(char* xml, std::size_t size, ApiResponse& response) {
+  beginParse(response, NULL);
+
+  parseChunk(xml, size);
+
+  return (endParse());
+}
+
+
+void StreamingXmlParser::beginParse(ApiResponse& response, ApiEntityHandler* handler) {
+  getContext().beginParse(response, handler);
+}
+
+
+bool StreamingXmlParser::parseChunk(const char* xml, std::size_t size) {
+  return (getContext().parseChunk(xml, size));
+}
+
+
+bool StreamingXmlParser::endParse() {
+  return (getContext().endParse());
+}
+
+
+StreamingXmlParser::ParseContext& StreamingXmlParser::getContext() {
+  thread_local ParseContext context;
+
+  return (context);
+}
+
+//______________________________________________________________________________
+
+StreamingXmlParser::ParseContext::ParseContext()
+  : response_(NULL)
+  , handler_(NULL)
+  , state_(STATE_TEXT)
+  , quote_('\0')
+  , failed_(false)
+  , done_(false) {
+}
+
+
+void StreamingXmlParser::ParseContext::beginParse(ApiResponse& response, ApiEntityHandler* handler) {
+  response_ = &response;
+  handler_ = handler;
+
+  state_ = STATE_TEXT;
+  quote_ = '\0';
+  failed_ = false;
+  done_ = false;
+
+  markup_.clear();
+  pendingText_.clear();
+  text_.clear();
+  openElements_.clear();
+  entity_.clear();
+}
+
+
+bool StreamingXmlParser::ParseContext::parseChunk(const char* xml, std::size_t size) {
+  if (failed_ || NULL == response_) {
+    return (false);
+  }
+
+  const char* p(xml);
+  const char* end(xml + size);
+
+  while (p < end) {
+
+    if (STATE_TEXT == state_) {
+      const char* lt(static_cast<const char*>(std::memchr(p, '<', end - p)));
+      const char* stop(NULL != lt ? lt : end);
+
+      // only text of entity elements is kept
+      if (2 == openElements_.size()) {
+        pendingText_.append(p, stop);
+      }
+
+      if (NULL == lt) {
+        break;
+      }
+
+      flushText();
+
+      state_ = STATE_MARKUP;
+      markup_.clear();
+      quote_ = '\0';
+      p = lt + 1;
+      continue;
+    }
+
+    // STATE_MARKUP: collect markup up to the closing '>', skipping quoted values
+
+    if ('\0' != quote_) {
+      const char* q(static_cast<const char*>(std::memchr(p, quote_, end - p)));
+
+      if (NULL == q) {
+        markup_.append(p, end);
+        break;
+      }
+
+      markup_.append(p, q + 1);
+      quote_ = '\0';
+      p = q + 1;
+      continue;
+    }
+
+    bool isTag(markup_.empty() ? ('!' != *p && '?' != *p)
+                               : ('!' != markup_[0] && '?' != markup_[0]));
+
+    const char* q(p);
+    while (q < end && '>' != *q && !(isTag && ('"' == *q || '\'' == *q))) {
+      ++q;
+    }
+
+    markup_.append(p, q);
+
+    if (q == end) {
+      break;
+    }
+
+    p = q + 1;
+
+    if ('>' != *q) {
+      quote_ = *q;
+      markup_ += *q;
+      continue;
+    }
+
+    if (!isMarkupComplete()) {
+      markup_ += '>';
+      continue;
+    }
+
+    state_ = STATE_TEXT;
+
+    if (!processMarkup()) {
+      failed_ = true;
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+bool StreamingXmlParser::ParseContext::endParse() {
+  bool result(!failed_ && done_ && NULL != response_);
+
+  response_ = NULL;
+  handler_ = NULL;
+
+  return (result);
+}
+
+
+bool StreamingXmlParser::ParseContext::isMarkupComplete() const {
+  if (startsWith(markup_, "!--")) {
+    return (markup_.size() >= 5 && endsWith(markup_, "--"));
+  }
+
+  if (startsWith(markup_, "![CDATA[")) {
+    return (markup_.size() >= 10 && endsWith(markup_, "]]"));
+  }
+
+  if (startsWith(markup_, "?")) {
+    return (endsWith(markup_, "?"));
+  }
+
+  return (true);
+}
+
+
+bool StreamingXmlParser::ParseContext::processMarkup() {
+  if (markup_.empty()) {
+    return (false);
+  }
+
+  switch (markup_[0]) {
+  case '?':
+    // processing instruction or declaration
+    return (true);
+
+  case '!':
+    if (2 == openElements_.size() && startsWith(markup_, "![CDATA[")) {
+      text_.append(markup_, 8, markup_.size() - 10);
+    }
+    // otherwise comment or DOCTYPE
+    return (true);
+
+  case '/': {
+    std::size_t nameEnd(markup_.size());
+    while (nameEnd > 1 && isSpace(markup_[nameEnd - 1])) {
+      --nameEnd;
+    }
+    return (processEndTag(markup_.substr(1, nameEnd - 1)));
+  }
+
+  default:
+    return (processStartTag());
+  }
+}
+
+
+bool StreamingXmlParser::ParseContext::processStartTag() {
+  if (done_) {
+    // single root element expected
+    return (false);
+  }
+
+  const char* p(markup_.data());
+  const char* end(p + markup_.size());
+
+  bool isSelfClosing('/' == *(end - 1));
+  if (isSelfClosing) {
+    --end;
+  }
+
+  const char* nameEnd(p);
+  while (nameEnd < end && !isSpace(*nameEnd)) {
+    ++nameEnd;
+  }
+
+  if (nameEnd == p) {
+    return (false);
+  }
+
+  std::string name(p, nameEnd);
+
+  ApiEntity* target(NULL);
+
+  if (openElements_.empty()) {
+    target = &response_->result;
+
+  } else if (1 == openElements_.size()) {
+    // keeps the attribute slots of the entity swapped from the response
+    entity_.recycle();
+    text_.clear();
+    target = &entity_;
+  }
+
+  if (NULL != target) {
+    target->name = name;
+  }
+
+  // attributes: name="value" or name='value'
+
+  std::string attrName;
+  std::string attrValue;
+
+  p = nameEnd;
+
+  while (true) {
+    while (p < end && isSpace(*p)) {
+      ++p;
+    }
+
+    if (p == end) {
+      break;
+    }
+
+    const char* attrNameBegin(p);
+    while (p < end && '=' != *p && !isSpace(*p)) {
+      ++p;
+    }
+    attrName.assign(attrNameBegin, p);
+
+    while (p < end && isSpace(*p)) {
+      ++p;
+    }
+
+    if (p == end || '=' != *p) {
+      return (false);
+    }
+    ++p;
+
+    while (p < end && isSpace(*p)) {
+      ++p;
+    }
+
+    if (p == end || ('"' != *p && '\'' != *p)) {
+      return (false);
+    }
+
+    const char* valueEnd(static_cast<const char*>(std::memchr(p + 1, *p, end - p - 1)));
+    if (NULL == valueEnd) {
+      return (false);
+    }
+
+    if (NULL != target) {
+      attrValue.clear();
+      appendDecoded(attrValue, p + 1, valueEnd, true);
+      target->attributes[attrName] = attrValue;
+    }
+
+    p = valueEnd + 1;
+  }
+
+  openElements_.push_back(name);
+
+  if (isSelfClosing) {
+    return (processEndTag(name));
+  }
+
+  return (true);
+}
+
+
+bool StreamingXmlParser::ParseContext::processEndTag(const std::string& name) {
+  if (openElements_.empty() || openElements_.back() != name) {
+    return (false);
+  }
+
+  if (2 == openElements_.size()) {
+    if (isBlank(text_)) {
+      entity_.value.clear();
+    } else {
+      entity_.value = text_;
+    }
+
+    if (NULL != handler_) {
+      handler_->onEntity(entity_);
+    } else {
+      response_->appendEntity().swap(entity_);
+    }
+  }
+
+  openElements_.pop_back();
+
+  if (openElements_.empty()) {
+    done_ = true;
+  }
+
+  return (true);
+}
+
+
+void StreamingXmlParser::ParseContext::flushText() {
+  if (!pendingText_.empty()) {
+    appendDecoded(text_, pendingText_.data(), pendingText_.data() + pendingText_.size(), false);
+    pendingText_.clear();
+  }
+}
+
+
+void StreamingXmlParser::appendDecoded(std::string& out, const char* begin, const char* end, bool isAttribute) {
+  const char* p(begin);
+
+  while (p < end) {
+    char c(*p++);
+
+    if ('&' == c) {
+      const char* semicolon(static_cast<const char*>(std::memchr(p, ';', end - p)));
+
+      if (NULL != semicolon) {
+        std::string ref(p, semicolon);
+        bool isKnown(true);
+
+        if ("lt" == ref) {
+          out += '<';
+        } else if ("gt" == ref) {
+          out += '>';
+        } else if ("amp" == ref) {
+          out += '&';
+        } else if ("quot" == ref) {
+          out += '"';
+        } else if ("apos" == ref) {
+          out += '\'';
+        } else if (ref.size() > 1 && '#' == ref[0]) {
+          bool isHex('x' == ref[1] || 'X' == ref[1]);
+          unsigned long code(std::strtoul(ref.c_str() + (isHex ? 2 : 1), NULL, (isHex ? 16 : 10)));
+          appendUtf8(out, code);
+        } else {
+          isKnown = false;
+        }
+
+        if (isKnown) {
+          p = semicolon + 1;
+          continue;
+        }
+      }
+
+      out += c;
+
+    } else if ('\r' == c) {
+      // normalize line ends
+      if (p < end && '\n' == *p) {
+        ++p;
+      }
+      out += (isAttribute ? ' ' : '\n');
+
+    } else if (isAttribute && ('\t' == c || '\n' == c)) {
+      out += ' ';
+
+    } else {
+      out += c;
+    }
+  }
+}
+
+
+} // namespace external
+} // namespace fredcpp
@@ -0,0 +1,326 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/internal/AttributeMap.h>
+#include <fredcpp/internal/LiteralCache.h>
+
+#include <algorithm>
+
+
+namespace fredcpp {
+namespace internal {
+
+namespace {
+
+/// Orders attributes by name, case-insensitive.
+
+struct lessAttributeName {
+  bool operator() (const AttributeMap::value_type& attribute, const std::string& name) const {
+    return (lessNoCase()(attribute.first.str(), name));
+  }
+};
+
+/// Orders symbols by text, case-insensitive.
+
+struct lessSymbolText {
+  bool operator() (const Symbol& symbol, const std::string& str) const {
+    return (lessNoCase()(symbol.str(), str));
+  }
+};
+
+const std::string EMPTY_SYMBOL_STRING;
+
+/// Limit of the per-thread symbol cache, beyond the expected count of names.
+const std::size_t MAX_CACHED_SYMBOLS = 1024;
+
+inline char foldCase(char c) {
+  return (('A' <= c && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c);
+}
+
+
+/// Matches symbol text with a C string, ASCII case-insensitive.
+
+bool equalsNoCase(const std::string& str, const char* cstr) {
+  std::size_t n(0);
+
+  for (; n < str.size(); ++n) {
+    if ('\0' == cstr[n] || foldCase(str[n]) != foldCase(cstr[n])) {
+      return (false);
+    }
+  }
+
+  return ('\0' == cstr[n]);
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+Symbol::Symbol(const std::string* str)
+  : str_(str) {
+}
+
+
+const std::string& Symbol::str() const {
+  return (NULL != str_ ? *str_ : EMPTY_SYMBOL_STRING);
+}
+
+
+Symbol::operator const std::string& () const {
+  return (str());
+}
+
+
+bool Symbol::operator== (const Symbol& rhs) const {
+  return (str_ == rhs.str_);
+}
+
+
+bool Symbol::operator!= (const Symbol& rhs) const {
+  return (str_ != rhs.str_);
+}
+
+
+std::ostream& operator<< (std::ostream& os, const Symbol& symbol) {
+  return (os << symbol.str());
+}
+
+//______________________________________________________________________________
+
+SymbolTable::SymbolTable() {
+}
+
+
+SymbolTable& SymbolTable::getInstance() {
+  static SymbolTable instance;
+
+  return (instance);
+}
+
+
+Symbol SymbolTable::intern(const std::string& str) {
+  // symbols are never released, so the per-thread copy stays valid
+  thread_local std::vector<Symbol> symbols;
+
+  std::vector<Symbol>::iterator it(std::lower_bound(symbols.begin(), symbols.end(), str, lessSymbolText()));
+
+  if (it != symbols.end() && !lessNoCase()(str, it->str())) {
+    return (*it);
+  }
+
+  Symbol symbol;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    symbol = Symbol(&*strings_.insert(str).first);
+  }
+
+  if (symbols.size() >= MAX_CACHED_SYMBOLS) {
+    symbols.clear();
+    it = symbols.begin();
+  }
+
+  symbols.insert(it, symbol);
+
+  return (symbol);
+}
+
+
+Symbol SymbolTable::internLiteral(const char* literal) {
+  thread_local LiteralCache literals(equalsNoCase);
+
+  const std::string* cached(literals.find(literal));
+
+  if (NULL != cached) {
+    return (Symbol(cached));
+  }
+
+  Symbol symbol(intern(literal));
+  literals.insert(literal, &symbol.str());
+
+  return (symbol);
+}
+
+
+bool SymbolTable::find(const std::string& str, Symbol& symbol) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::set<std::string, lessNoCase>::const_iterator itFound(strings_.find(str));
+
+  if (itFound == strings_.end()) {
+    return (false);
+  }
+
+  symbol = Symbol(&*itFound);
+  return (true);
+}
+
+
+std::size_t SymbolTable::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  return (strings_.size());
+}
+
+//______________________________________________________________________________
+
+AttributeMap::AttributeMap()
+  : size_(0) {
+}
+
+
+AttributeMap::AttributeMap(const AttributeMap& other)
+  : attributes_(other.begin(), other.end())
+  , size_(other.size_) {
+}
+
+
+AttributeMap& AttributeMap::operator= (const AttributeMap& rhs) {
+  if (this != &rhs) {
+    attributes_.assign(rhs.begin(), rhs.end());
+    size_ = rhs.size_;
+  }
+
+  return (*this);
+}
+
+
+AttributeMap::mapped_type& AttributeMap::operator[] (const key_type& name) {
+  iterator it(lowerBound(name));
+
+  if (it != end() && !lessNoCase()(name, it->first.str())) {
+    return (it->second);
+  }
+
+  // reuse the recycled slot of the same name, so its value keeps its memory
+  for (iterator slot = end(); slot != attributes_.end(); ++slot) {
+    if (equalsNoCase(slot->first.str(), name.c_str())) {
+      slot->second.clear();
+
+      std::size_t index(it - attributes_.begin());
+      std::rotate(it, slot, slot + 1);
+      ++size_;
+
+      return (attributes_[index].second);
+    }
+  }
+
+  it = attributes_.insert(it, value_type(SymbolTable::getInstance().intern(name), mapped_type()));
+  ++size_;
+
+  return (it->second);
+}
+
+
+AttributeMap::iterator AttributeMap::find(const key_type& name) {
+  iterator it(lowerBound(name));
+
+  if (it == end() || lessNoCase()(name, it->first.str())) {
+    return (end());
+  }
+
+  return (it);
+}
+
+
+AttributeMap::const_iterator AttributeMap::find(const key_type& name) const {
+  const_iterator it(std::lower_bound(begin(), end(), name, lessAttributeName()));
+
+  if (it == end() || lessNoCase()(name, it->first.str())) {
+    return (end());
+  }
+
+  return (it);
+}
+
+
+void AttributeMap::erase(const key_type& name) {
+  iterator itFound(find(name));
+
+  if (itFound != end()) {
+    attributes_.erase(itFound);
+    --size_;
+  }
+}
+
+
+AttributeMap::iterator AttributeMap::begin() {
+  return (attributes_.begin());
+}
+
+
+AttributeMap::iterator AttributeMap::end() {
+  return (attributes_.begin() + size_);
+}
+
+
+AttributeMap::const_iterator AttributeMap::begin() const {
+  return (attributes_.begin());
+}
+
+
+AttributeMap::const_iterator AttributeMap::end() const {
+  return (attributes_.begin() + size_);
+}
+
+
+std::size_t AttributeMap::size() const {
+  return (size_);
+}
+
+
+bool AttributeMap::empty() const {
+  return (0 == size_);
+}
+
+
+void AttributeMap::reserve(std::size_t count) {
+  attributes_.reserve(count);
+}
+
+
+void AttributeMap::clear() {
+  attributes_.clear();
+  size_ = 0;
+}
+
+
+void AttributeMap::recycle() {
+  size_ = 0;
+}
+
+
+void AttributeMap::swap(AttributeMap& other) {
+  attributes_.swap(other.attributes_);
+  std::swap(size_, other.size_);
+}
+
+
+AttributeMap::iterator AttributeMap::lowerBound(const key_type& name) {
+  return (std::lower_bound(begin(), end(), name, lessAttributeName()));
+}
+
+
+} // namespace internal
+} // namespace fredcpp
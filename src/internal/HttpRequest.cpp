@@ -25,6 +25,7 @@
 #include <fredcpp/internal/HttpRequest.h>
 #include <string>
 #include <algorithm>
+#include <thread>
 
 
 namespace fredcpp {
@@ -37,48 +38,173 @@ const char* HttpRequest::HTTP_METHODS[maxMethod] = {
 HttpRequest::HttpRequest(const std::string& URI)
   : Request()
   , method_(HttpRequest::HTTP_GET)
-  , URI_(URI) {
+  , URI_(URI)
+  , URIRef_(NULL)
+  , paramsRef_(NULL)
+  , mergedState_(MERGED_STALE) {
 }
 
 HttpRequest::HttpRequest(const std::string& URI, const Request& request)
   : Request(request)
   , method_(HttpRequest::HTTP_GET)
-  , URI_(URI) {
+  , URI_(URI)
+  , URIRef_(NULL)
+  , paramsRef_(NULL)
+  , mergedState_(MERGED_STALE) {
+}
+
+HttpRequest::HttpRequest(const HttpRequest& other)
+  : Request()
+  , method_(other.method_)
+  , URI_(other.URI_)
+  , URIRef_(other.URIRef_)
+  , paramsRef_(other.paramsRef_)
+  , headers_(other.headers_)
+  , mergedState_(MERGED_STALE) {
+  setOwnParams(other);
 }
 
 HttpRequest::~HttpRequest() {
 }
 
+HttpRequest& HttpRequest::operator= (const HttpRequest& rhs) {
+  if (this != &rhs) {
+    method_ = rhs.method_;
+    URI_ = rhs.URI_;
+    URIRef_ = rhs.URIRef_;
+    paramsRef_ = rhs.paramsRef_;
+    headers_ = rhs.headers_;
+    setOwnParams(rhs);
+  }
+
+  return (*this);
+}
+
 HttpRequest& HttpRequest::withURI(const std::string& URI) {
   URI_ = URI;
+  URIRef_ = NULL;
   return (*this);
 }
 
 HttpRequest& HttpRequest::withParams(const Request& request) {
-  setParams(request.getParams());
+  if (&request != this) {
+    paramsRef_ = NULL;
+    setParams(request);
+  }
+  return (*this);
+}
+
+HttpRequest& HttpRequest::withURIRef(const std::string& URI) {
+  URIRef_ = &URI;
+  return (*this);
+}
+
+HttpRequest& HttpRequest::withParamsRef(const Request& request) {
+  Request::clear();
+  paramsRef_ = &request;
+  return (*this);
+}
+
+HttpRequest& HttpRequest::withHeader(const std::string& name, const std::string& value) {
+  headers_[name] = value;
   return (*this);
 }
 
 const std::string& HttpRequest::getURI() const {
-  return (URI_);
+  return (NULL == URIRef_ ? URI_ : *URIRef_);
+}
+
+const KeyValueMap& HttpRequest::getHeaders() const {
+  return (headers_);
 }
 
 HttpRequest::Method HttpRequest::getMethod() const {
   return (method_);
 }
 
+const ParamMap& HttpRequest::getParams() const {
+  return (NULL == paramsRef_ ? Request::getParams() : getMerged().getParams());
+}
+
+const std::string& HttpRequest::getEncodedQuery() const {
+  return (NULL == paramsRef_ ? Request::getEncodedQuery() : getMerged().getEncodedQuery());
+}
+
+std::uint64_t HttpRequest::getFingerprint() const {
+  return (NULL == paramsRef_ ? Request::getFingerprint() : getMerged().getFingerprint());
+}
+
+void HttpRequest::appendEncodedQuery(std::string& buf) const {
+  if (NULL == paramsRef_) {
+    buf.append(Request::getEncodedQuery());
+    return;
+  }
+
+  // walk the referred and own parameters in order, taking segments of the
+  // referred ones from their encoded query; own parameters override
+
+  const std::string& query(paramsRef_->getEncodedQuery());
+  const ParamMap& params(paramsRef_->getParams());
+  const ParamMap& ownParams(Request::getParams());
+
+  ParamMap::const_iterator it(params.begin());
+  ParamMap::const_iterator itOwn(ownParams.begin());
+  std::size_t pos(0);
+  lessNoCase less;
+
+  while (it != params.end() || itOwn != ownParams.end()) {
+    if (it != params.begin() || itOwn != ownParams.begin()) {
+      buf.append(1, '&');
+    }
+
+    std::size_t end(query.find('&', pos));
+    if (std::string::npos == end) {
+      end = query.size();
+    }
+
+    if (itOwn == ownParams.end()
+        || (it != params.end() && less(it->first.str(), itOwn->first.str()))) {
+      buf.append(query, pos, end - pos);
+      pos = end + 1;
+      ++it;
+      continue;
+    }
+
+    if (it != params.end() && !less(itOwn->first.str(), it->first.str())) {
+      // overridden
+      pos = end + 1;
+      ++it;
+    }
+
+    appendQueryParam(buf, *itOwn);
+    ++itOwn;
+  }
+}
+
+void HttpRequest::eraseParam(const KeyValueMap::key_type& key) {
+  detachParams();
+  Request::eraseParam(key);
+}
+
+void HttpRequest::clear() {
+  paramsRef_ = NULL;
+  Request::clear();
+}
+
 bool HttpRequest::isHttps() const {
     const std::string HTTPS("https:");
     const std::string WHITESPACE(" \t\r\n");
     bool result(false);
 
-    std::size_t pos = URI_.find_first_not_of(WHITESPACE);
+    const std::string& URI(getURI());
+
+    std::size_t pos = URI.find_first_not_of(WHITESPACE);
     if ( std::string::npos == pos ) {
         // URI empty or whitespace only
         return (result);
     }
 
-    std::string buf = URI_.substr(pos, HTTPS.size());
+    std::string buf = URI.substr(pos, HTTPS.size());
     std::transform(buf.begin(), buf.end(), buf.begin(), ::tolower);
 
     result = (buf.compare(HTTPS) == 0);
@@ -90,7 +216,7 @@ std::ostream& HttpRequest::print(std::ostream& os) const {
   // METHOD URI|params
 
   os << HTTP_METHODS[method_]
-     << " " << URI_;
+     << " " << getURI();
 
   if (getParams().size()) {
      os << "|";
@@ -100,6 +226,54 @@ std::ostream& HttpRequest::print(std::ostream& os) const {
   return (os);
 }
 
+void HttpRequest::onParamsChange() {
+  mergedState_.store(MERGED_STALE, std::memory_order_relaxed);
+}
+
+const Request& HttpRequest::getMerged() const {
+  if (MERGED_READY != mergedState_.load(std::memory_order_acquire)) {
+    mergeParams();
+  }
+
+  return (merged_);
+}
+
+void HttpRequest::mergeParams() const {
+  int state(MERGED_STALE);
+
+  if (!mergedState_.compare_exchange_strong(state, MERGED_BUILDING, std::memory_order_acquire)) {
+    // another thread is merging them
+    while (MERGED_READY != mergedState_.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    return;
+  }
+
+  ParamMap params(paramsRef_->getParams());
+  const ParamMap& ownParams(Request::getParams());
+
+  for (ParamMap::const_iterator it = ownParams.begin();
+       it != ownParams.end();
+       ++it) {
+    params.set(it->first, it->second.data(), it->second.size());
+  }
+
+  merged_.setParams(params);
+
+  mergedState_.store(MERGED_READY, std::memory_order_release);
+}
+
+void HttpRequest::detachParams() {
+  if (NULL == paramsRef_) {
+    return;
+  }
+
+  ParamMap params(getMerged().getParams());
+
+  paramsRef_ = NULL;
+  setParams(params);
+}
+
 
 std::ostream& operator<< (std::ostream& os, const HttpRequest& object) {
   return (object.print(os));
@@ -25,11 +25,10 @@
 #include <fredcpp/internal/HttpRequestExecutor.h>
 #include <fredcpp/internal/HttpRequest.h>
 #include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/RateLimiter.h>
 
 #include <fredcpp/version.h>
 
-#include <sstream>
-
 #include <cassert>
 
 
@@ -42,6 +41,11 @@ const char HttpRequestExecutor::QUERY_PARAM_ASSIGNMENT_CHAR('=');
 const std::string HttpRequestExecutor::DEFAULT_USER_AGENT_NAME(FREDCPP_BRIEF);
 
 
+HttpResponseHandler::~HttpResponseHandler() {
+}
+
+//______________________________________________________________________________
+
 HttpRequestExecutor::HttpRequestExecutor(const std::string& userAgent)
   : userAgent_(userAgent)
   , querySeparatorChar_(QUERY_SEPARATOR_CHAR)
@@ -61,10 +65,51 @@ HttpRequestExecutor& HttpRequestExecutor::withUserAgent(const std::string& userA
 }
 
 
+bool HttpRequestExecutor::executeLimited(const HttpRequest& request, HttpResponse& response, RateLimiter* rateLimiter) {
+  if (NULL != rateLimiter) {
+    rateLimiter->acquire();
+  }
+
+  return (execute(request, response));
+}
+
+
+bool HttpRequestExecutor::executeBatch(const HttpRequestVector& requests, HttpResponseHandler& handler, RateLimiter* rateLimiter) {
+  bool result(true);
+
+  HttpResponse response;
+
+  for (std::size_t n = 0; n < requests.size(); ++n) {
+    if (NULL != rateLimiter) {
+      rateLimiter->acquire();
+    }
+
+    result = execute(requests[n], response) && result;
+
+    handler.onResponse(n, requests[n], response);
+  }
+
+  return (result);
+}
+
+
 std::string HttpRequestExecutor::getRequestString(const HttpRequest& request) {
-  std::ostringstream buf;
+  const ParamMap& params(request.getParams());
+
+  // reserve for the query as is, encoding seldom expands FRED parameters
+
+  std::size_t size(request.getURI().size());
+
+  for (ParamMap::const_iterator it = params.begin();
+       it != params.end();
+       ++it) {
+    size += it->first.str().size() + it->second.size() + 2;
+  }
 
-  buf << request.getURI();
+  std::string buf;
+  buf.reserve(size);
+
+  buf.append(request.getURI());
 
 
   /// @attention Only GET method is currently supported
@@ -74,25 +119,29 @@ std::string HttpRequestExecutor::getRequestString(const HttpRequest& request) {
   assert( requireValidHttpMethod &&  "Only HTTP GET method supported");
 
   if (!requireValidHttpMethod) {
-    return (buf.str());
+    return (buf);
   }
 
 
   // Append encoded query parameters
 
-  const KeyValueMap& params(request.getParams());
-
   int i = 0;
-  for (KeyValueMap::const_iterator it = params.begin();
+  for (ParamMap::const_iterator it = params.begin();
        it != params.end();
        ++it) {
 
-    buf << ( i++ ? queryParamSeparatorChar_ : querySeparatorChar_)
-        << encodeURI(it->first)
-        << queryParamAssignmentChar_ << encodeURI(it->second);
+    buf.append(1, ( i++ ? queryParamSeparatorChar_ : querySeparatorChar_));
+    appendEncodedURI(buf, it->first);
+    buf.append(1, queryParamAssignmentChar_);
+    appendEncodedURI(buf, it->second.str());
   }
 
-  return (buf.str());
+  return (buf);
+}
+
+
+void HttpRequestExecutor::appendEncodedURI(std::string& buf, const std::string& URI) {
+  buf.append(encodeURI(URI));
 }
 
 
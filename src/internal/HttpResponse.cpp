@@ -27,15 +27,78 @@
 namespace fredcpp {
 namespace internal {
 
+HttpContentSink::~HttpContentSink() {
+}
+
+//______________________________________________________________________________
+
+HttpResponse::ContentStreamBuf::ContentStreamBuf(HttpResponse& response)
+  : response_(response) {
+}
+
+HttpResponse::ContentStreamBuf::int_type HttpResponse::ContentStreamBuf::overflow(int_type c) {
+  if (traits_type::eq_int_type(c, traits_type::eof())) {
+    return (traits_type::not_eof(c));
+  }
+
+  char ch(traits_type::to_char_type(c));
+  response_.appendContent(&ch, 1);
+  return (c);
+}
+
+std::streamsize HttpResponse::ContentStreamBuf::xsputn(const char* s, std::streamsize n) {
+  response_.appendContent(s, static_cast<std::size_t>(n));
+  return (n);
+}
+
+//______________________________________________________________________________
+
 HttpResponse::HttpResponse()
-  : contentType_() {
+  : content_()
+  , contentSink_(NULL)
+  , contentStreamBuf_(*this)
+  , contentStream_(&contentStreamBuf_)
+  , contentType_()
+  , contentBytes_(0)
+  , transferBytes_(0) {
   clear();
 }
 
 HttpResponse::~HttpResponse() {
 }
 
-std::ostringstream& HttpResponse::getContentStream() {
+std::ostream& HttpResponse::getContentStream() {
+  return (contentStream_);
+}
+
+void HttpResponse::appendContent(const char* data, std::size_t size) {
+  contentBytes_ += size;
+
+  if (NULL != contentSink_) {
+    contentSink_->onContent(data, size);
+    return;
+  }
+
+  content_.append(data, size);
+}
+
+void HttpResponse::reserveContent(std::size_t size) {
+  content_.reserve(size);
+}
+
+void HttpResponse::setContentSink(HttpContentSink* sink) {
+  contentSink_ = sink;
+}
+
+void HttpResponse::setTransferBytes(std::size_t bytes) {
+  transferBytes_ = bytes;
+}
+
+const std::string& HttpResponse::getContent() const {
+  return (content_);
+}
+
+std::string& HttpResponse::getContentBuffer() {
   return (content_);
 }
 
@@ -55,6 +118,36 @@ HttpResponse::HttpStatus HttpResponse::getHttpStatus() const {
   return (httpStatus_);
 }
 
+std::size_t HttpResponse::getContentBytes() const {
+  return (contentBytes_);
+}
+
+std::size_t HttpResponse::getTransferBytes() const {
+  return (transferBytes_);
+}
+
+void HttpResponse::setHeader(const std::string& name, const std::string& value) {
+  headers_[name] = value;
+}
+
+std::string HttpResponse::getHeader(const std::string& name) const {
+  KeyValueMap::const_iterator itFound(headers_.find(name));
+
+  if (itFound == headers_.end()) {
+    return (std::string());
+  }
+
+  return (itFound->second);
+}
+
+const KeyValueMap& HttpResponse::getHeaders() const {
+  return (headers_);
+}
+
+void HttpResponse::clearHeaders() {
+  headers_.clear();
+}
+
 bool HttpResponse::isBadRequest() const {
   return (HTTP_BAD_REQUEST == httpStatus_);
 }
@@ -63,10 +156,22 @@ bool HttpResponse::isXmlContent() const {
   return (std::string::npos != contentType_.find("text/xml"));
 }
 
+bool HttpResponse::isJsonContent() const {
+  return (std::string::npos != contentType_.find("json"));
+}
+
 void HttpResponse::clear() {
-  content_.str("");
+  content_.clear();
+  contentStream_.clear();
+
+  if (NULL != contentSink_) {
+    contentSink_->onContentReset();
+  }
   contentType_.clear();
+  headers_.clear();
   httpStatus_ = HTTP_BAD_REQUEST;
+  contentBytes_ = 0;
+  transferBytes_ = 0;
 }
 
 
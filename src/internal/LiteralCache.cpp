@@ -0,0 +1,78 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/internal/LiteralCache.h>
+
+
+namespace fredcpp {
+namespace internal {
+
+/// Limit of the cache, as non-literal arrays may pass many different addresses.
+const std::size_t LiteralCache::MAX_CACHED_LITERALS(256);
+
+
+LiteralCache::LiteralCache(MatchFunction matches)
+  : matches_(matches) {
+}
+
+
+const std::string* LiteralCache::find(const char* literal) const {
+  std::map<const char*, const std::string*>::const_iterator itFound(literals_.find(literal));
+
+  if (itFound == literals_.end() || !matches_(*itFound->second, literal)) {
+    return (NULL);
+  }
+
+  return (itFound->second);
+}
+
+
+void LiteralCache::insert(const char* literal, const std::string* interned) {
+  std::map<const char*, const std::string*>::iterator itFound(literals_.find(literal));
+
+  if (itFound != literals_.end()) {
+    itFound->second = interned;
+    return;
+  }
+
+  if (literals_.size() >= MAX_CACHED_LITERALS) {
+    literals_.clear();
+  }
+
+  literals_.insert(std::make_pair(literal, interned));
+}
+
+
+std::size_t LiteralCache::size() const {
+  return (literals_.size());
+}
+
+
+bool LiteralCache::equals(const std::string& interned, const char* str) {
+  return (0 == interned.compare(str));
+}
+
+
+} // namespace internal
+} // namespace fredcpp
@@ -0,0 +1,122 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/internal/LogRing.h>
+
+
+namespace fredcpp {
+namespace internal {
+
+
+LogRecord::LogRecord()
+  : level(LogLevel::LOG_NULL) {
+}
+
+//______________________________________________________________________________
+
+LogRing::LogRing(std::size_t capacity)
+  : slots_()
+  , mask_(0)
+  , pushPos_(0)
+  , popPos_(0) {
+
+  std::size_t size(2);
+  while (size < capacity) {
+    size <<= 1;
+  }
+
+  std::vector<Slot> slots(size);
+  slots_.swap(slots);
+  mask_ = size - 1;
+
+  for (std::size_t n = 0; n < size; ++n) {
+    slots_[n].sequence.store(n, std::memory_order_relaxed);
+  }
+}
+
+
+bool LogRing::tryPush(LogLevel::Level level, const std::string& line) {
+  std::size_t pos(pushPos_.load(std::memory_order_relaxed));
+  Slot* slot(NULL);
+
+  for (;;) {
+    slot = &slots_[pos & mask_];
+
+    std::size_t sequence(slot->sequence.load(std::memory_order_acquire));
+    std::ptrdiff_t diff(static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos));
+
+    if (0 == diff) {
+      // slot is free, claim it
+      if (pushPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+
+    } else if (diff < 0) {
+      // slot still holds a record of the previous round
+      return (false);
+
+    } else {
+      pos = pushPos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->record.level = level;
+  slot->record.line.assign(line);
+
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  return (true);
+}
+
+
+bool LogRing::tryPop(LogRecord& record) {
+  Slot& slot(slots_[popPos_ & mask_]);
+
+  if (slot.sequence.load(std::memory_order_acquire) != popPos_ + 1) {
+    return (false);
+  }
+
+  record.level = slot.record.level;
+  record.line.swap(slot.record.line);
+
+  // free the slot for the next round
+  slot.sequence.store(popPos_ + mask_ + 1, std::memory_order_release);
+  ++popPos_;
+
+  return (true);
+}
+
+
+unsigned long long LogRing::getPushCount() const {
+  return (pushPos_.load(std::memory_order_acquire));
+}
+
+
+std::size_t LogRing::capacity() const {
+  return (slots_.size());
+}
+
+
+} // namespace internal
+} // namespace fredcpp
@@ -26,6 +26,8 @@
 
 #include <cassert>
 
+#include <memory>
+#include <streambuf>
 #include <string>
 
 
@@ -35,6 +37,30 @@ namespace internal {
 
 const char* LogContext::UNKNOWN_("<unknown>");
 
+namespace {
+
+/// Stream buffer appending to a string.
+
+class StringStreamBuf : public std::streambuf {
+public:
+  std::string str;
+
+protected:
+  int_type overflow(int_type c) {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      str.push_back(traits_type::to_char_type(c));
+    }
+    return (traits_type::not_eof(c));
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize n) {
+    str.append(s, static_cast<std::size_t>(n));
+    return (n);
+  }
+};
+
+} // namespace
+
 //______________________________________________________________________________
 
 bool LogLevel::valid(const LogLevel::Level level) {
@@ -60,7 +86,8 @@ LogContext::LogContext(const char* file_, const long line_, const char* func_)
 
 //______________________________________________________________________________
 
-Logger::Logger() {
+Logger::Logger()
+  : levelMask_(LEVEL_MASK_UNKNOWN) {
 }
 
 
@@ -68,5 +95,125 @@ Logger::~Logger() {
 }
 
 
+void Logger::cacheLevelEnabled(LogLevel::Level level, bool enabled) {
+  if (!LogLevel::valid(level)) {
+    return;
+  }
+
+  unsigned bit(1U << level);
+
+  if (enabled) {
+    levelMask_.fetch_or(bit, std::memory_order_relaxed);
+  } else {
+    levelMask_.fetch_and(~bit, std::memory_order_relaxed);
+  }
+
+  levelMask_.fetch_and(~LEVEL_MASK_UNKNOWN, std::memory_order_relaxed);
+}
+
+//______________________________________________________________________________
+
+/// Reusable message buffer with its formatting stream.
+
+class LogMessage::Buffer {
+public:
+  Buffer()
+    : os(&streamBuf)
+    , flags(os.flags())
+    , precision(os.precision())
+    , fill(os.fill()) {
+  }
+
+  /// Clears the message and restores the stream format.
+  void reset() {
+    // do not keep memory of an exceptionally long message
+    if (streamBuf.str.capacity() > MAX_RETAINED_SIZE) {
+      std::string().swap(streamBuf.str);
+    } else {
+      streamBuf.str.clear();
+    }
+
+    os.clear();
+    os.flags(flags);
+    os.precision(precision);
+    os.fill(fill);
+    os.width(0);
+  }
+
+  static const std::size_t MAX_RETAINED_SIZE = 64 * 1024;
+
+  StringStreamBuf streamBuf;
+  std::ostream os;
+
+private:
+  std::ios_base::fmtflags flags;
+  std::streamsize precision;
+  char fill;
+};
+
+
+namespace {
+
+/// Per-thread message buffers, one for each nesting level.
+
+struct ThreadLogBuffers {
+  static const std::size_t MAX_NESTING = 4;
+
+  std::unique_ptr<LogMessage::Buffer> buffers[MAX_NESTING];
+  std::size_t depth;
+
+  ThreadLogBuffers()
+    : depth(0) {
+  }
+};
+
+thread_local ThreadLogBuffers threadLogBuffers;
+
+} // namespace
+
+
+LogMessage::LogMessage()
+  : buffer_(NULL)
+  , owned_(false) {
+
+  ThreadLogBuffers& buffers(threadLogBuffers);
+
+  if (buffers.depth < ThreadLogBuffers::MAX_NESTING) {
+    std::unique_ptr<Buffer>& buffer(buffers.buffers[buffers.depth++]);
+
+    if (!buffer) {
+      buffer.reset(new Buffer());
+    }
+
+    buffer_ = buffer.get();
+
+  } else {
+    buffer_ = new Buffer();
+    owned_ = true;
+  }
+}
+
+
+LogMessage::~LogMessage() {
+  if (owned_) {
+    delete buffer_;
+    return;
+  }
+
+  buffer_->reset();
+  --threadLogBuffers.depth;
+}
+
+
+std::ostream& LogMessage::stream() {
+  return (buffer_->os);
+}
+
+
+const std::string& LogMessage::str() const {
+  return (buffer_->streamBuf.str);
+}
+
+
 } // namespace internal
 } // namespace fredcpp
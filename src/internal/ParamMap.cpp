@@ -0,0 +1,273 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/internal/ParamMap.h>
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace fredcpp {
+namespace internal {
+
+namespace {
+
+/// Compares parameter names case-insensitively.
+/// Names are ASCII, so they are folded without consulting the locale;
+/// orders the same as lessNoCase in the "C" locale.
+
+inline unsigned char foldCase(char c) {
+  unsigned char uc(static_cast<unsigned char>(c));
+  return ((uc >= 'A' && uc <= 'Z') ? static_cast<unsigned char>(uc + ('a' - 'A')) : uc);
+}
+
+
+bool lessName(const std::string& lhs, const std::string& rhs) {
+  std::size_t size(std::min(lhs.size(), rhs.size()));
+
+  for (std::size_t n = 0; n < size; ++n) {
+    unsigned char l(foldCase(lhs[n]));
+    unsigned char r(foldCase(rhs[n]));
+
+    if (l != r) {
+      return (l < r);
+    }
+  }
+
+  return (lhs.size() < rhs.size());
+}
+
+
+/// Orders parameters by name, case-insensitive.
+
+struct lessParamName {
+  bool operator() (const ParamMap::value_type& param, const std::string& name) const {
+    return (lessName(param.first.str(), name));
+  }
+};
+
+} // namespace
+
+//______________________________________________________________________________
+
+ParamValue::ParamValue()
+  : size_(0) {
+  inline_[0] = '\0';
+}
+
+
+ParamValue::ParamValue(const std::string& value)
+  : size_(0) {
+  assign(value.data(), value.size());
+}
+
+
+ParamValue::ParamValue(const char* data, std::size_t size)
+  : size_(0) {
+  assign(data, size);
+}
+
+
+void ParamValue::assign(const char* data, std::size_t size) {
+  if (size <= INLINE_SIZE) {
+    std::memcpy(inline_, data, size);
+    inline_[size] = '\0';
+    heap_.clear();
+
+  } else {
+    heap_.assign(data, size);
+  }
+
+  size_ = size;
+}
+
+
+bool ParamValue::equals(const char* data, std::size_t size) const {
+  return (size == size_ && 0 == std::memcmp(this->data(), data, size));
+}
+
+
+const char* ParamValue::data() const {
+  return (size_ <= INLINE_SIZE ? inline_ : heap_.data());
+}
+
+
+const char* ParamValue::c_str() const {
+  return (size_ <= INLINE_SIZE ? inline_ : heap_.c_str());
+}
+
+
+std::size_t ParamValue::size() const {
+  return (size_);
+}
+
+
+bool ParamValue::empty() const {
+  return (0 == size_);
+}
+
+
+std::string ParamValue::str() const {
+  return (std::string(data(), size_));
+}
+
+
+ParamValue::operator std::string () const {
+  return (str());
+}
+
+
+std::ostream& operator<< (std::ostream& os, const ParamValue& value) {
+  return (os.write(value.data(), value.size()));
+}
+
+//______________________________________________________________________________
+
+ParamMap::ParamMap()
+  : size_(0) {
+}
+
+
+std::pair<ParamMap::iterator, bool> ParamMap::set(const Symbol& name, const char* data, std::size_t size) {
+  iterator it(const_cast<iterator>(lowerBound(name)));
+
+  if (it != end() && (it->first == name || !lessName(name.str(), it->first.str()))) {
+    it->second.assign(data, size);
+    return (std::make_pair(it, false));
+  }
+
+  std::size_t index(it - begin());
+
+  if (!isOnHeap() && size_ == INLINE_CAPACITY) {
+    heap_.reserve(2 * INLINE_CAPACITY);
+    heap_.assign(inline_, inline_ + size_);
+  }
+
+  if (isOnHeap()) {
+    heap_.insert(heap_.begin() + index, value_type(name, ParamValue(data, size)));
+
+  } else {
+    std::move_backward(inline_ + index, inline_ + size_, inline_ + size_ + 1);
+    inline_[index].first = name;
+    inline_[index].second.assign(data, size);
+  }
+
+  ++size_;
+
+  return (std::make_pair(begin() + index, true));
+}
+
+
+ParamMap::iterator ParamMap::find(const key_type& name) {
+  return (const_cast<iterator>(static_cast<const ParamMap&>(*this).find(name)));
+}
+
+
+ParamMap::const_iterator ParamMap::find(const key_type& name) const {
+  const_iterator it(lowerBound(name));
+
+  if (it == end() || lessName(name, it->first.str())) {
+    return (end());
+  }
+
+  return (it);
+}
+
+
+void ParamMap::erase(const key_type& name) {
+  iterator itFound(find(name));
+
+  if (itFound == end()) {
+    return;
+  }
+
+  if (isOnHeap()) {
+    heap_.erase(heap_.begin() + (itFound - begin()));
+
+  } else {
+    std::move(itFound + 1, end(), itFound);
+  }
+
+  --size_;
+}
+
+
+ParamMap::iterator ParamMap::begin() {
+  return (isOnHeap() ? heap_.data() : inline_);
+}
+
+
+ParamMap::iterator ParamMap::end() {
+  return (begin() + size_);
+}
+
+
+ParamMap::const_iterator ParamMap::begin() const {
+  return (isOnHeap() ? heap_.data() : inline_);
+}
+
+
+ParamMap::const_iterator ParamMap::end() const {
+  return (begin() + size_);
+}
+
+
+std::size_t ParamMap::size() const {
+  return (size_);
+}
+
+
+bool ParamMap::empty() const {
+  return (0 == size_);
+}
+
+
+void ParamMap::clear() {
+  heap_.clear();
+  size_ = 0;
+}
+
+
+void ParamMap::swap(ParamMap& other) {
+  using std::swap;
+  swap(size_, other.size_);
+  swap(inline_, other.inline_);
+  heap_.swap(other.heap_);
+}
+
+
+bool ParamMap::isOnHeap() const {
+  // parameters move to the heap once the inline array is full, and back only
+  // when all are removed
+  return (!heap_.empty());
+}
+
+
+ParamMap::const_iterator ParamMap::lowerBound(const key_type& name) const {
+  return (std::lower_bound(begin(), end(), name, lessParamName()));
+}
+
+
+} // namespace internal
+} // namespace fredcpp
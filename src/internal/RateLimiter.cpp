@@ -0,0 +1,207 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/internal/RateLimiter.h>
+#include <fredcpp/internal/utils.h>
+
+#include <map>
+
+
+namespace fredcpp {
+namespace internal {
+
+const unsigned long RateLimiter::DEFAULT_PERIOD_MILLIS(60000UL);
+
+
+RateLimiter::RateLimiter(unsigned maxRequests, unsigned long periodMillis)
+  : maxRequests_(0)
+  , periodMillis_(DEFAULT_PERIOD_MILLIS)
+  , burst_(1)
+  , tokens_(0.0)
+  , lastRefillMillis_(0ULL) {
+  withRate(maxRequests, periodMillis);
+}
+
+
+RateLimiter& RateLimiter::forKey(const std::string& key) {
+  static std::mutex limitersMutex;
+  static std::map<std::string, RateLimiter> limiters;
+
+  // map nodes are stable, the limiter itself is locked on use
+  std::lock_guard<std::mutex> lock(limitersMutex);
+
+  return (limiters[key]);
+}
+
+
+RateLimiter& RateLimiter::withRate(unsigned maxRequests, unsigned long periodMillis) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (0 == periodMillis) {
+    periodMillis = DEFAULT_PERIOD_MILLIS;
+  }
+
+  if (maxRequests == maxRequests_ && periodMillis == periodMillis_) {
+    return (*this);
+  }
+
+  bool wasEnabled(isEnabled());
+
+  // tokens earned so far count at the former rate, the bucket is not refilled
+  if (wasEnabled) {
+    refill(monotonicMillis());
+  }
+
+  maxRequests_ = maxRequests;
+  periodMillis_ = periodMillis;
+
+  if (!wasEnabled) {
+    resetTokens();
+  }
+
+  return (*this);
+}
+
+
+RateLimiter& RateLimiter::withBurst(unsigned burst) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  burst_ = (burst ? burst : 1);
+  resetTokens();
+  return (*this);
+}
+
+
+bool RateLimiter::enabled() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  return (isEnabled());
+}
+
+
+bool RateLimiter::tryAcquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!isEnabled()) {
+    return (true);
+  }
+
+  refill(monotonicMillis());
+
+  if (tokens_ < 1.0) {
+    return (false);
+  }
+
+  tokens_ -= 1.0;
+  return (true);
+}
+
+
+unsigned long RateLimiter::acquire() {
+  unsigned long waited(0);
+
+  while (!tryAcquire()) {
+    unsigned long waitMillis(getWaitMillis());
+
+    sleepMillis(waitMillis ? waitMillis : 1);
+    waited += (waitMillis ? waitMillis : 1);
+  }
+
+  return (waited);
+}
+
+
+void RateLimiter::release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!isEnabled()) {
+    return;
+  }
+
+  refill(monotonicMillis());
+
+  tokens_ += 1.0;
+
+  if (tokens_ > burst_) {
+    tokens_ = burst_;
+  }
+}
+
+
+unsigned long RateLimiter::getWaitMillis() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!isEnabled()) {
+    return (0);
+  }
+
+  refill(monotonicMillis());
+
+  if (tokens_ >= 1.0) {
+    return (0);
+  }
+
+  double millisPerToken(static_cast<double>(periodMillis_) / maxRequests_);
+
+  return (static_cast<unsigned long>((1.0 - tokens_) * millisPerToken) + 1);
+}
+
+
+void RateLimiter::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  resetTokens();
+}
+
+
+bool RateLimiter::isEnabled() const {
+  return (maxRequests_ > 0);
+}
+
+
+void RateLimiter::resetTokens() {
+  tokens_ = burst_;
+  lastRefillMillis_ = monotonicMillis();
+}
+
+
+void RateLimiter::refill(unsigned long long now) {
+  if (now <= lastRefillMillis_) {
+    return;
+  }
+
+  double elapsed(static_cast<double>(now - lastRefillMillis_));
+
+  tokens_ += elapsed * maxRequests_ / periodMillis_;
+
+  if (tokens_ > burst_) {
+    tokens_ = burst_;
+  }
+
+  lastRefillMillis_ = now;
+}
+
+
+} // namespace internal
+} // namespace fredcpp
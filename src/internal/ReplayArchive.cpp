@@ -0,0 +1,138 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/internal/ReplayArchive.h>
+
+#include <fredcpp/internal/HttpRequest.h>
+
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+
+
+namespace fredcpp {
+namespace internal {
+
+const std::string ReplayArchive::SIGNATURE("fredcpp-replay/1");
+const std::string ReplayArchive::IGNORED_PARAM("api_key");
+
+
+ReplayRecord::ReplayRecord()
+  : httpStatus(HttpResponse::HTTP_UNKNOWN) {
+}
+
+//______________________________________________________________________________
+
+std::string ReplayArchive::makeKey(const HttpRequest& request) {
+  std::string key(request.getURI());
+
+  const ParamMap& params(request.getParams());
+  ParamMap::const_iterator ignored(params.find(IGNORED_PARAM));
+
+  char separator('?');
+  for (ParamMap::const_iterator it = params.begin(); it != params.end(); ++it) {
+    if (it == ignored) {
+      continue;
+    }
+
+    key.append(1, separator).append(it->first.str()).append(1, '=')
+       .append(it->second.data(), it->second.size());
+    separator = '&';
+  }
+
+  return (key);
+}
+
+
+bool ReplayArchive::writeSignature(std::ostream& os) {
+  os << SIGNATURE << '\n';
+  return (!os.fail());
+}
+
+
+bool ReplayArchive::readSignature(std::istream& is) {
+  std::string line;
+  return (std::getline(is, line) && SIGNATURE == line);
+}
+
+
+bool ReplayArchive::writeRecord(std::ostream& os, const ReplayRecord& record) {
+  os << "record " << static_cast<int>(record.httpStatus) << ' ' << record.content.size() << '\n'
+     << "key " << record.key << '\n'
+     << "content-type " << record.contentType << '\n';
+
+  for (KeyValueMap::const_iterator it = record.headers.begin(); it != record.headers.end(); ++it) {
+    os << "header " << it->first << ' ' << it->second << '\n';
+  }
+
+  os << '\n';
+  os.write(record.content.data(), static_cast<std::streamsize>(record.content.size()));
+  os << '\n';
+
+  return (!os.fail());
+}
+
+
+bool ReplayArchive::readRecord(std::istream& is, ReplayRecord& record) {
+  record = ReplayRecord();
+
+  std::string line;
+
+  if (!std::getline(is, line) || 0 != line.compare(0, 7, "record ")) {
+    return (false);
+  }
+
+  char* end(NULL);
+  record.httpStatus = static_cast<HttpResponse::HttpStatus>(std::strtol(line.c_str() + 7, &end, 10));
+  std::size_t contentSize(static_cast<std::size_t>(std::strtoul(end, NULL, 10)));
+
+  // header lines "name value" up to a blank line, then the content
+
+  while (std::getline(is, line) && !line.empty()) {
+    std::string::size_type space(line.find(' '));
+    std::string name(line.substr(0, space));
+    std::string value(std::string::npos == space ? std::string() : line.substr(space + 1));
+
+    if ("key" == name) {
+      record.key = value;
+
+    } else if ("content-type" == name) {
+      record.contentType = value;
+
+    } else if ("header" == name) {
+      std::string::size_type valueSpace(value.find(' '));
+      record.headers[value.substr(0, valueSpace)] =
+        (std::string::npos == valueSpace ? std::string() : value.substr(valueSpace + 1));
+    }
+  }
+
+  record.content.resize(contentSize);
+  is.read(&record.content[0], static_cast<std::streamsize>(contentSize));
+
+  return (!is.fail() && '\n' == is.get() && !record.key.empty());
+}
+
+
+} // namespace internal
+} // namespace fredcpp
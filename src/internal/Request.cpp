@@ -24,18 +24,27 @@
 
 #include <fredcpp/internal/Request.h>
 
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <thread>
+
 
 namespace fredcpp {
 namespace internal {
 
 
-Request::Request() {
+Request::Request()
+  : fingerprint_(0)
+  , queryState_(QUERY_STALE) {
 
 }
 
 
-Request::Request(const Request& other) {
-  params_ = other.params_;
+Request::Request(const Request& other)
+  : fingerprint_(0)
+  , queryState_(QUERY_STALE) {
+  setParams(other);
 }
 
 
@@ -46,6 +55,12 @@ Request::~Request() {
 void Request::swap(Request& other) {
   using std::swap;
   params_.swap(other.params_);
+  encodedQuery_.swap(other.encodedQuery_);
+  swap(fingerprint_, other.fingerprint_);
+
+  int state(queryState_.load());
+  queryState_.store(other.queryState_.load());
+  other.queryState_.store(state);
 }
 
 
@@ -60,6 +75,12 @@ Request& Request::operator= (const Request& rhs) {
 
 
 Request& Request::with(const KeyValueMap::key_type& key, const KeyValueMap::mapped_type& value) {
+  insertParam(SymbolTable::getInstance().intern(key), value);
+  return (*this);
+}
+
+
+Request& Request::with(const Symbol& key, const KeyValueMap::mapped_type& value) {
   insertParam(key, value);
   return (*this);
 }
@@ -68,47 +89,68 @@ Request& Request::with(const KeyValueMap::key_type& key, const KeyValueMap::mapp
 KeyValueMap::mapped_type Request::operator[] (const KeyValueMap::key_type& key) const {
   KeyValueMap::mapped_type defaultValue;
 
-  KeyValueMap::const_iterator itFound(params_.find(key));
+  const ParamMap& params(getParams());
+  ParamMap::const_iterator itFound(params.find(key));
 
-  if (itFound == params_.end()) {
+  if (itFound == params.end()) {
     return (defaultValue);
   }
 
-  return (itFound->second);
+  return (itFound->second.str());
 }
 
 
 void Request::eraseParam(const KeyValueMap::key_type& key) {
-  KeyValueMap::iterator itFound(params_.find(key));
-
-  if (itFound != params_.end()) {
-    params_.erase(itFound);
+  if (params_.find(key) != params_.end()) {
+    params_.erase(key);
+    invalidateQuery();
   }
 }
 
 
 bool Request::hasParam(const KeyValueMap::key_type& key) const {
-  KeyValueMap::const_iterator itFound(params_.find(key));
+  const ParamMap& params(getParams());
 
-  return (itFound != params_.end());
+  return (params.find(key) != params.end());
 }
 
 
-const KeyValueMap& Request::getParams() const {
+const ParamMap& Request::getParams() const {
   return (params_);
 }
 
 
+const std::string& Request::getEncodedQuery() const {
+  if (QUERY_READY != queryState_.load(std::memory_order_acquire)) {
+    buildQuery();
+  }
+
+  return (encodedQuery_);
+}
+
+
+std::uint64_t Request::getFingerprint() const {
+  if (QUERY_READY != queryState_.load(std::memory_order_acquire)) {
+    buildQuery();
+  }
+
+  return (fingerprint_);
+}
+
+
 void Request::clear() {
   params_.clear();
+  invalidateQuery();
 }
 
 
 std::ostream& Request::print(std::ostream& os) const {
   // key=val|...|
 
-  for (KeyValueMap::const_iterator it = params_.begin();
-       it != params_.end();
+  const ParamMap& params(getParams());
+
+  for (ParamMap::const_iterator it = params.begin();
+       it != params.end();
        ++it) {
     os << it->first << "=" << it->second
        << "|";
@@ -118,13 +160,157 @@ std::ostream& Request::print(std::ostream& os) const {
 }
 
 
-void Request::setParams(const KeyValueMap& params) {
+void Request::setParams(const ParamMap& params) {
   params_ = params;
+  invalidateQuery();
 }
 
 
-void Request::insertParam(const KeyValueMap::key_type& key, const KeyValueMap::mapped_type& value) {
-  params_[key] = value;
+void Request::setParams(const Request& request) {
+  params_ = request.getParams();
+
+  if (&request.getParams() == &request.params_) {
+    copyQuery(request);
+
+  } else {
+    // request refers to other parameters, take its merged query
+    encodedQuery_ = request.getEncodedQuery();
+    fingerprint_ = request.getFingerprint();
+    queryState_.store(QUERY_READY, std::memory_order_relaxed);
+  }
+
+  onParamsChange();
+}
+
+
+void Request::setOwnParams(const Request& request) {
+  params_ = request.params_;
+  copyQuery(request);
+  onParamsChange();
+}
+
+
+void Request::onParamsChange() {
+}
+
+
+void Request::insertParam(const Symbol& key, const KeyValueMap::mapped_type& value) {
+  ParamMap::iterator itFound(params_.find(key));
+
+  if (itFound != params_.end()) {
+    if (!itFound->second.equals(value.data(), value.size())) {
+      itFound->second.assign(value.data(), value.size());
+      invalidateQuery();
+    }
+    return;
+  }
+
+  ParamMap::iterator itAdded(params_.set(key, value.data(), value.size()).first);
+
+  if (QUERY_READY == queryState_.load(std::memory_order_relaxed)) {
+    insertQuerySegment(itAdded);
+
+  } else {
+    onParamsChange();
+  }
+}
+
+
+void Request::insertQuerySegment(ParamMap::const_iterator itParam) {
+  // segments follow the parameter order; append the new one and rotate it
+  // in front of the segment of the next parameter
+
+  std::size_t pos(encodedQuery_.size());
+
+  if (std::next(itParam) != params_.end()) {
+    std::size_t index(itParam - params_.begin());
+
+    pos = 0;
+    for (std::size_t n = 0; n < index; ++n) {
+      pos = encodedQuery_.find('&', pos) + 1;
+    }
+  }
+
+  std::size_t end(encodedQuery_.size());
+
+  if (pos == end) {
+    if (!encodedQuery_.empty()) {
+      encodedQuery_.append(1, '&');
+    }
+    appendQueryParam(encodedQuery_, *itParam);
+
+  } else {
+    appendQueryParam(encodedQuery_, *itParam);
+    encodedQuery_.append(1, '&');
+
+    std::rotate(encodedQuery_.begin() + pos, encodedQuery_.begin() + end, encodedQuery_.end());
+  }
+
+  fingerprint_ = fingerprint64(encodedQuery_.data(), encodedQuery_.size());
+
+  onParamsChange();
+}
+
+
+void Request::buildQuery() const {
+  int state(QUERY_STALE);
+
+  if (!queryState_.compare_exchange_strong(state, QUERY_BUILDING, std::memory_order_acquire)) {
+    // another thread is building it
+    while (QUERY_READY != queryState_.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    return;
+  }
+
+  encodedQuery_.clear();
+
+  for (ParamMap::const_iterator it = params_.begin();
+       it != params_.end();
+       ++it) {
+    if (it != params_.begin()) {
+      encodedQuery_.append(1, '&');
+    }
+    appendQueryParam(encodedQuery_, *it);
+  }
+
+  fingerprint_ = fingerprint64(encodedQuery_.data(), encodedQuery_.size());
+
+  queryState_.store(QUERY_READY, std::memory_order_release);
+}
+
+
+void Request::copyQuery(const Request& other) {
+  if (QUERY_READY == other.queryState_.load(std::memory_order_acquire)) {
+    encodedQuery_ = other.encodedQuery_;
+    fingerprint_ = other.fingerprint_;
+    queryState_.store(QUERY_READY, std::memory_order_relaxed);
+
+  } else {
+    invalidateQuery();
+  }
+}
+
+
+void Request::invalidateQuery() {
+  queryState_.store(QUERY_STALE, std::memory_order_relaxed);
+  onParamsChange();
+}
+
+
+void Request::appendQueryParam(std::string& buf, const ParamMap::value_type& param) {
+  // names are matched case-insensitively, lower-case them so that the same
+  // parameters always produce the same query
+
+  const std::string& name(param.first.str());
+
+  for (std::string::const_iterator it = name.begin(); it != name.end(); ++it) {
+    char c(static_cast<char>(std::tolower(static_cast<unsigned char>(*it))));
+    appendPercentEncoded(buf, &c, 1);
+  }
+
+  buf.append(1, '=');
+  appendPercentEncoded(buf, param.second.data(), param.second.size());
 }
 
 
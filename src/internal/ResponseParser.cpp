@@ -0,0 +1,107 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#include <fredcpp/internal/ResponseParser.h>
+
+#include <fredcpp/ApiResponse.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace fredcpp {
+namespace internal {
+
+namespace {
+
+/// Incremental parsing state of a parser in the calling thread.
+
+struct ChunkState {
+  ChunkState()
+    : response(NULL)
+    , handler(NULL) {
+  }
+
+  ApiResponse* response;
+  ApiEntityHandler* handler;
+  std::string content;
+};
+
+ChunkState& getChunkState(const ResponseParser* parser) {
+  thread_local std::map<const ResponseParser*, ChunkState> states;
+  return (states[parser]);
+}
+
+} // namespace
+
+ResponseParser::ResponseParser() {
+}
+
+ResponseParser::~ResponseParser() {
+}
+
+bool ResponseParser::parseInPlace(char* content, std::size_t size, ApiResponse& response) {
+  std::istringstream contentStream(std::string(content, size));
+
+  return (parse(contentStream, response));
+}
+
+void ResponseParser::beginParse(ApiResponse& response, ApiEntityHandler* handler) {
+  ChunkState& state(getChunkState(this));
+
+  state.response = &response;
+  state.handler = handler;
+  state.content.clear();
+}
+
+bool ResponseParser::parseChunk(const char* content, std::size_t size) {
+  getChunkState(this).content.append(content, size);
+  return (true);
+}
+
+bool ResponseParser::endParse() {
+  ChunkState& state(getChunkState(this));
+
+  if (NULL == state.response) {
+    return (false);
+  }
+
+  ApiResponse& response(*state.response);
+  state.response = NULL;
+
+  bool result(parseInPlace(&state.content[0], state.content.size(), response));
+
+  if (result && NULL != state.handler) {
+    for (std::size_t n = 0; n < response.entities.size(); ++n) {
+      state.handler->onEntity(response.entities[n]);
+    }
+    response.entities.clear();
+  }
+
+  state.content.clear();
+
+  return (result);
+}
+
+} // namespace internal
+} // namespace fredcpp
@@ -0,0 +1,288 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp/internal/RetryPolicy.h>
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <thread>
+
+
+namespace fredcpp {
+namespace internal {
+
+const unsigned RetryPolicy::DEFAULT_MAX_RETRIES(3);
+const unsigned long RetryPolicy::DEFAULT_INITIAL_DELAY_MILLIS(500UL);
+const unsigned long RetryPolicy::DEFAULT_MAX_DELAY_MILLIS(60000UL);
+const double RetryPolicy::DEFAULT_JITTER(0.5);
+
+
+namespace {
+
+/// Upper limit of `Retry-After` delay-seconds, longer delays are clamped.
+const unsigned long MAX_RETRY_AFTER_SECS(7UL * 24 * 3600);
+
+
+/// Uniform random number in [0, 1), the generator is per thread.
+
+double random01() {
+  thread_local std::mt19937 generator(static_cast<std::mt19937::result_type>(
+      std::random_device()() ^ std::hash<std::thread::id>()(std::this_thread::get_id())));
+
+  return (std::uniform_real_distribution<double>(0.0, 1.0)(generator));
+}
+
+
+/// Days since 1970-01-01 of a proleptic Gregorian date.
+
+long daysFromCivil(long y, long m, long d) {
+  y -= (m <= 2);
+  long era((y >= 0 ? y : y - 399) / 400);
+  long yoe(y - era * 400);
+  long doy((153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1);
+  long doe(yoe * 365 + yoe / 4 - yoe / 100 + doy);
+
+  return (era * 146097 + doe - 719468);
+}
+
+
+/// Parses IMF-fixdate, e.g. `Sun, 06 Nov 1994 08:49:37 GMT`, as seconds since the epoch.
+
+bool parseHttpDate(const std::string& value, long long& secs) {
+  static const char* MONTHS("JanFebMarAprMayJunJulAugSepOctNovDec");
+
+  int day(0), year(0), hour(0), minute(0), second(0);
+  char month[4] = "";
+  char zone[4] = "";
+
+  if (7 != std::sscanf(value.c_str(), "%*3s, %2d %3s %4d %2d:%2d:%2d %3s",
+                       &day, month, &year, &hour, &minute, &second, zone)
+      || 0 != std::strcmp(zone, "GMT")
+      || 3 != std::strlen(month)) {
+    return (false);
+  }
+
+  const char* found(std::strstr(MONTHS, month));
+
+  if (NULL == found || 0 != (found - MONTHS) % 3
+      || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+    return (false);
+  }
+
+  long m(static_cast<long>(found - MONTHS) / 3 + 1);
+
+  secs = daysFromCivil(year, m, day) * 86400LL + hour * 3600LL + minute * 60LL + second;
+
+  return (true);
+}
+
+} // namespace
+
+//______________________________________________________________________________
+
+RetryPolicy::RetryPolicy()
+  : maxRetries_(DEFAULT_MAX_RETRIES)
+  , initialDelayMillis_(DEFAULT_INITIAL_DELAY_MILLIS)
+  , maxDelayMillis_(DEFAULT_MAX_DELAY_MILLIS)
+  , jitter_(DEFAULT_JITTER)
+  , deadlineMillis_(0UL) {
+}
+
+
+RetryPolicy::~RetryPolicy() {
+}
+
+
+RetryPolicy& RetryPolicy::withMaxRetries(unsigned count) {
+  maxRetries_ = count;
+  return (*this);
+}
+
+
+RetryPolicy& RetryPolicy::withInitialDelay(unsigned long millis) {
+  initialDelayMillis_ = millis;
+  return (*this);
+}
+
+
+RetryPolicy& RetryPolicy::withMaxDelay(unsigned long millis) {
+  maxDelayMillis_ = millis;
+  return (*this);
+}
+
+
+RetryPolicy& RetryPolicy::withJitter(double ratio) {
+  jitter_ = (ratio < 0.0 ? 0.0 : (ratio > 1.0 ? 1.0 : ratio));
+  return (*this);
+}
+
+
+RetryPolicy& RetryPolicy::withDeadline(unsigned long millis) {
+  deadlineMillis_ = millis;
+  return (*this);
+}
+
+
+unsigned RetryPolicy::getMaxRetries() const {
+  return (maxRetries_);
+}
+
+
+unsigned long RetryPolicy::getInitialDelay() const {
+  return (initialDelayMillis_);
+}
+
+
+unsigned long RetryPolicy::getMaxDelay() const {
+  return (maxDelayMillis_);
+}
+
+
+double RetryPolicy::getJitter() const {
+  return (jitter_);
+}
+
+
+unsigned long RetryPolicy::getDeadline() const {
+  return (deadlineMillis_);
+}
+
+
+bool RetryPolicy::isRetryableStatus(HttpResponse::HttpStatus status) const {
+  // server errors other than the permanent ones
+
+  return (HttpResponse::HTTP_TOO_MANY_REQUESTS == status
+          || HttpResponse::HTTP_REQUEST_TIMEOUT == status
+          || HttpResponse::HTTP_INTERNAL_SERVER_ERROR == status
+          || HttpResponse::HTTP_BAD_GATEWAY == status
+          || HttpResponse::HTTP_SERVICE_UNAVAILABLE == status
+          || HttpResponse::HTTP_GATEWAY_TIMEOUT == status);
+}
+
+
+unsigned long RetryPolicy::getDelayMillis(unsigned retry, const HttpResponse& response) const {
+  // initial delay doubled by each next retry, up to the maximum
+
+  unsigned long delay(initialDelayMillis_ < maxDelayMillis_ ? initialDelayMillis_ : maxDelayMillis_);
+
+  for (unsigned n = 1; n < retry && delay < maxDelayMillis_; ++n) {
+    delay = (delay > maxDelayMillis_ / 2 ? maxDelayMillis_ : delay * 2);
+  }
+
+  if (jitter_ > 0.0) {
+    delay -= static_cast<unsigned long>(delay * jitter_ * random01());
+  }
+
+  std::string retryAfter(response.getHeader("Retry-After"));
+  unsigned long retryAfterMillis(0);
+
+  if (!retryAfter.empty()
+      && parseRetryAfter(retryAfter, std::time(NULL), retryAfterMillis)
+      && retryAfterMillis > delay) {
+    delay = retryAfterMillis;
+  }
+
+  return (delay);
+}
+
+
+bool RetryPolicy::nextRetry(unsigned retry, unsigned long long elapsedMillis, const HttpResponse& response, unsigned long& delayMillis) const {
+  delayMillis = 0;
+
+  if (retry > maxRetries_) {
+    return (false);
+  }
+
+  unsigned long delay(getDelayMillis(retry, response));
+
+  // server asks to wait longer than allowed
+  if (delay > maxDelayMillis_) {
+    return (false);
+  }
+
+  if (deadlineMillis_ && elapsedMillis + delay >= deadlineMillis_) {
+    return (false);
+  }
+
+  delayMillis = delay;
+  return (true);
+}
+
+
+unsigned long RetryPolicy::getRemainingMillis(unsigned long long elapsedMillis) const {
+  if (!deadlineMillis_) {
+    return (0);
+  }
+
+  return (elapsedMillis < deadlineMillis_
+          ? static_cast<unsigned long>(deadlineMillis_ - elapsedMillis)
+          : 1UL);
+}
+
+
+bool RetryPolicy::parseRetryAfter(const std::string& value, std::time_t now, unsigned long& delayMillis) {
+  if (value.empty()) {
+    return (false);
+  }
+
+  // delay-seconds
+
+  if (std::string::npos == value.find_first_not_of("0123456789")) {
+    unsigned long secs(0);
+
+    for (std::size_t n = 0; n < value.size() && secs < MAX_RETRY_AFTER_SECS; ++n) {
+      secs = secs * 10 + (value[n] - '0');
+    }
+
+    delayMillis = (secs < MAX_RETRY_AFTER_SECS ? secs : MAX_RETRY_AFTER_SECS) * 1000UL;
+    return (true);
+  }
+
+  // HTTP-date, past date means no delay
+
+  long long dateSecs(0);
+
+  if (!parseHttpDate(value, dateSecs)) {
+    return (false);
+  }
+
+  long long secs(dateSecs - static_cast<long long>(now));
+
+  if (secs < 0) {
+    secs = 0;
+  }
+
+  if (secs > static_cast<long long>(MAX_RETRY_AFTER_SECS)) {
+    secs = MAX_RETRY_AFTER_SECS;
+  }
+
+  delayMillis = static_cast<unsigned long>(secs) * 1000UL;
+  return (true);
+}
+
+
+} // namespace internal
+} // namespace fredcpp
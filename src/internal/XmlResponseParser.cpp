@@ -33,5 +33,9 @@ XmlResponseParser::XmlResponseParser() {
 XmlResponseParser::~XmlResponseParser() {
 }
 
+bool XmlResponseParser::accepts(const std::string& contentType) const {
+  return (std::string::npos != contentType.find("text/xml"));
+}
+
 } // namespace internal
 } // namespace fredcpp
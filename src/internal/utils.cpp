@@ -27,12 +27,20 @@
 
 #ifdef _WIN32
 #include <windows.h>
+#include <direct.h>
+#include <errno.h>
 
 #else
 #include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
 
 #endif  // _WIN32
 
+#include <cstring>
+
 
 namespace fredcpp {
 namespace internal {
@@ -48,5 +56,165 @@ void sleep(unsigned secs) {
 }
 
 
+void sleepMillis(unsigned long millis) {
+
+#ifdef _WIN32
+  Sleep(millis);
+#else
+  struct timespec ts;
+  ts.tv_sec = static_cast<time_t>(millis / 1000UL);
+  ts.tv_nsec = static_cast<long>(millis % 1000UL) * 1000000L;
+
+  while (-1 == nanosleep(&ts, &ts) && EINTR == errno) {
+    // interrupted, sleep the remaining time
+  }
+#endif  // _WIN32
+
+}
+
+
+unsigned long long monotonicMillis() {
+
+#ifdef _WIN32
+  return (GetTickCount64());
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (static_cast<unsigned long long>(ts.tv_sec) * 1000ULL
+          + static_cast<unsigned long long>(ts.tv_nsec) / 1000000ULL);
+#endif  // _WIN32
+
+}
+
+
+unsigned long long monotonicMicros() {
+
+#ifdef _WIN32
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+
+  return (static_cast<unsigned long long>(counter.QuadPart / frequency.QuadPart) * 1000000ULL
+          + static_cast<unsigned long long>(counter.QuadPart % frequency.QuadPart) * 1000000ULL
+            / static_cast<unsigned long long>(frequency.QuadPart));
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (static_cast<unsigned long long>(ts.tv_sec) * 1000000ULL
+          + static_cast<unsigned long long>(ts.tv_nsec) / 1000ULL);
+#endif  // _WIN32
+
+}
+
+
+
+bool makeDirectory(const std::string& path) {
+
+#ifdef _WIN32
+  return (0 == _mkdir(path.c_str()) || EEXIST == errno);
+#else
+  return (0 == mkdir(path.c_str(), 0755) || EEXIST == errno);
+#endif  // _WIN32
+
+}
+
+
+namespace {
+
+/// Unreserved URI characters, a bit per byte value.
+const unsigned long long URI_UNRESERVED[4] = {
+  0x03FF600000000000ULL,    // - . 0-9
+  0x47FFFFFE87FFFFFEULL,    // A-Z _ a-z ~
+  0ULL,
+  0ULL
+};
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+
+inline bool isUnreservedURIChar(unsigned char c) {
+  return (0 != ((URI_UNRESERVED[c >> 6] >> (c & 63)) & 1ULL));
+}
+
+
+const std::uint64_t FINGERPRINT_MUL1(0x9E3779B97F4A7C15ULL);
+const std::uint64_t FINGERPRINT_MUL2(0xC2B2AE3D27D4EB4FULL);
+
+
+inline std::uint64_t mixWord(std::uint64_t word) {
+  word *= FINGERPRINT_MUL2;
+  word ^= word >> 31;
+  return (word * FINGERPRINT_MUL1);
+}
+
+} // namespace
+
+
+std::string percentEncode(const std::string& value) {
+  std::string result;
+  result.reserve(value.size());
+
+  appendPercentEncoded(result, value);
+
+  return (result);
+}
+
+
+void appendPercentEncoded(std::string& buf, const std::string& value) {
+  appendPercentEncoded(buf, value.data(), value.size());
+}
+
+
+void appendPercentEncoded(std::string& buf, const char* data, std::size_t size) {
+  const char* run(data);
+  const char* end(data + size);
+
+  for (const char* it = run; it != end; ++it) {
+    unsigned char c(static_cast<unsigned char>(*it));
+
+    if (isUnreservedURIChar(c)) {
+      continue;
+    }
+
+    const char encoded[3] = { '%', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF] };
+
+    buf.append(run, it - run).append(encoded, 3);
+    run = it + 1;
+  }
+
+  buf.append(run, end - run);
+}
+
+
+std::uint64_t fingerprint64(const char* data, std::size_t size, std::uint64_t seed) {
+  // a word at a time, then the tail, then the final avalanche
+
+  std::uint64_t hash(seed ^ (size * FINGERPRINT_MUL1));
+
+  for (; size >= 8; data += 8, size -= 8) {
+    std::uint64_t word(0);
+    std::memcpy(&word, data, 8);
+
+    hash = (hash ^ mixWord(word)) * FINGERPRINT_MUL2;
+    hash ^= hash >> 29;
+  }
+
+  if (size) {
+    std::uint64_t word(0);
+    std::memcpy(&word, data, size);
+
+    hash = (hash ^ mixWord(word)) * FINGERPRINT_MUL2;
+  }
+
+  hash ^= hash >> 33;
+  hash *= FINGERPRINT_MUL1;
+  hash ^= hash >> 29;
+
+  return (hash);
+}
+
 } // namespace fredcpp
 } // namespace internal
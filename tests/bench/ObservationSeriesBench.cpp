@@ -0,0 +1,267 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-bench.h>
+
+#include <fredcpp/ObservationSeries.h>
+#include <fredcpp/ApiResponse.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+using namespace fredcpp;
+using namespace fredcpp::bench;
+
+const std::size_t OBSERVATION_COUNT(100000);
+
+
+/// Observations response with daily observations, every 20th value missing.
+const ApiResponse& getObservations() {
+  static ApiResponse response;
+
+  if (response.entities.empty()) {
+    unsigned seed(12345);
+    int firstDay(ObservationSeries::toDayNumber("1950-01-01"));
+
+    response.entities.resize(OBSERVATION_COUNT);
+
+    for (std::size_t n = 0; n < OBSERVATION_COUNT; ++n) {
+      seed = seed * 1103515245 + 12345;
+
+      char value[32];
+      std::snprintf(value, sizeof(value), "%u.%04u", (seed >> 8) % 10000, (seed >> 4) % 10000);
+
+      ApiEntity& entity(response.entities[n]);
+      entity.name = "observation";
+      entity.attributes["realtime_start"] = "2014-05-02";
+      entity.attributes["realtime_end"] = "2014-05-02";
+      entity.attributes["date"] = ObservationSeries::toDateString(firstDay + static_cast<int>(n));
+      entity.attributes["value"] = (0 == n % 20 ? "." : value);
+    }
+  }
+
+  return (response);
+}
+
+
+/// Column of the attribute values.
+std::vector<std::string> getColumn(const std::string& name) {
+  const ApiResponse& response(getObservations());
+
+  std::vector<std::string> column;
+  column.reserve(response.entities.size());
+
+  for (std::size_t n = 0; n < response.entities.size(); ++n) {
+    column.push_back(response.entities[n].attribute(name));
+  }
+
+  return (column);
+}
+
+//______________________________________________________________________________
+
+class ColumnBenchmark : public Benchmark {
+public:
+  ColumnBenchmark(const std::string& name, const std::string& attribute)
+    : Benchmark(name, OBSERVATION_COUNT)
+    , attribute_(attribute) {
+  }
+
+  void setUp() {
+    column_ = getColumn(attribute_);
+  }
+
+protected:
+  std::string attribute_;
+  std::vector<std::string> column_;
+};
+
+
+class StrtodValues : public ColumnBenchmark {
+public:
+  explicit StrtodValues(const std::string& name) : ColumnBenchmark(name, "value") {}
+
+  void run() {
+    double sum(0);
+    for (std::size_t n = 0; n < column_.size(); ++n) {
+      sum += std::strtod(column_[n].c_str(), NULL);
+    }
+    keep(sum);
+  }
+};
+
+
+class ToValue : public ColumnBenchmark {
+public:
+  explicit ToValue(const std::string& name) : ColumnBenchmark(name, "value") {}
+
+  void run() {
+    double sum(0);
+    for (std::size_t n = 0; n < column_.size(); ++n) {
+      sum += ObservationSeries::toValue(column_[n]);
+    }
+    keep(sum);
+  }
+};
+
+
+class StreamDates : public ColumnBenchmark {
+public:
+  explicit StreamDates(const std::string& name) : ColumnBenchmark(name, "date") {}
+
+  void run() {
+    double sum(0);
+    for (std::size_t n = 0; n < column_.size(); ++n) {
+      std::istringstream is(column_[n]);
+      int y(0), m(0), d(0);
+      char dash;
+      is >> y >> dash >> m >> dash >> d;
+      sum += y * 372 + m * 31 + d;
+    }
+    keep(sum);
+  }
+};
+
+
+class ToDayNumber : public ColumnBenchmark {
+public:
+  explicit ToDayNumber(const std::string& name) : ColumnBenchmark(name, "date") {}
+
+  void run() {
+    double sum(0);
+    for (std::size_t n = 0; n < column_.size(); ++n) {
+      sum += ObservationSeries::toDayNumber(column_[n]);
+    }
+    keep(sum);
+  }
+};
+
+//______________________________________________________________________________
+
+class EntityBenchmark : public Benchmark {
+public:
+  explicit EntityBenchmark(const std::string& name)
+    : Benchmark(name, OBSERVATION_COUNT) {
+  }
+
+  void setUp() {
+    getObservations();
+  }
+};
+
+
+class AttributeStrtod : public EntityBenchmark {
+public:
+  explicit AttributeStrtod(const std::string& name) : EntityBenchmark(name) {}
+
+  void run() {
+    const std::vector<ApiEntity>& entities(getObservations().entities);
+    double sum(0);
+    for (std::size_t n = 0; n < entities.size(); ++n) {
+      sum += std::strtod(entities[n].attribute("value").c_str(), NULL);
+    }
+    keep(sum);
+  }
+};
+
+
+class ToValues : public EntityBenchmark {
+public:
+  explicit ToValues(const std::string& name) : EntityBenchmark(name) {}
+
+  void run() {
+    ObservationSeries::toValues(getObservations().entities, "value", values_);
+    keep(values_[1]);
+  }
+
+private:
+  std::vector<double> values_;
+};
+
+
+class ToDayNumbers : public EntityBenchmark {
+public:
+  explicit ToDayNumbers(const std::string& name) : EntityBenchmark(name) {}
+
+  void run() {
+    ObservationSeries::toDayNumbers(getObservations().entities, "date", days_);
+    keep(days_[1]);
+  }
+
+private:
+  std::vector<ObservationSeries::DayNumber> days_;
+};
+
+
+class OnEntity : public EntityBenchmark {
+public:
+  explicit OnEntity(const std::string& name) : EntityBenchmark(name) {}
+
+  void run() {
+    const std::vector<ApiEntity>& entities(getObservations().entities);
+    series_.clear();
+    for (std::size_t n = 0; n < entities.size(); ++n) {
+      series_.onEntity(entities[n]);
+    }
+    keep(series_.value(1));
+  }
+
+private:
+  ObservationSeries series_;
+};
+
+
+class Assign : public EntityBenchmark {
+public:
+  explicit Assign(const std::string& name) : EntityBenchmark(name) {}
+
+  void run() {
+    series_.assign(getObservations());
+    keep(series_.value(1));
+  }
+
+private:
+  ObservationSeries series_;
+};
+
+} // namespace
+
+
+FREDCPP_BENCHMARK(StrtodValues, ("observations/value/strtod"));
+FREDCPP_BENCHMARK(ToValue, ("observations/value/toValue"));
+FREDCPP_BENCHMARK(AttributeStrtod, ("observations/value/attribute+strtod"));
+FREDCPP_BENCHMARK(ToValues, ("observations/value/toValues"));
+
+FREDCPP_BENCHMARK(StreamDates, ("observations/date/istringstream"));
+FREDCPP_BENCHMARK(ToDayNumber, ("observations/date/toDayNumber"));
+FREDCPP_BENCHMARK(ToDayNumbers, ("observations/date/toDayNumbers"));
+
+FREDCPP_BENCHMARK(OnEntity, ("observations/series/onEntity"));
+FREDCPP_BENCHMARK(Assign, ("observations/series/assign"));
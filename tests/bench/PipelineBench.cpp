@@ -0,0 +1,486 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-bench.h>
+
+#include <fredcpp/Api.h>
+#include <fredcpp/ApiLog.h>
+#include <fredcpp/ApiRequestBuilder.h>
+#include <fredcpp/ApiResponse.h>
+#include <fredcpp/ApiResponseCache.h>
+#include <fredcpp/internal/HttpRequest.h>
+#include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/utils.h>
+
+#include <fredcpp/external/CurlHttpClient.h>
+#include <fredcpp/external/PugiXmlParser.h>
+#include <fredcpp/external/SimpleLogger.h>
+
+#include <curl/curl.h>
+
+#include <memory>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+using namespace fredcpp;
+using namespace fredcpp::bench;
+
+
+/// `cURL` client replaying a recorded payload instead of a transfer.
+/// Prepares the request string the same way as a real transfer does.
+
+class PayloadHttpClient : public external::CurlHttpClient {
+public:
+  static PayloadHttpClient& getInstance() {
+    static PayloadHttpClient instance;
+    return (instance);
+  }
+
+  PayloadHttpClient& withPayload(const std::string& payload) {
+    payload_ = &payload;
+    return (*this);
+  }
+
+  bool execute(const internal::HttpRequest& request, internal::HttpResponse& response) {
+    response.clear();
+
+    keep(static_cast<double>(getRequestString(request).size()));
+
+    response.setHttpStatus(internal::HttpResponse::HTTP_OK);
+    response.setContentType("text/xml; charset=UTF-8");
+    response.appendContent(payload_->data(), payload_->size());
+
+    return (true);
+  }
+
+  std::string requestString(const internal::HttpRequest& request) {
+    return (getRequestString(request));
+  }
+
+private:
+  PayloadHttpClient()
+    : payload_(NULL) {
+  }
+
+  const std::string* payload_;
+};
+
+
+/// Stream buffer discarding the output.
+class NullBuffer : public std::streambuf {
+protected:
+  int_type overflow(int_type c) {
+    return (traits_type::not_eof(c));
+  }
+
+  std::streamsize xsputn(const char*, std::streamsize n) {
+    return (n);
+  }
+};
+
+
+/// SimpleLogger writing INFO to a discarding stream, when enabled.
+external::SimpleLogger& getLogger(bool infoEnabled) {
+  static NullBuffer nullBuffer;
+  static std::ostream nullStream(&nullBuffer);
+
+  external::SimpleLogger& logger(external::SimpleLogger::getInstance());
+  logger.setOutput(internal::LogLevel::LOG_INFO, nullStream);
+  logger.setOutput(internal::LogLevel::LOG_DEBUG, nullStream);
+  logger.disableDebug();
+  logger.stopAsync();
+
+  if (infoEnabled) {
+    logger.enableInfo();
+  } else {
+    logger.disableInfo();
+  }
+
+  ApiLog::configure().withLogger(&logger);
+
+  return (logger);
+}
+
+
+FredSeriesObservationsRequest getObservationsRequest() {
+  return (ApiRequestBuilder::SeriesObservations("DEXUSEU")
+            .withStart("1950-01-01")
+            .withEnd("2014-03-14")
+            .withUnits("lin")
+            .withSort("asc"));
+}
+
+
+std::string sizeName(const std::string& name, std::size_t count) {
+  std::ostringstream buf;
+  buf << name << "/observations=" << count;
+  return (buf.str());
+}
+
+//______________________________________________________________________________
+
+class ApiGet : public Benchmark {
+public:
+  explicit ApiGet(std::size_t count)
+    : Benchmark(sizeName("Api::get", count))
+    , count_(count) {
+  }
+
+  void setUp() {
+    PayloadHttpClient::getInstance().withPayload(getObservationsPayload(count_));
+
+    api_.withExecutor(PayloadHttpClient::getInstance())
+        .withParser(external::PugiXmlParser::getInstance())
+        .withLogger(getLogger(false))
+        .withKey("0123456789abcdef0123456789abcdef");
+
+    response_.setRecycling(true);
+  }
+
+  void run() {
+    api_.get(getObservationsRequest(), response_);
+    keep(static_cast<double>(response_.entities.size()));
+  }
+
+private:
+  std::size_t count_;
+  Api api_;
+  ApiResponse response_;
+};
+
+
+class PugiXmlParse : public Benchmark {
+public:
+  explicit PugiXmlParse(std::size_t count)
+    : Benchmark(sizeName("PugiXmlParser::parse", count))
+    , count_(count) {
+  }
+
+  void setUp() {
+    getLogger(false);
+    response_.setRecycling(true);
+  }
+
+  void run() {
+    response_.clear();
+
+    std::istringstream xml(getObservationsPayload(count_));
+    external::PugiXmlParser::getInstance().parse(xml, response_);
+    keep(static_cast<double>(response_.entities.size()));
+  }
+
+private:
+  std::size_t count_;
+  ApiResponse response_;
+};
+
+
+class ApiResponseClear : public Benchmark {
+public:
+  ApiResponseClear(std::size_t count, bool recycling)
+    : Benchmark(sizeName(recycling ? "ApiResponse::clear+recycling" : "ApiResponse::clear", count))
+    , count_(count) {
+    response_.setRecycling(recycling);
+  }
+
+  void setUp() {
+    getLogger(false);
+
+    std::istringstream xml(getObservationsPayload(count_));
+    external::PugiXmlParser::getInstance().parse(xml, filled_);
+  }
+
+  bool prepare() {
+    response_.result = filled_.result;
+
+    for (std::size_t n = 0; n < filled_.entities.size(); ++n) {
+      response_.appendEntity() = filled_.entities[n];
+    }
+
+    return (true);
+  }
+
+  void run() {
+    response_.clear();
+  }
+
+private:
+  std::size_t count_;
+  ApiResponse filled_;
+  ApiResponse response_;
+};
+
+
+class GetRequestString : public Benchmark {
+public:
+  explicit GetRequestString(const std::string& name)
+    : Benchmark(name) {
+  }
+
+  void setUp() {
+    request_ = internal::HttpRequest("https://api.stlouisfed.org/fred/series/observations",
+                                     getObservationsRequest());
+    request_.with("api_key", "0123456789abcdef0123456789abcdef");
+  }
+
+  void run() {
+    keep(static_cast<double>(PayloadHttpClient::getInstance().requestString(request_).size()));
+  }
+
+private:
+  internal::HttpRequest request_;
+};
+
+
+/// Building a request and the HTTP request sent for it, as Api does;
+/// either referring to the request or copying it.
+class BuildHttpRequest : public Benchmark {
+public:
+  BuildHttpRequest(const std::string& name, bool refer)
+    : Benchmark(name)
+    , refer_(refer)
+    , URI_("https://api.stlouisfed.org/fred/series/observations")
+    , apiKey_("0123456789abcdef0123456789abcdef") {
+  }
+
+  void run() {
+    FredSeriesObservationsRequest request(getObservationsRequest());
+    internal::HttpRequest httpRequest;
+
+    if (refer_) {
+      httpRequest.withURIRef(URI_)
+                 .withParamsRef(request);
+    } else {
+      httpRequest.withURI(URI_)
+                 .withParams(request);
+    }
+
+    httpRequest.with("api_key", apiKey_);
+    keep(static_cast<double>(httpRequest.getURI().size()));
+  }
+
+private:
+  bool refer_;
+  std::string URI_;
+  std::string apiKey_;
+};
+
+
+/// Lookup of a polled request among many cached responses.
+class ApiResponseCacheFind : public Benchmark {
+public:
+  ApiResponseCacheFind(const std::string& name, std::size_t count)
+    : Benchmark(name)
+    , count_(count)
+    , request_(getObservationsRequest()) {
+  }
+
+  void setUp() {
+    ApiResponsePtr response(std::make_shared<const ApiResponse>());
+
+    for (std::size_t n = 0; n < count_; ++n) {
+      std::ostringstream seriesId;
+      seriesId << "SERIES" << n;
+
+      cache_.insert(ApiRequestBuilder::SeriesObservations(seriesId.str()), response);
+    }
+
+    cache_.insert(request_, response);
+  }
+
+  void run() {
+    keep(cache_.find(request_) ? 1.0 : 0.0);
+  }
+
+private:
+  std::size_t count_;
+  ApiResponseCache cache_;
+  FredSeriesObservationsRequest request_;
+};
+
+
+/// Query values of a typical observations request.
+const char* const QUERY_VALUES[] = {
+  "api_key", "0123456789abcdef0123456789abcdef", "series_id", "DEXUSEU",
+  "observation_start", "1950-01-01", "observation_end", "2014-03-14",
+  "units", "lin", "sort_order", "asc", "search_text", "money stock/M2"
+};
+
+const std::size_t QUERY_VALUE_COUNT(sizeof(QUERY_VALUES) / sizeof(QUERY_VALUES[0]));
+
+
+/// Encoding with a `cURL` handle per value, as `CurlHttpClient` used to.
+class CurlEscape : public Benchmark {
+public:
+  explicit CurlEscape(const std::string& name)
+    : Benchmark(name, QUERY_VALUE_COUNT) {
+  }
+
+  void run() {
+    for (std::size_t n = 0; n < QUERY_VALUE_COUNT; ++n) {
+      CURL* curl(curl_easy_init());
+      char* buf(curl_easy_escape(curl, QUERY_VALUES[n], 0));
+
+      keep(static_cast<double>(std::string(buf).size()));
+
+      curl_free(buf);
+      curl_easy_cleanup(curl);
+    }
+  }
+};
+
+
+class AppendPercentEncoded : public Benchmark {
+public:
+  explicit AppendPercentEncoded(const std::string& name)
+    : Benchmark(name, QUERY_VALUE_COUNT) {
+  }
+
+  void setUp() {
+    values_.assign(QUERY_VALUES, QUERY_VALUES + QUERY_VALUE_COUNT);
+    buf_.reserve(1024);
+  }
+
+  void run() {
+    buf_.clear();
+
+    for (std::size_t n = 0; n < values_.size(); ++n) {
+      internal::appendPercentEncoded(buf_, values_[n]);
+    }
+
+    keep(static_cast<double>(buf_.size()));
+  }
+
+private:
+  std::vector<std::string> values_;
+  std::string buf_;
+};
+
+
+class LogDisabled : public Benchmark {
+public:
+  explicit LogDisabled(const std::string& name)
+    : Benchmark(name) {
+  }
+
+  void setUp() {
+    getLogger(false);
+  }
+
+  void run() {
+    FREDCPP_LOG_DEBUG("request:" << "series/observations" << " status:" << 200);
+  }
+};
+
+
+/// Enabled INFO message, written by the logging thread or by the background
+/// writer when asynchronous; to a discarding stream or to a file.
+class LogEnabled : public Benchmark {
+public:
+  LogEnabled(const std::string& name, const std::string& path, bool async)
+    : Benchmark(name)
+    , path_(path)
+    , async_(async) {
+  }
+
+  void setUp() {
+    external::SimpleLogger& logger(getLogger(true));
+
+    if (!path_.empty()) {
+      logger.setOutput(internal::LogLevel::LOG_INFO, path_);
+    }
+
+    if (async_) {
+      logger.startAsync(external::SimpleLogger::DEFAULT_ASYNC_CAPACITY,
+                        external::SimpleLogger::OVERFLOW_BLOCK);
+    }
+  }
+
+  void run() {
+    FREDCPP_LOG_INFO("request:" << "series/observations" << " status:" << 200);
+  }
+
+private:
+  std::string path_;
+  bool async_;
+};
+
+
+
+/// Debug message of a large content above the allowed debug depth,
+/// as Api logs the response content.
+class LogDebugDepth : public Benchmark {
+public:
+  explicit LogDebugDepth(const std::string& name)
+    : Benchmark(name)
+    , content_(1024 * 1024, 'x') {
+  }
+
+  void setUp() {
+    getLogger(false).enableDebug();
+    ApiLog::getInstance().withDebugDepth(0);
+  }
+
+  void run() {
+    FREDCPP_LOG_DBGN(2, "content:{\n" << content_ << "\n}");
+  }
+
+private:
+  std::string content_;
+};
+
+} // namespace
+
+
+FREDCPP_BENCHMARK(ApiGet, (10));
+FREDCPP_BENCHMARK(ApiGet, (1000));
+FREDCPP_BENCHMARK(ApiGet, (100000));
+
+FREDCPP_BENCHMARK(PugiXmlParse, (10));
+FREDCPP_BENCHMARK(PugiXmlParse, (1000));
+FREDCPP_BENCHMARK(PugiXmlParse, (100000));
+
+FREDCPP_BENCHMARK(ApiResponseClear, (10, false));
+FREDCPP_BENCHMARK(ApiResponseClear, (1000, false));
+FREDCPP_BENCHMARK(ApiResponseClear, (100000, false));
+FREDCPP_BENCHMARK(ApiResponseClear, (100000, true));
+
+FREDCPP_BENCHMARK(GetRequestString, ("HttpRequestExecutor::getRequestString"));
+FREDCPP_BENCHMARK(BuildHttpRequest, ("HttpRequest/withParams", false));
+FREDCPP_BENCHMARK(BuildHttpRequest, ("HttpRequest/withParamsRef", true));
+FREDCPP_BENCHMARK(ApiResponseCacheFind, ("ApiResponseCache::find/entries=1000", 1000));
+FREDCPP_BENCHMARK(CurlEscape, ("encodeURI/curl_easy_escape"));
+FREDCPP_BENCHMARK(AppendPercentEncoded, ("encodeURI/appendPercentEncoded"));
+
+FREDCPP_BENCHMARK(LogDisabled, ("FREDCPP_LOG_DEBUG/disabled"));
+FREDCPP_BENCHMARK(LogEnabled, ("FREDCPP_LOG_INFO/enabled", "", false));
+FREDCPP_BENCHMARK(LogEnabled, ("FREDCPP_LOG_INFO/enabled-async", "", true));
+FREDCPP_BENCHMARK(LogEnabled, ("FREDCPP_LOG_INFO/file", "bench-log.tmp", false));
+FREDCPP_BENCHMARK(LogEnabled, ("FREDCPP_LOG_INFO/file-async", "bench-log.tmp", true));
+FREDCPP_BENCHMARK(LogDebugDepth, ("FREDCPP_LOG_DBGN/above-depth"));
@@ -0,0 +1,486 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-bench.h>
+#include <fredcpp-testutils.h>
+
+#include <fredcpp/ObservationSeries.h>
+#include <fredcpp/external/PugiXmlParser.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+
+
+//______________________________________________________________________________
+// Count heap allocations of the whole program
+
+namespace {
+
+std::atomic<unsigned long long> allocationCount(0);
+std::atomic<unsigned long long> allocationBytes(0);
+
+
+void* allocate(std::size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+  void* ptr(std::malloc(size ? size : 1));
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+
+  return (ptr);
+}
+
+
+// `pugixml` pages are allocated with its own functions, count them too
+
+void* allocatePugixml(std::size_t size) {
+  try {
+    return (allocate(size));
+  } catch (...) {
+    return (NULL);
+  }
+}
+
+
+void deallocatePugixml(void* ptr) {
+  std::free(ptr);
+}
+
+} // namespace
+
+
+void* operator new(std::size_t size) {
+  return (allocate(size));
+}
+
+
+void* operator new[](std::size_t size) {
+  return (allocate(size));
+}
+
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return (allocate(size));
+  } catch (...) {
+    return (NULL);
+  }
+}
+
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return (allocate(size));
+  } catch (...) {
+    return (NULL);
+  }
+}
+
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+//______________________________________________________________________________
+
+namespace fredcpp {
+namespace bench {
+
+
+Benchmark::Benchmark(const std::string& name, std::size_t itemCount)
+  : name_(name)
+  , itemCount_(itemCount) {
+}
+
+
+Benchmark::~Benchmark() {
+}
+
+
+const std::string& Benchmark::getName() const {
+  return (name_);
+}
+
+
+std::size_t Benchmark::getItemCount() const {
+  return (itemCount_);
+}
+
+
+void Benchmark::setUp() {
+}
+
+
+bool Benchmark::prepare() {
+  return (false);
+}
+
+//______________________________________________________________________________
+
+BenchmarkRegistry& BenchmarkRegistry::getInstance() {
+  static BenchmarkRegistry instance;
+  return (instance);
+}
+
+
+BenchmarkRegistry::BenchmarkRegistry() {
+}
+
+
+BenchmarkRegistry::~BenchmarkRegistry() {
+  for (std::vector<Benchmark*>::iterator it = benchmarks_.begin();
+       it != benchmarks_.end(); ++it) {
+    delete (*it);
+  }
+}
+
+
+void BenchmarkRegistry::add(Benchmark* benchmark) {
+  benchmarks_.push_back(benchmark);
+}
+
+
+const std::vector<Benchmark*>& BenchmarkRegistry::getBenchmarks() const {
+  return (benchmarks_);
+}
+
+//______________________________________________________________________________
+
+BenchmarkResult::BenchmarkResult()
+  : itemCount(0)
+  , runCount(0)
+  , nsPerOp(0)
+  , allocationsPerOp(0)
+  , bytesPerOp(0) {
+}
+
+
+AllocationStats::AllocationStats()
+  : allocations(0)
+  , bytes(0) {
+}
+
+
+AllocationStats getAllocationStats() {
+  AllocationStats stats;
+  stats.allocations = allocationCount.load(std::memory_order_relaxed);
+  stats.bytes = allocationBytes.load(std::memory_order_relaxed);
+
+  return (stats);
+}
+
+//______________________________________________________________________________
+
+namespace {
+
+volatile double keptValue(0);
+
+typedef std::chrono::steady_clock Clock;
+
+const int ROUNDS(5);
+const std::string RECORDED_OBSERVATIONS("data/response_series_observations_1.xml");
+
+
+double runTimed(Benchmark& benchmark, std::size_t runCount, bool prepared, double& wallTimeNs) {
+  Clock::time_point wallStart(Clock::now());
+
+  if (!prepared) {
+    for (std::size_t n = 0; n < runCount; ++n) {
+      benchmark.run();
+    }
+
+    wallTimeNs = std::chrono::duration<double, std::nano>(Clock::now() - wallStart).count();
+    return (wallTimeNs);
+  }
+
+  // time each run separately, leaving out the preparation
+  double elapsed(0);
+
+  for (std::size_t n = 0; n < runCount; ++n) {
+    benchmark.prepare();
+
+    Clock::time_point start(Clock::now());
+    benchmark.run();
+    elapsed += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  }
+
+  wallTimeNs = std::chrono::duration<double, std::nano>(Clock::now() - wallStart).count();
+  return (elapsed);
+}
+
+
+BenchmarkResult measure(Benchmark& benchmark, double minTimeNs) {
+  BenchmarkResult result;
+  result.name = benchmark.getName();
+  result.itemCount = benchmark.getItemCount();
+
+  benchmark.setUp();
+
+  // allocations of a single (warm) run
+  bool prepared(benchmark.prepare());
+  benchmark.run();
+
+  if (prepared) {
+    benchmark.prepare();
+  }
+
+  AllocationStats before(getAllocationStats());
+  benchmark.run();
+  AllocationStats after(getAllocationStats());
+
+  result.allocationsPerOp = static_cast<double>(after.allocations - before.allocations) / result.itemCount;
+  result.bytesPerOp = static_cast<double>(after.bytes - before.bytes) / result.itemCount;
+
+  // calibrate run count for a round to take about the minimum time
+  // (including preparation), then take the best of several rounds
+  std::size_t runCount(1);
+  double wallTime(0);
+  double elapsed(runTimed(benchmark, runCount, prepared, wallTime));
+
+  while (wallTime < minTimeNs / ROUNDS) {
+    runCount *= 2;
+    elapsed = runTimed(benchmark, runCount, prepared, wallTime);
+  }
+
+  double best(elapsed);
+  for (int round = 1; round < ROUNDS; ++round) {
+    double roundTime(runTimed(benchmark, runCount, prepared, wallTime));
+    if (roundTime < best) {
+      best = roundTime;
+    }
+  }
+
+  result.runCount = runCount;
+  result.nsPerOp = best / (static_cast<double>(runCount) * result.itemCount);
+
+  return (result);
+}
+
+
+void printTextHeader(std::ostream& os) {
+  os << std::left << std::setw(52) << "benchmark"
+     << std::right << std::setw(14) << "ns/op"
+     << std::setw(12) << "allocs/op"
+     << std::setw(14) << "bytes/op"
+     << std::setw(10) << "runs" << std::endl;
+}
+
+
+void printTextRow(std::ostream& os, const BenchmarkResult& result) {
+  os << std::left << std::setw(52) << result.name
+     << std::right << std::fixed << std::setprecision(2)
+     << std::setw(14) << result.nsPerOp
+     << std::setw(12) << result.allocationsPerOp
+     << std::setw(14) << result.bytesPerOp
+     << std::setw(10) << result.runCount << std::endl;
+}
+
+
+void printJson(std::ostream& os, const std::vector<BenchmarkResult>& results) {
+  // benchmark names contain no characters to escape
+  os << "{" << std::endl
+     << "  \"benchmarks\": [" << std::endl;
+
+  for (std::vector<BenchmarkResult>::const_iterator it = results.begin();
+       it != results.end(); ++it) {
+    os << "    {"
+       << "\"name\": \"" << it->name << "\", "
+       << std::fixed << std::setprecision(3)
+       << "\"ns_per_op\": " << it->nsPerOp << ", "
+       << "\"allocs_per_op\": " << it->allocationsPerOp << ", "
+       << "\"bytes_per_op\": " << it->bytesPerOp << ", "
+       << "\"items_per_run\": " << it->itemCount << ", "
+       << "\"runs\": " << it->runCount
+       << "}" << (it + 1 != results.end() ? "," : "") << std::endl;
+  }
+
+  os << "  ]" << std::endl
+     << "}" << std::endl;
+}
+
+
+bool readOption(const std::string& arg, const std::string& name, std::string& value) {
+  if (0 != arg.compare(0, name.size(), name)) {
+    return (false);
+  }
+
+  value = arg.substr(name.size());
+  return (true);
+}
+
+} // namespace
+
+
+void keep(double value) {
+  keptValue = keptValue + value;
+}
+
+
+const std::string& getObservationsPayload(std::size_t count) {
+  static std::map<std::size_t, std::string> payloads;
+
+  std::string& payload(payloads[count]);
+  if (!payload.empty()) {
+    return (payload);
+  }
+
+  std::ifstream ifs(test::harmonizePath(RECORDED_OBSERVATIONS).c_str());
+  assert(ifs && "Recorded observations data file expected");
+
+  std::string header;
+  std::string footer;
+  std::vector<std::string> observations;
+
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (std::string::npos != line.find("<observation ")) {
+      observations.push_back(line);
+    } else if (observations.empty()) {
+      header.append(line).append("\n");
+    } else {
+      footer.append(line).append("\n");
+    }
+  }
+
+  assert(!observations.empty());
+
+  const std::string DATE_ATTRIBUTE("date=\"");
+  ObservationSeries::DayNumber firstDay(ObservationSeries::toDayNumber("1950-01-01"));
+
+  payload = header;
+  payload.reserve(header.size() + count * (observations[0].size() + 1) + footer.size());
+
+  for (std::size_t n = 0; n < count; ++n) {
+    std::string observation(observations[n % observations.size()]);
+
+    std::size_t pos(observation.find(DATE_ATTRIBUTE));
+    if (std::string::npos != pos) {
+      observation.replace(pos + DATE_ATTRIBUTE.size(), 10,
+                          ObservationSeries::toDateString(firstDay + static_cast<int>(n)));
+    }
+
+    payload.append(observation).append("\n");
+  }
+
+  payload.append(footer);
+
+  return (payload);
+}
+
+
+} // namespace bench
+} // namespace fredcpp
+
+//______________________________________________________________________________
+
+/// Runs the registered benchmarks.
+/// Usage: fredcpp-bench [--filter=text] [--min-time=ms] [--json=path]
+///  - filter: runs only the benchmarks whose name contains the text
+///  - min-time: minimum measured time per benchmark, 500ms by default
+///  - json: also writes the results in JSON to the file ("-" for stdout)
+///
+/// Run from the benchmark build directory, which contains the recorded data.
+
+int main(int argc, char* argv[]) {
+  using namespace fredcpp::bench;
+
+  std::string filter;
+  std::string minTime("500");
+  std::string jsonPath;
+
+  for (int n = 1; n < argc; ++n) {
+    std::string arg(argv[n]);
+
+    if (!readOption(arg, "--filter=", filter)
+        && !readOption(arg, "--min-time=", minTime)
+        && !readOption(arg, "--json=", jsonPath)) {
+      std::cerr << "Usage: " << argv[0]
+                << " [--filter=text] [--min-time=ms] [--json=path]" << std::endl;
+      return (1);
+    }
+  }
+
+  double minTimeNs(std::atof(minTime.c_str()) * 1e6);
+
+  // before any document is created: count pugixml pages, then keep them
+  // for reuse as programs following the usage notes do
+  pugi::set_memory_management_functions(allocatePugixml, deallocatePugixml);
+  fredcpp::external::PugiXmlParser::installMemoryPool();
+
+  const std::vector<Benchmark*>& benchmarks(BenchmarkRegistry::getInstance().getBenchmarks());
+  std::vector<BenchmarkResult> results;
+
+  printTextHeader(std::cout);
+
+  for (std::vector<Benchmark*>::const_iterator it = benchmarks.begin();
+       it != benchmarks.end(); ++it) {
+    if (!filter.empty() && std::string::npos == (*it)->getName().find(filter)) {
+      continue;
+    }
+
+    results.push_back(measure(*(*it), minTimeNs));
+    printTextRow(std::cout, results.back());
+  }
+
+  if ("-" == jsonPath) {
+    printJson(std::cout, results);
+
+  } else if (!jsonPath.empty()) {
+    std::ofstream ofs(jsonPath.c_str());
+    if (!ofs) {
+      std::cerr << "Failed to write: " << jsonPath << std::endl;
+      return (1);
+    }
+
+    printJson(ofs, results);
+  }
+
+  return (0);
+}
@@ -0,0 +1,131 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef FREDCPP_BENCH_H_
+#define FREDCPP_BENCH_H_
+
+/// @file
+/// Defines minimal benchmark harness used by `fredcpp-bench`.
+
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace fredcpp {
+namespace bench {
+
+
+/// Benchmark of a single operation.
+/// The harness calls Benchmark::setUp once, then Benchmark::run repeatedly
+/// until the minimum run time is reached; Benchmark::run performs
+/// Benchmark::getItemCount operations, results are reported per operation.
+///
+/// When Benchmark::prepare is overridden to return true, it is called before
+/// each run and is not included in the measured time (e.g. to refill data
+/// consumed by the run).
+
+class Benchmark {
+public:
+  Benchmark(const std::string& name, std::size_t itemCount = 1);
+  virtual ~Benchmark();
+
+  const std::string& getName() const;
+  std::size_t getItemCount() const;
+
+  virtual void setUp();
+  virtual bool prepare();
+  virtual void run() = 0;
+
+private:
+  std::string name_;
+  std::size_t itemCount_;
+};
+
+//______________________________________________________________________________
+
+/// Registered benchmarks, in the order of registration.
+class BenchmarkRegistry {
+public:
+  static BenchmarkRegistry& getInstance();
+
+  /// Takes ownership of the benchmark.
+  void add(Benchmark* benchmark);
+  const std::vector<Benchmark*>& getBenchmarks() const;
+
+private:
+  BenchmarkRegistry();
+  ~BenchmarkRegistry();
+
+  std::vector<Benchmark*> benchmarks_;
+};
+
+
+/// Measured results of a benchmark, per operation.
+struct BenchmarkResult {
+  BenchmarkResult();
+
+  std::string name;
+  std::size_t itemCount;
+  std::size_t runCount;
+  double nsPerOp;
+  double allocationsPerOp;
+  double bytesPerOp;
+};
+
+
+/// Heap allocations counted by the benchmark program.
+struct AllocationStats {
+  AllocationStats();
+
+  unsigned long long allocations;
+  unsigned long long bytes;
+};
+
+AllocationStats getAllocationStats();
+
+
+/// Keeps a computed value alive, so the computation is not optimized away.
+void keep(double value);
+
+/// Recorded `series/observations` response expanded to the number of
+/// observations (the recorded ones repeated with consecutive dates).
+const std::string& getObservationsPayload(std::size_t count);
+
+
+} // namespace bench
+} // namespace fredcpp
+
+
+#define FREDCPP_BENCH_CONCAT_(a, b) a##b
+#define FREDCPP_BENCH_CONCAT(a, b) FREDCPP_BENCH_CONCAT_(a, b)
+
+/// Registers benchmark instance, e.g.:
+///     FREDCPP_BENCHMARK(ValuesBenchmark, ("values/strtod", 1000));
+#define FREDCPP_BENCHMARK(Class, args) \
+  static const bool FREDCPP_BENCH_CONCAT(benchmarkRegistered_, __LINE__) = \
+    (::fredcpp::bench::BenchmarkRegistry::getInstance().add(new Class args), true)
+
+#endif // FREDCPP_BENCH_H_
@@ -166,3 +166,49 @@ TEST(ApiLog, AllowsDebugDepth) {
   FREDCPP_LOG_DBGN(1, "debug:1");  // Debug:printed
   ASSERT_EQ("debug:1", logger.getDebug());
 }
+
+
+namespace {
+
+int formatCount(0);
+
+struct CountedFormat {
+};
+
+std::ostream& operator<< (std::ostream& os, const CountedFormat&) {
+  ++formatCount;
+  FREDCPP_LOG_WARN("nested:" << std::hex << 255);
+  return (os << "counted");
+}
+
+} // namespace
+
+
+TEST(ApiLog, FormatsOnlyEnabledMessages) {
+  FREDCPP_TESTCASE("Formats a message only when its level and debug depth are enabled");
+  using namespace fredcpp;
+
+  MockLogger& logger (MockLogger::getInstance());
+  ApiLog::getInstance().configure()
+                       .withLogger(&logger)
+                       .withDebugDepth(0);
+
+  logger.enableLevel(internal::LogLevel::LOG_WARN);
+  logger.enableLevel(internal::LogLevel::LOG_DEBUG);
+  logger.disableLevel(internal::LogLevel::LOG_INFO);
+
+  formatCount = 0;
+
+  FREDCPP_LOG_INFO("info:" << CountedFormat());
+  FREDCPP_LOG_DBGN(1, "debug:" << CountedFormat());
+  ASSERT_EQ(0, formatCount);
+
+  // message formatted while formatting another one, stream format restored
+  FREDCPP_LOG_DEBUG("debug:" << CountedFormat() << ":" << 255);
+  ASSERT_EQ(1, formatCount);
+  ASSERT_EQ("debug:counted:255", logger.getDebug());
+  ASSERT_EQ("nested:ff", logger.getWarn());
+
+  FREDCPP_LOG_DEBUG("debug:" << 255);
+  ASSERT_EQ("debug:255", logger.getDebug());
+}
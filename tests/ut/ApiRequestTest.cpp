@@ -27,6 +27,8 @@
 
 #include <fredcpp/ApiRequestBuilder.h>
 
+#include <cstring>
+
 
 // Series
 
@@ -236,3 +238,20 @@ TEST(ApiRequestBuilder, CreatesCategoryChildrenPath) {
 }
 
 
+
+
+TEST(ApiRequest, NamesEntityFromReusedBuffer) {
+  FREDCPP_TESTCASE("Requests the entity named by the current content of a reused char array");
+  using namespace fredcpp;
+
+  char entity[32];
+
+  std::strcpy(entity, "series");
+  ApiRequest seriesRequest(entity);
+
+  std::strcpy(entity, "release");
+  ApiRequest releaseRequest(entity);
+
+  ASSERT_EQ("series", seriesRequest.getPath());
+  ASSERT_EQ("release", releaseRequest.getPath());
+}
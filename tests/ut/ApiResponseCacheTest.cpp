@@ -0,0 +1,161 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/ApiResponseCache.h>
+#include <fredcpp/ApiRequestBuilder.h>
+
+#include <memory>
+
+
+namespace {
+
+fredcpp::ApiResponsePtr makeResponse(const std::string& title, std::size_t count = 1) {
+  std::shared_ptr<fredcpp::ApiResponse> response(std::make_shared<fredcpp::ApiResponse>());
+
+  response->result.name = "seriess";
+
+  for (std::size_t n = 0; n < count; ++n) {
+    fredcpp::ApiEntity& entity(response->appendEntity());
+    entity.name = "series";
+    entity.attributes["title"] = title;
+  }
+
+  return (response);
+}
+
+} // namespace
+
+
+TEST(ApiResponseCache, KeyIgnoresParameterOrderAndCase) {
+  FREDCPP_TESTCASE("Cache key consists of entity and sorted parameters");
+  using namespace fredcpp;
+
+  ApiRequest request("series");
+  request.with("series_id", "GDP").with("realtime_start", "2013-01-01");
+
+  ApiRequest reordered("series");
+  reordered.with("REALTIME_START", "2013-01-01").with("series_id", "GDP");
+
+  ASSERT_EQ("series?realtime_start=2013-01-01&series_id=GDP", ApiResponseCache::makeKey(request));
+  ASSERT_EQ(ApiResponseCache::makeKey(request), ApiResponseCache::makeKey(reordered));
+
+  ASSERT_NE(ApiResponseCache::makeKey(ApiRequestBuilder::Series("GDP")),
+            ApiResponseCache::makeKey(ApiRequestBuilder::SeriesRelease("GDP")));
+}
+
+
+TEST(ApiResponseCache, KeyIncludesEndpoint) {
+  FREDCPP_TESTCASE("Cache key and fingerprint include the API endpoint");
+  using namespace fredcpp;
+
+  ApiRequest request("series");
+  request.with("series_id", "GDP");
+
+  const std::string endpoint("https://api.stlouisfed.org/fred");
+  const std::string mirror("https://mirror.example.org/fred");
+
+  ASSERT_EQ("https://api.stlouisfed.org/fred/series?series_id=GDP", ApiResponseCache::makeKey(request, endpoint));
+  ASSERT_NE(ApiResponseCache::makeFingerprint(request, endpoint), ApiResponseCache::makeFingerprint(request, mirror));
+  ASSERT_NE(ApiResponseCache::makeFingerprint(request), ApiResponseCache::makeFingerprint(request, endpoint));
+
+  ApiResponseCache cache;
+  ApiResponsePtr response(makeResponse("Gross Domestic Product"));
+
+  ASSERT_TRUE(cache.insert(request, response, endpoint));
+  ASSERT_EQ(response.get(), cache.find(request, endpoint).get());
+  ASSERT_TRUE(NULL == cache.find(request, mirror).get());
+  ASSERT_TRUE(NULL == cache.find(request).get());
+
+  ASSERT_FALSE(cache.erase(request, mirror));
+  ASSERT_TRUE(cache.erase(request, endpoint));
+}
+
+
+TEST(ApiResponseCache, ReturnsSharedResponse) {
+  FREDCPP_TESTCASE("Hit returns the same shared response");
+  using namespace fredcpp;
+
+  ApiResponseCache cache;
+
+  ASSERT_TRUE(NULL == cache.find(ApiRequestBuilder::Series("GDP")).get());
+
+  ApiResponsePtr response(makeResponse("Gross Domestic Product"));
+  ASSERT_TRUE(cache.insert(ApiRequestBuilder::Series("GDP"), response));
+
+  ApiResponsePtr cached(cache.find(ApiRequestBuilder::Series("GDP")));
+  ASSERT_EQ(response.get(), cached.get());
+
+  ASSERT_EQ(1UL, cache.getStats().hits);
+  ASSERT_EQ(1UL, cache.getStats().misses);
+  ASSERT_EQ(1UL, cache.getStats().insertions);
+  ASSERT_EQ(1U, cache.size());
+  ASSERT_LT(0U, cache.getBytes());
+
+  ASSERT_TRUE(cache.erase(ApiRequestBuilder::Series("GDP")));
+  ASSERT_EQ(0U, cache.size());
+  ASSERT_EQ(0U, cache.getBytes());
+}
+
+
+TEST(ApiResponseCache, EvictsLeastRecentlyUsed) {
+  FREDCPP_TESTCASE("Evicts least recently used responses to fit the byte budget");
+  using namespace fredcpp;
+
+  ApiResponsePtr response(makeResponse("Gross Domestic Product", 10));
+
+  std::size_t entryBytes;
+  {
+    ApiResponseCache probe;
+    probe.insert(ApiRequestBuilder::Series("GDP"), response);
+    entryBytes = probe.getBytes();
+  }
+
+  // room for two responses
+  ApiResponseCache cache(2 * entryBytes + entryBytes / 2);
+
+  cache.insert(ApiRequestBuilder::Series("GDP"), response);
+  cache.insert(ApiRequestBuilder::Series("GNP"), response);
+
+  ASSERT_TRUE(NULL != cache.find(ApiRequestBuilder::Series("GDP")).get());  // GNP is now least recent
+
+  cache.insert(ApiRequestBuilder::Series("UNRATE"), response);
+
+  ASSERT_EQ(2U, cache.size());
+  ASSERT_EQ(1UL, cache.getStats().evictions);
+  ASSERT_TRUE(NULL != cache.find(ApiRequestBuilder::Series("GDP")).get());
+  ASSERT_TRUE(NULL != cache.find(ApiRequestBuilder::Series("UNRATE")).get());
+  ASSERT_TRUE(NULL == cache.find(ApiRequestBuilder::Series("GNP")).get());
+  ASSERT_LE(cache.getBytes(), cache.getMaxBytes());
+
+  cache.withMaxBytes(entryBytes);
+  ASSERT_EQ(1U, cache.size());
+  ASSERT_TRUE(NULL != cache.find(ApiRequestBuilder::Series("UNRATE")).get());
+
+  // larger than the budget
+  ASSERT_FALSE(cache.insert(ApiRequestBuilder::Series("LARGE"), makeResponse("Large", 100)));
+  ASSERT_TRUE(NULL == cache.find(ApiRequestBuilder::Series("LARGE")).get());
+}
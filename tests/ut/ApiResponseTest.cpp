@@ -50,3 +50,73 @@ TEST(ApiResponse, ReceivesApiError) {
   response.setErrorFromResult();
   ASSERT_EQ("400", response.error.code);
 }
+
+
+TEST(ApiResponse, RecyclesClearedEntities) {
+  FREDCPP_TESTCASE("Reuses memory of cleared entities when recycling");
+  using namespace fredcpp;
+
+  const std::string LONG_TITLE("Gross Domestic Product, Seasonally Adjusted Annual Rate");
+
+  ApiResponse response;
+  response.setRecycling(true);
+
+  response.appendEntity().value = LONG_TITLE;
+  response.appendEntity().value = LONG_TITLE;
+  const char* storage(response.entities[1].value.data());
+
+  response.clear();
+  ASSERT_TRUE(response.entities.empty());
+
+  ApiEntity& entity(response.appendEntity());
+  ASSERT_TRUE(entity.value.empty());
+  ASSERT_EQ(1U, response.entities.size());
+
+  entity.value = LONG_TITLE;
+  ASSERT_EQ(storage, entity.value.data());
+}
+
+
+TEST(ApiResponse, RecyclesAttributeSlots) {
+  FREDCPP_TESTCASE("Assigns attribute values of recycled entities in place");
+  using namespace fredcpp;
+
+  const std::string LONG_DATE("2014-03-14T00:00:00 America/Chicago, realtime");
+
+  ApiResponse response;
+  response.setRecycling(true);
+
+  ApiEntity& first(response.appendEntity());
+  first.attributes["date"] = LONG_DATE;
+  first.attributes["value"] = "1.5";
+  const char* storage(first.attributes["date"].data());
+
+  response.clear();
+
+  ApiEntity& entity(response.appendEntity());
+  ASSERT_TRUE(entity.attributes.empty());
+  ASSERT_EQ("", entity.attribute("date"));
+
+  entity.attributes["DATE"] = LONG_DATE;
+  ASSERT_EQ(1U, entity.attributes.size());
+  ASSERT_EQ(storage, entity.attributes.find("date")->second.data());
+  ASSERT_EQ("date", entity.attributes.begin()->first.str());
+}
+
+
+TEST(ApiResponse, DoesNotCopyRecycledEntities) {
+  FREDCPP_TESTCASE("Recycled entities stay with the response object");
+  using namespace fredcpp;
+
+  ApiResponse response;
+  response.setRecycling(true);
+  response.appendEntity().name = "series";
+  response.clear();
+
+  ApiResponse copy(response);
+  ASSERT_TRUE(copy.isRecycling());
+  ASSERT_TRUE(copy.entities.empty());
+
+  response.setRecycling(false);
+  ASSERT_EQ("", response.appendEntity().name);
+}
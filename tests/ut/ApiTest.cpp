@@ -33,10 +33,20 @@
 #include <fredcpp/ApiRequestBuilder.h>
 #include <fredcpp/ApiResponse.h>
 
+#include <fredcpp/external/DiskCacheHttpClient.h>
+#include <fredcpp/external/JsonResponseParser.h>
+#include <fredcpp/external/StreamingXmlParser.h>
+#include <fredcpp/internal/RateLimiter.h>
+#include <fredcpp/internal/utils.h>
+
 #include <MockHttpClient.h>
 #include <MockXmlParser.h>
 #include <MockLogger.h>
 
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
 
 
 TEST(Api, RequiresValidHttpClient) {
@@ -149,6 +159,55 @@ TEST(Api, ErrorWhenParserFailed) {
 }
 
 
+namespace {
+
+/// Fails the parse after overwriting the content, as an in-place parser may.
+
+class ManglingXmlParser : public fredcpp::internal::XmlResponseParser {
+public:
+  bool parse(std::istream& content, fredcpp::ApiResponse& response) {
+    return (false);
+  }
+
+  bool parseInPlace(char* content, std::size_t size, fredcpp::ApiResponse& response) {
+    std::fill(content, content + size, '\0');
+    return (false);
+  }
+};
+
+} // namespace
+
+
+TEST(Api, ReportsUnparsedContentWhenParserFailed) {
+  FREDCPP_TESTCASE("Parse error reports the content as received, before it was parsed in place");
+  using namespace fredcpp;
+
+  ManglingXmlParser parser;
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(parser)
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+
+  ASSERT_FALSE(api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), response));
+  ASSERT_EQ(ApiError::FREDCPP_FAIL_PARSE, response.error.status);
+
+  const std::string& message(response.error.message);
+  EXPECT_NE(std::string::npos, message.find("content-begin:{\n<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n<observations "));
+  EXPECT_EQ(std::string::npos, message.find('\0'));
+
+  // content is reported up to a limit
+  EXPECT_NE(std::string::npos, message.find("...\n}:content-end"));
+  EXPECT_LT(message.size(), 1024U + 512U);
+}
+
+
 TEST(Api, ErrorWhenHttpFailed) {
   FREDCPP_TESTCASE("Responds with error when HTTP request failed");
   using namespace fredcpp;
@@ -200,3 +259,450 @@ TEST(Api, ErrorResponseWhenApiError) {
 }
 
 
+
+namespace {
+
+class CountingResponseHandler : public fredcpp::ApiResponseHandler {
+public:
+  CountingResponseHandler()
+    : goodCount(0)
+    , badCount(0) {
+  }
+
+  void onResponse(std::size_t index, const fredcpp::ApiRequest& request, fredcpp::ApiResponse& response) {
+    indices.push_back(index);
+    response.good() ? ++goodCount : ++badCount;
+  }
+
+  std::vector<std::size_t> indices;
+  std::size_t goodCount;
+  std::size_t badCount;
+};
+
+} // namespace
+
+
+TEST(Api, DeliversBatchResponsesToHandler) {
+  FREDCPP_TESTCASE("Delivers response of each batch request to the handler");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(MockXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance().withExecuteMode(MockHttpClient::MOCK_OK);
+  MockXmlParser::getInstance().withParseMode(MockXmlParser::MOCK_OK);
+
+  ApiRequestVector requests;
+  requests.push_back(ApiRequestBuilder::Series("TEST-ID1"));
+  requests.push_back(ApiRequestBuilder::Series("TEST-ID2"));
+  requests.push_back(ApiRequestBuilder::SeriesObservations("TEST-ID3"));
+
+  CountingResponseHandler handler;
+
+  bool result = api.getBatch(requests, handler);
+  ASSERT_TRUE(result);
+  ASSERT_EQ(requests.size(), handler.indices.size());
+  ASSERT_EQ(requests.size(), handler.goodCount);
+
+  std::sort(handler.indices.begin(), handler.indices.end());
+  for (std::size_t n = 0; n < requests.size(); ++n) {
+    ASSERT_EQ(n, handler.indices[n]);
+  }
+}
+
+
+TEST(Api, ReturnsBatchResponsesInRequestOrder) {
+  FREDCPP_TESTCASE("Fills batch responses in order of the requests");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(MockXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance().withExecuteMode(MockHttpClient::MOCK_OK);
+  MockXmlParser::getInstance().withParseMode(MockXmlParser::MOCK_OK);
+
+  ApiRequestVector requests(2, ApiRequestBuilder::Series("TEST-ID"));
+  std::vector<ApiResponse> responses;
+
+  bool result = api.getBatch(requests, responses);
+  ASSERT_TRUE(result);
+  ASSERT_EQ(requests.size(), responses.size());
+  ASSERT_TRUE(responses[0].good());
+  ASSERT_EQ("TEST-ID", responses[1].entities[0].attribute("id"));
+}
+
+
+TEST(Api, ErrorWhenBatchHttpFailed) {
+  FREDCPP_TESTCASE("Responds with error for each failed batch request");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(MockXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance().withExecuteMode(MockHttpClient::MOCK_FAIL);
+
+  ApiRequestVector requests(3, ApiRequestBuilder::Series("TEST-ID"));
+  CountingResponseHandler handler;
+
+  bool result = api.getBatch(requests, handler);
+  ASSERT_FALSE(result);
+  ASSERT_EQ(requests.size(), handler.badCount);
+}
+
+
+TEST(Api, PacesRequestsToRateLimit) {
+  FREDCPP_TESTCASE("Paces batch requests to the configured rate limit");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(MockXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance())
+     .withKey("TEST-RATE-KEY")
+     .withRateLimit(100, 1);
+
+  MockHttpClient::getInstance().withExecuteMode(MockHttpClient::MOCK_OK);
+  MockXmlParser::getInstance().withParseMode(MockXmlParser::MOCK_OK);
+
+  ApiRequestVector requests(6, ApiRequestBuilder::Series("TEST-ID"));
+  CountingResponseHandler handler;
+
+  unsigned long long start(internal::monotonicMillis());
+
+  bool result = api.getBatch(requests, handler);
+  ASSERT_TRUE(result);
+  ASSERT_EQ(requests.size(), handler.goodCount);
+
+  // first request passes right away, each next one waits ~10ms
+  unsigned long long elapsed(internal::monotonicMillis() - start);
+  ASSERT_GE(elapsed, 45ULL);
+
+  api.withRateLimit(0);
+}
+
+
+TEST(Api, SharesRateLimitWithoutReset) {
+  FREDCPP_TESTCASE("Configuring another Api with the same key keeps the requests taken");
+  using namespace fredcpp;
+
+  Api api;
+  api.withKey("TEST-SHARED-RATE-KEY")
+     .withRateLimit(1, 60);
+
+  internal::RateLimiter& limiter(internal::RateLimiter::forKey("TEST-SHARED-RATE-KEY"));
+  ASSERT_TRUE(limiter.tryAcquire());
+
+  Api other;
+  other.withKey("TEST-SHARED-RATE-KEY")
+       .withRateLimit(1, 60);
+
+  ASSERT_FALSE(limiter.tryAcquire());
+
+  api.withRateLimit(1, 60);
+  ASSERT_FALSE(limiter.tryAcquire());
+}
+
+
+TEST(Api, DoesNotRateLimitCachedRequests) {
+  FREDCPP_TESTCASE("Single requests served from the disk cache take no rate limit token");
+  using namespace fredcpp;
+
+  MockHttpClient& mock(MockHttpClient::getInstance());
+  mock.withExecuteMode(MockHttpClient::MOCK_OK)
+      .resetExecuteCount();
+  MockXmlParser::getInstance().withParseMode(MockXmlParser::MOCK_OK);
+
+  external::DiskCacheHttpClient cache(mock, "cache-ut");
+
+  // a token each 500ms
+  Api api;
+
+  api.withExecutor(cache)
+     .withParser(MockXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance())
+     .withKey("TEST-CACHED-RATE-KEY")
+     .withRateLimit(2, 1);
+
+  ApiRequest request(ApiRequestBuilder::Series("TEST-CACHED-ID"));
+  internal::HttpRequest httpRequest;
+  httpRequest.withURI("https://api.stlouisfed.org/fred/series")
+             .withParams(request);
+  cache.invalidate(httpRequest);
+
+  ApiResponse response;
+  ASSERT_TRUE(api.get(request, response));
+  ASSERT_EQ(1UL, mock.getExecuteCount());
+
+  unsigned long long start(internal::monotonicMillis());
+
+  for (std::size_t n = 0; n < 5; ++n) {
+    ASSERT_TRUE(api.get(request, response));
+  }
+
+  unsigned long long elapsed(internal::monotonicMillis() - start);
+  EXPECT_LT(elapsed, 400ULL);
+  EXPECT_EQ(1UL, mock.getExecuteCount());
+  EXPECT_EQ(5UL, cache.getCacheStats().hits);
+
+  api.withRateLimit(0);
+}
+
+
+namespace {
+
+class CountingEntityHandler : public fredcpp::ApiEntityHandler {
+public:
+  CountingEntityHandler()
+    : count(0) {
+  }
+
+  void onEntity(const fredcpp::ApiEntity& entity) {
+    ++count;
+  }
+
+  std::size_t count;
+};
+
+} // namespace
+
+
+TEST(Api, PassesEntitiesToHandler) {
+  FREDCPP_TESTCASE("Passes response entities to the handler while parsing");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+  CountingEntityHandler handler;
+
+  bool result = api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), response, handler);
+  ASSERT_TRUE(result);
+  ASSERT_EQ("observations", response.result.name);
+  ASSERT_TRUE(response.entities.empty());
+  ASSERT_EQ(10U, handler.count);
+}
+
+
+TEST(Api, ReportsStreamedContentWhenParserFailed) {
+  FREDCPP_TESTCASE("Parse error of streamed content reports the content received");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_malformed.xml"));
+
+  ApiResponse response;
+  CountingEntityHandler handler;
+
+  ASSERT_FALSE(api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), response, handler));
+  ASSERT_EQ(ApiError::FREDCPP_FAIL_PARSE, response.error.status);
+
+  const std::string& message(response.error.message);
+  EXPECT_NE(std::string::npos, message.find("content-begin:{\n<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n<observations "));
+  EXPECT_NE(std::string::npos, message.find("date=\"2014-03-04\" value=\"1.3746\"\n\n}:content-end"));
+}
+
+
+TEST(Api, PassesBufferedEntitiesToHandler) {
+  FREDCPP_TESTCASE("Passes response entities to the handler with non-incremental parser");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(MockXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance().withExecuteMode(MockHttpClient::MOCK_OK);
+  MockXmlParser::getInstance().withParseMode(MockXmlParser::MOCK_OK);
+
+  ApiResponse response;
+  CountingEntityHandler handler;
+
+  bool result = api.get(ApiRequestBuilder::Series("TEST-ID"), response, handler);
+  ASSERT_TRUE(result);
+  ASSERT_TRUE(response.entities.empty());
+  ASSERT_EQ(1U, handler.count);
+}
+
+
+TEST(Api, GetsJsonResponse) {
+  FREDCPP_TESTCASE("Gets response of file_type json with the JSON parser");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::JsonResponseParser::getInstance())
+     .withLogger(MockLogger::getInstance())
+     .withFileType("json");
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withContentType("application/json; charset=UTF-8")
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.json"));
+
+  ApiResponse response;
+  bool result = api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), response);
+
+  CountingEntityHandler handler;
+  bool handlerResult = api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), response, handler);
+
+  // XML content is not accepted by the JSON parser
+  MockHttpClient::getInstance().withContentType("");
+
+  ApiResponse xmlResponse;
+  bool xmlResult = api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), xmlResponse);
+
+  ASSERT_TRUE(result);
+  ASSERT_EQ("observations", response.result.name);
+  ASSERT_TRUE(handlerResult);
+  ASSERT_EQ(10U, handler.count);
+  ASSERT_FALSE(xmlResult);
+  ASSERT_EQ(ApiError::FREDCPP_FAIL_HTTP, xmlResponse.error.status);
+}
+
+
+TEST(Api, ServesRepeatedRequestsFromCache) {
+  FREDCPP_TESTCASE("Serves repeated requests from the response cache");
+  using namespace fredcpp;
+
+  Api api;
+  ApiResponseCache cache;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance())
+     .withCache(cache);
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"));
+  MockHttpClient::getInstance().resetExecuteCount();
+
+  ApiResponsePtr shared(api.getShared(ApiRequestBuilder::SeriesObservations("TEST-ID")));
+  ASSERT_TRUE(shared->good());
+  ASSERT_EQ(10U, shared->entities.size());
+
+  ASSERT_EQ(shared.get(), api.getShared(ApiRequestBuilder::SeriesObservations("TEST-ID")).get());
+
+  ApiResponse response;
+  ASSERT_TRUE(api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), response));
+  ASSERT_EQ(10U, response.entities.size());
+
+  ASSERT_EQ(1UL, MockHttpClient::getInstance().getExecuteCount());
+  ASSERT_EQ(2UL, cache.getStats().hits);
+
+  // bad responses are not cached
+  MockHttpClient::getInstance().withExecuteMode(MockHttpClient::MOCK_FAIL);
+
+  ASSERT_FALSE(api.get(ApiRequestBuilder::Series("TEST-ID"), response));
+  ASSERT_FALSE(api.getShared(ApiRequestBuilder::Series("TEST-ID"))->good());
+  ASSERT_EQ(3UL, MockHttpClient::getInstance().getExecuteCount());
+  ASSERT_EQ(1U, cache.size());
+}
+
+
+TEST(Api, KeepsCachedResponsesPerEndpoint) {
+  FREDCPP_TESTCASE("Api objects of different endpoints sharing a cache do not serve each other's responses");
+  using namespace fredcpp;
+
+  ApiResponseCache cache;
+  Api api;
+  Api mirrorApi("https://mirror.example.org/fred");
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance())
+     .withCache(cache);
+
+  mirrorApi.withExecutor(MockHttpClient::getInstance())
+           .withParser(external::StreamingXmlParser::getInstance())
+           .withLogger(MockLogger::getInstance())
+           .withCache(cache);
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"));
+  MockHttpClient::getInstance().resetExecuteCount();
+
+  ApiResponsePtr shared(api.getShared(ApiRequestBuilder::SeriesObservations("TEST-ID")));
+  ApiResponsePtr mirrorShared(mirrorApi.getShared(ApiRequestBuilder::SeriesObservations("TEST-ID")));
+
+  ASSERT_NE(shared.get(), mirrorShared.get());
+  ASSERT_EQ(2UL, MockHttpClient::getInstance().getExecuteCount());
+  ASSERT_EQ(2U, cache.size());
+
+  ASSERT_EQ(shared.get(), api.getShared(ApiRequestBuilder::SeriesObservations("TEST-ID")).get());
+  ASSERT_EQ(mirrorShared.get(), mirrorApi.getShared(ApiRequestBuilder::SeriesObservations("TEST-ID")).get());
+  ASSERT_EQ(2UL, MockHttpClient::getInstance().getExecuteCount());
+}
+
+
+TEST(Api, MergesAllPagesOfPagedResult) {
+  FREDCPP_TESTCASE("Requests remaining pages of a paged result and merges them in order");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK_PAGED)
+    .withPaging(25, 10)
+    .resetExecuteCount();
+
+  ApiResponse response;
+
+  ASSERT_TRUE(api.getAll(ApiRequestBuilder::ReleaseSeries("51"), response));
+  ASSERT_EQ(3UL, MockHttpClient::getInstance().getExecuteCount());
+  ASSERT_EQ(25U, response.entities.size());
+
+  for (std::size_t n = 0; n < response.entities.size(); ++n) {
+    std::ostringstream id;
+    id << "S" << n;
+    ASSERT_EQ(id.str(), response.entities[n].attribute("id"));
+  }
+
+  // starting at an offset, with a page size
+  ASSERT_TRUE(api.getAll(ApiRequestBuilder::ReleaseSeries("51").withOffset("5").withLimit("8"), response));
+  ASSERT_EQ(20U, response.entities.size());
+  ASSERT_EQ("S5", response.entities.front().attribute("id"));
+  ASSERT_EQ("S24", response.entities.back().attribute("id"));
+
+  // single page
+  MockHttpClient::getInstance().withPaging(5, 10).resetExecuteCount();
+
+  ASSERT_TRUE(api.getAll(ApiRequestBuilder::ReleaseSeries("51"), response));
+  ASSERT_EQ(1UL, MockHttpClient::getInstance().getExecuteCount());
+  ASSERT_EQ(5U, response.entities.size());
+
+  MockHttpClient::getInstance().withExecuteMode(MockHttpClient::MOCK_OK);
+}
+
@@ -0,0 +1,201 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-testutils.h>
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/Api.h>
+
+#include <fredcpp/ApiLog.h>
+#include <fredcpp/ApiRequestBuilder.h>
+#include <fredcpp/ApiResponse.h>
+#include <fredcpp/ApiResponseCache.h>
+
+#include <fredcpp/external/StreamingXmlParser.h>
+
+#include <MockHttpClient.h>
+#include <MockLogger.h>
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+/// Counts the logged messages, may be shared by many threads.
+
+class CountingLogger : public fredcpp::internal::Logger {
+public:
+  CountingLogger()
+    : messages(0) {
+  }
+
+  void logMessage(fredcpp::internal::LogLevel::Level level, const std::string& message, const fredcpp::internal::LogContext& context) {
+    ++messages;
+  }
+
+  bool enableLevel(fredcpp::internal::LogLevel::Level level) {
+    return (true);
+  }
+
+  bool disableLevel(fredcpp::internal::LogLevel::Level level) {
+    return (true);
+  }
+
+  bool levelEnabled(fredcpp::internal::LogLevel::Level level) const {
+    return (true);
+  }
+
+  std::atomic<unsigned long> messages;
+};
+
+
+class CountingEntityHandler : public fredcpp::ApiEntityHandler {
+public:
+  CountingEntityHandler()
+    : count(0) {
+  }
+
+  void onEntity(const fredcpp::ApiEntity& entity) {
+    ++count;
+  }
+
+  void onReset() {
+    count = 0;
+  }
+
+  std::size_t count;
+};
+
+
+const std::size_t NUM_THREADS(8);
+const std::size_t NUM_ITERATIONS(50);
+const std::size_t NUM_ENTITIES(10);
+
+
+/// Calls the shared Api in all the ways of a typical client,
+/// counting the calls with unexpected results.
+
+void runClient(fredcpp::Api& api, std::size_t id, std::atomic<unsigned long>& failures) {
+  using namespace fredcpp;
+
+  for (std::size_t n = 0; n < NUM_ITERATIONS; ++n) {
+    std::ostringstream seriesId;
+    seriesId << "T" << id << "-" << n;
+
+    ApiResponse response;
+
+    if (!api.get(ApiRequestBuilder::SeriesObservations(seriesId.str()), response)
+        || NUM_ENTITIES != response.entities.size()) {
+      ++failures;
+    }
+
+    CountingEntityHandler handler;
+
+    if (!api.get(ApiRequestBuilder::SeriesObservations(seriesId.str()), response, handler)
+        || NUM_ENTITIES != handler.count) {
+      ++failures;
+    }
+
+    // the same few requests from all threads, mostly served by the cache
+    std::ostringstream sharedId;
+    sharedId << "SHARED-" << (n % 4);
+
+    ApiResponsePtr shared(api.getShared(ApiRequestBuilder::SeriesObservations(sharedId.str())));
+
+    if (!shared->good()
+        || NUM_ENTITIES != shared->entities.size()) {
+      ++failures;
+    }
+
+    ApiRequestVector requests;
+    requests.push_back(ApiRequestBuilder::SeriesObservations(seriesId.str()));
+    requests.push_back(ApiRequestBuilder::Series(seriesId.str()));
+
+    std::vector<ApiResponse> responses;
+
+    if (!api.getBatch(requests, responses)
+        || NUM_ENTITIES != responses[0].entities.size()) {
+      ++failures;
+    }
+  }
+}
+
+} // namespace
+
+
+
+TEST(ApiThreading, ServesConcurrentCallers) {
+  FREDCPP_TESTCASE("Serves requests of many threads sharing the Api and its facilities");
+  using namespace fredcpp;
+
+  static CountingLogger logger;
+
+  Api api;
+  ApiResponseCache cache;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(logger)
+     .withRateLimit(1000000)
+     .withCache(cache);
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"));
+  MockHttpClient::getInstance().resetExecuteCount();
+
+  ApiLog::getInstance().withDebugDepth(1);
+
+  std::atomic<unsigned long> failures(0);
+  std::vector<std::thread> threads;
+
+  for (std::size_t id = 0; id < NUM_THREADS; ++id) {
+    threads.push_back(std::thread(runClient, std::ref(api), id, std::ref(failures)));
+  }
+
+  for (std::size_t n = 0; n < threads.size(); ++n) {
+    threads[n].join();
+  }
+
+  ASSERT_EQ(0UL, failures.load());
+
+  // get, get with handler and batch of two execute a request each,
+  // shared requests at least once each
+  unsigned long perThread(NUM_ITERATIONS * 4);
+
+  ASSERT_GE(MockHttpClient::getInstance().getExecuteCount(), NUM_THREADS * perThread + 4);
+  ASSERT_LE(MockHttpClient::getInstance().getExecuteCount(), NUM_THREADS * (perThread + NUM_ITERATIONS));
+  // responses of get and shared requests are cached
+  ASSERT_EQ(NUM_THREADS * NUM_ITERATIONS + 4, cache.size());
+  ASSERT_GT(logger.messages.load(), 0UL);
+
+  ApiLog::getInstance().withDebugDepth(0);
+  api.withLogger(MockLogger::getInstance());
+}
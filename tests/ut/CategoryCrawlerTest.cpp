@@ -0,0 +1,249 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-testutils.h>
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/Api.h>
+#include <fredcpp/CategoryCrawler.h>
+
+#include <fredcpp/external/StreamingXmlParser.h>
+#include <fredcpp/internal/HttpRequest.h>
+#include <fredcpp/internal/HttpRequestExecutor.h>
+#include <fredcpp/internal/HttpResponse.h>
+
+#include <MockLogger.h>
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+/// Serves a small category tree:
+///   0 -> 1, 2;  1 -> 3;  2 -> 3
+/// with series 1: S1 S2;  2: S2 S3;  3: S4 .. S8
+
+class MockCategoryTreeClient : public fredcpp::internal::HttpRequestExecutor {
+public:
+  MockCategoryTreeClient()
+    : executeCount(0) {
+    children["0"].push_back("1");
+    children["0"].push_back("2");
+    children["1"].push_back("3");
+    children["2"].push_back("3");
+
+    series["1"].push_back("S1");
+    series["1"].push_back("S2");
+    series["2"].push_back("S2");
+    series["2"].push_back("S3");
+
+    for (int n = 4; n <= 8; ++n) {
+      series["3"].push_back(std::string("S") + static_cast<char>('0' + n));
+    }
+  }
+
+  bool execute(const fredcpp::internal::HttpRequest& request, fredcpp::internal::HttpResponse& response) {
+    ++executeCount;
+
+    response.clear();
+
+    std::string categoryId(param(request, "category_id"));
+
+    if (failingCategory == categoryId) {
+      response.setHttpStatus(fredcpp::internal::HttpResponse::HTTP_BAD_REQUEST);
+      return (false);
+    }
+
+    response.setHttpStatus(fredcpp::internal::HttpResponse::HTTP_OK);
+    response.setContentType("text/xml; charset=UTF-8");
+
+    std::ostream& content(response.getContentStream());
+    const std::string& URI(request.getURI());
+
+    if (URI.find("category/children") != std::string::npos) {
+      content << "<categories>";
+
+      const std::vector<std::string>& ids(children[categoryId]);
+      for (std::size_t n = 0; n < ids.size(); ++n) {
+        content << "<category id=\"" << ids[n] << "\" parent_id=\"" << categoryId << "\"/>";
+      }
+
+      content << "</categories>";
+
+    } else {
+      const std::vector<std::string>& ids(series[categoryId]);
+
+      unsigned long offset(std::strtoul(param(request, "offset").c_str(), NULL, 10));
+      unsigned long limit(std::strtoul(param(request, "limit").c_str(), NULL, 10));
+
+      content << "<seriess count=\"" << ids.size() << "\" offset=\"" << offset
+              << "\" limit=\"" << limit << "\">";
+
+      for (std::size_t n = offset; n < ids.size() && n < offset + limit; ++n) {
+        content << "<series id=\"" << ids[n] << "\"/>";
+      }
+
+      content << "</seriess>";
+    }
+
+    return (true);
+  }
+
+  std::string encodeURI(const std::string& URI) {
+    return (URI);
+  }
+
+  static std::string param(const fredcpp::internal::HttpRequest& request, const std::string& name) {
+    fredcpp::internal::ParamMap::const_iterator itFound(request.getParams().find(name));
+    return (itFound != request.getParams().end() ? itFound->second.str() : std::string());
+  }
+
+  std::map<std::string, std::vector<std::string> > children;
+  std::map<std::string, std::vector<std::string> > series;
+  std::string failingCategory;
+  unsigned long executeCount;
+};
+
+
+class CollectingCrawlerSink : public fredcpp::CategoryCrawlerSink {
+public:
+  CollectingCrawlerSink()
+    : continueOnError(false)
+    , errors(0) {
+  }
+
+  void onCategory(const fredcpp::ApiEntity& category, const std::string& parentId) {
+    categories.push_back(category.attribute("id"));
+  }
+
+  void onSeries(const fredcpp::ApiEntity& entity, const std::string& categoryId) {
+    series.push_back(entity.attribute("id"));
+  }
+
+  bool onError(const fredcpp::ApiRequest& request, const fredcpp::ApiResponse& response) {
+    ++errors;
+    return (continueOnError);
+  }
+
+  std::vector<std::string> categories;
+  std::vector<std::string> series;
+  bool continueOnError;
+  unsigned errors;
+};
+
+
+void configureApi(fredcpp::Api& api, MockCategoryTreeClient& client) {
+  api.withExecutor(client)
+     .withParser(fredcpp::external::StreamingXmlParser::getInstance())
+     .withLogger(fredcpp::MockLogger::getInstance());
+}
+
+} // namespace
+
+
+TEST(CategoryCrawler, CrawlsTreeAndDedupsSeries) {
+  FREDCPP_TESTCASE("Walks category tree and passes each series once");
+  using namespace fredcpp;
+
+  Api api;
+  MockCategoryTreeClient client;
+  configureApi(api, client);
+
+  CollectingCrawlerSink sink;
+  CategoryCrawler crawler(api);
+  crawler.withMaxBatchSize(3)
+         .withSeriesPageSize(2);
+
+  ASSERT_TRUE(crawler.crawl("0", sink));
+
+  ASSERT_EQ(3U, sink.categories.size());
+  ASSERT_EQ("1", sink.categories[0]);
+  ASSERT_EQ("2", sink.categories[1]);
+  ASSERT_EQ("3", sink.categories[2]);
+
+  ASSERT_EQ(8U, sink.series.size());
+
+  const CategoryCrawler::Stats& stats(crawler.getStats());
+  ASSERT_EQ(4UL, stats.categories);
+  ASSERT_EQ(8UL, stats.series);
+  ASSERT_EQ(1UL, stats.duplicateSeries);
+
+  // children and first series page of 4 categories, 2 more pages of category 3
+  ASSERT_EQ(10UL, stats.requests);
+  ASSERT_EQ(client.executeCount, stats.requests);
+  ASSERT_EQ(0UL, stats.failedRequests);
+}
+
+
+TEST(CategoryCrawler, LimitsDepth) {
+  FREDCPP_TESTCASE("Stops expanding sub-categories at maximum depth");
+  using namespace fredcpp;
+
+  Api api;
+  MockCategoryTreeClient client;
+  configureApi(api, client);
+
+  CollectingCrawlerSink sink;
+  CategoryCrawler crawler(api);
+  crawler.withMaxDepth(1)
+         .withSeries(false);
+
+  ASSERT_TRUE(crawler.crawl("0", sink));
+
+  ASSERT_EQ(2U, sink.categories.size());
+  ASSERT_TRUE(sink.series.empty());
+  ASSERT_EQ(1UL, crawler.getStats().requests);
+}
+
+
+TEST(CategoryCrawler, StopsOnErrorUnlessSinkContinues) {
+  FREDCPP_TESTCASE("Stops crawling on a failed request unless the sink continues");
+  using namespace fredcpp;
+
+  Api api;
+  MockCategoryTreeClient client;
+  client.failingCategory = "2";
+  configureApi(api, client);
+
+  CollectingCrawlerSink sink;
+  CategoryCrawler crawler(api);
+
+  ASSERT_FALSE(crawler.crawl("0", sink));
+  ASSERT_EQ(1U, sink.errors);
+  ASSERT_EQ(3U, sink.categories.size());
+  ASSERT_EQ(2U, sink.series.size());  // stopped before series of category 3
+
+  CollectingCrawlerSink continuingSink;
+  continuingSink.continueOnError = true;
+
+  ASSERT_FALSE(crawler.crawl("0", continuingSink));
+  ASSERT_EQ(2U, continuingSink.errors);
+  ASSERT_EQ(3U, continuingSink.categories.size());
+  ASSERT_EQ(7U, continuingSink.series.size());  // without S3 of category 2
+}
@@ -0,0 +1,247 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-testutils.h>
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/ApiLog.h>
+#include <fredcpp/external/DiskCacheHttpClient.h>
+#include <fredcpp/internal/HttpRequest.h>
+#include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/Request.h>
+
+#include <MockHttpClient.h>
+#include <MockLogger.h>
+
+#include <string>
+#include <vector>
+
+
+namespace {
+
+const std::string CACHE_DIR("cache-ut");
+const std::string OBSERVATIONS_URI("https://api.stlouisfed.org/fred/series/observations");
+const std::string CATEGORY_URI("https://api.stlouisfed.org/fred/category");
+
+
+fredcpp::internal::HttpRequest makeRequest(const std::string& URI, const std::string& seriesId,
+                                           const std::string& apiKey = "abcdef") {
+  fredcpp::internal::HttpRequest request;
+  request.withURI(URI)
+         .withParams(fredcpp::internal::Request()
+                     .with("series_id", seriesId)
+                     .with("api_key", apiKey));
+  return (request);
+}
+
+
+fredcpp::MockHttpClient& resetMock() {
+  fredcpp::ApiLog::getInstance().configure()
+                                .withLogger(&fredcpp::MockLogger::getInstance());
+
+  fredcpp::MockHttpClient& mock(fredcpp::MockHttpClient::getInstance());
+
+  mock.withExecuteMode(fredcpp::MockHttpClient::MOCK_OK)
+      .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"))
+      .withETag("")
+      .resetExecuteCount();
+
+  return (mock);
+}
+
+
+class CollectingResponseHandler : public fredcpp::internal::HttpResponseHandler {
+public:
+  void onResponse(std::size_t index, const fredcpp::internal::HttpRequest& request,
+                  fredcpp::internal::HttpResponse& response) {
+    indices.push_back(index);
+    contents.push_back(response.getContent());
+  }
+
+  std::vector<std::size_t> indices;
+  std::vector<std::string> contents;
+};
+
+} // namespace
+
+
+TEST(DiskCacheHttpClient, KeyIgnoresApiKey) {
+  FREDCPP_TESTCASE("Cache key is the request string without api_key");
+  using namespace fredcpp;
+
+  external::DiskCacheHttpClient cache(resetMock(), CACHE_DIR);
+
+  EXPECT_EQ(OBSERVATIONS_URI + "?series_id=GNPCA",
+            cache.getCacheKey(makeRequest(OBSERVATIONS_URI, "GNPCA")));
+
+  EXPECT_EQ(cache.getCacheKey(makeRequest(OBSERVATIONS_URI, "GNPCA", "key1")),
+            cache.getCacheKey(makeRequest(OBSERVATIONS_URI, "GNPCA", "key2")));
+
+  EXPECT_NE(cache.getCacheKey(makeRequest(OBSERVATIONS_URI, "GNPCA")),
+            cache.getCacheKey(makeRequest(OBSERVATIONS_URI, "GDP")));
+}
+
+
+TEST(DiskCacheHttpClient, ServesFreshEntryFromDisk) {
+  FREDCPP_TESTCASE("Fresh entry is served from disk without a request");
+  using namespace fredcpp;
+
+  MockHttpClient& mock(resetMock());
+  external::DiskCacheHttpClient cache(mock, CACHE_DIR);
+
+  internal::HttpRequest request(makeRequest(OBSERVATIONS_URI, "GNPCA"));
+  cache.invalidate(request);
+
+  internal::HttpResponse fetched;
+  ASSERT_TRUE(cache.execute(request, fetched));
+  ASSERT_EQ(1UL, mock.getExecuteCount());
+
+  internal::HttpResponse cached;
+  ASSERT_TRUE(cache.execute(request, cached));
+  EXPECT_EQ(1UL, mock.getExecuteCount());
+
+  EXPECT_EQ(internal::HttpResponse::HTTP_OK, cached.getHttpStatus());
+  EXPECT_EQ(fetched.getContentType(), cached.getContentType());
+  EXPECT_FALSE(cached.getContent().empty());
+  EXPECT_EQ(fetched.getContent(), cached.getContent());
+
+  EXPECT_EQ(1UL, cache.getCacheStats().hits);
+  EXPECT_EQ(1UL, cache.getCacheStats().misses);
+  EXPECT_EQ(1UL, cache.getCacheStats().stores);
+
+  EXPECT_TRUE(cache.invalidate(request));
+}
+
+
+TEST(DiskCacheHttpClient, RevalidatesStaleEntry) {
+  FREDCPP_TESTCASE("Stale entry with ETag is revalidated with a conditional request");
+  using namespace fredcpp;
+
+  MockHttpClient& mock(resetMock());
+  mock.withETag("\"v1\"");
+
+  external::DiskCacheHttpClient cache(mock, CACHE_DIR);
+  cache.withDefaultTTL(0);
+
+  internal::HttpRequest request(makeRequest(OBSERVATIONS_URI, "GNPCA"));
+  cache.invalidate(request);
+
+  internal::HttpResponse fetched;
+  ASSERT_TRUE(cache.execute(request, fetched));
+  EXPECT_EQ("\"v1\"", fetched.getHeader("etag"));
+
+  internal::HttpResponse revalidated;
+  ASSERT_TRUE(cache.execute(request, revalidated));
+
+  EXPECT_EQ(2UL, mock.getExecuteCount());
+  EXPECT_EQ(internal::HttpResponse::HTTP_OK, revalidated.getHttpStatus());
+  EXPECT_EQ(fetched.getContent(), revalidated.getContent());
+
+  EXPECT_EQ(1UL, cache.getCacheStats().revalidated);
+  EXPECT_EQ(1UL, cache.getCacheStats().misses);
+
+  // changed on the server
+  mock.withETag("\"v2\"");
+
+  internal::HttpResponse changed;
+  ASSERT_TRUE(cache.execute(request, changed));
+  EXPECT_EQ("\"v2\"", changed.getHeader("ETag"));
+  EXPECT_EQ(2UL, cache.getCacheStats().misses);
+
+  cache.invalidate(request);
+  resetMock();
+}
+
+
+TEST(DiskCacheHttpClient, AppliesEndpointTTL) {
+  FREDCPP_TESTCASE("Time-to-live is matched by the trailing endpoint path");
+  using namespace fredcpp;
+
+  MockHttpClient& mock(resetMock());
+  external::DiskCacheHttpClient cache(mock, CACHE_DIR);
+  cache.withDefaultTTL(3600)
+       .withTTL("series/observations", 0)
+       .withTTL("observations/none", 3600);
+
+  internal::HttpRequest observations(makeRequest(OBSERVATIONS_URI, "GNPCA"));
+  internal::HttpRequest category(makeRequest(CATEGORY_URI, "GNPCA"));
+  cache.invalidate(observations);
+  cache.invalidate(category);
+
+  internal::HttpResponse response;
+
+  cache.execute(observations, response);
+  cache.execute(observations, response);
+  EXPECT_EQ(2UL, mock.getExecuteCount());
+
+  cache.execute(category, response);
+  cache.execute(category, response);
+  EXPECT_EQ(3UL, mock.getExecuteCount());
+
+  cache.invalidate(observations);
+  cache.invalidate(category);
+}
+
+
+TEST(DiskCacheHttpClient, ServesBatchFromCache) {
+  FREDCPP_TESTCASE("Batch passes only uncached requests to the executor");
+  using namespace fredcpp;
+
+  MockHttpClient& mock(resetMock());
+  external::DiskCacheHttpClient cache(mock, CACHE_DIR);
+
+  internal::HttpRequestVector requests;
+  requests.push_back(makeRequest(OBSERVATIONS_URI, "GNPCA"));
+  requests.push_back(makeRequest(OBSERVATIONS_URI, "GDP"));
+  requests.push_back(makeRequest(OBSERVATIONS_URI, "UNRATE"));
+
+  for (std::size_t n = 0; n < requests.size(); ++n) {
+    cache.invalidate(requests[n]);
+  }
+
+  internal::HttpResponse response;
+  ASSERT_TRUE(cache.execute(requests[1], response));
+
+  CollectingResponseHandler handler;
+  ASSERT_TRUE(cache.executeBatch(requests, handler, NULL));
+
+  EXPECT_EQ(3UL, mock.getExecuteCount());
+  ASSERT_EQ(3U, handler.indices.size());
+  EXPECT_EQ(1U, handler.indices[0]);  // cached one first
+  EXPECT_EQ(response.getContent(), handler.contents[0]);
+
+  CollectingResponseHandler cachedHandler;
+  ASSERT_TRUE(cache.executeBatch(requests, cachedHandler, NULL));
+
+  EXPECT_EQ(3UL, mock.getExecuteCount());
+  ASSERT_EQ(3U, cachedHandler.indices.size());
+  EXPECT_EQ(0U, cachedHandler.indices[0]);
+  EXPECT_EQ(4UL, cache.getCacheStats().hits);
+
+  for (std::size_t n = 0; n < requests.size(); ++n) {
+    EXPECT_TRUE(cache.invalidate(requests[n]));
+  }
+}
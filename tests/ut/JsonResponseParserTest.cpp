@@ -0,0 +1,183 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-testutils.h>
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/external/JsonResponseParser.h>
+#include <fredcpp/external/StreamingXmlParser.h>
+#include <fredcpp/ApiResponse.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+
+namespace {
+
+std::string readDataFile(const std::string& path) {
+  std::ifstream ifs(fredcpp::test::harmonizePath(path).c_str());
+  std::ostringstream content;
+  content << ifs.rdbuf();
+  return (content.str());
+}
+
+
+bool parseJson(const std::string& json, fredcpp::ApiResponse& response) {
+  std::string content(json);
+
+  response.clear();
+
+  return (fredcpp::external::JsonResponseParser::getInstance()
+            .parseInPlace(&content[0], content.size(), response));
+}
+
+} // namespace
+
+
+TEST(JsonResponseParser, FillsSameResponseAsXml) {
+  FREDCPP_TESTCASE("Fills the same result and entities as from XML content");
+  using namespace fredcpp;
+
+  ApiResponse jsonResponse;
+  ASSERT_TRUE(parseJson(readDataFile("data/response_series_observations_1.json"), jsonResponse));
+
+  ApiResponse xmlResponse;
+  std::istringstream xml(readDataFile("data/response_series_observations_1.xml"));
+  ASSERT_TRUE(external::StreamingXmlParser::getInstance().parse(xml, xmlResponse));
+
+  ASSERT_EQ("observations", jsonResponse.result.name);
+  ASSERT_EQ("40", jsonResponse.result.attribute("count"));
+  ASSERT_EQ("json", jsonResponse.result.attribute("file_type"));
+  ASSERT_EQ(xmlResponse.result.attribute("observation_end"), jsonResponse.result.attribute("observation_end"));
+
+  ASSERT_EQ(xmlResponse.entities.size(), jsonResponse.entities.size());
+
+  for (std::size_t n = 0; n < xmlResponse.entities.size(); ++n) {
+    std::ostringstream xmlEntity;
+    std::ostringstream jsonEntity;
+
+    xmlEntity << xmlResponse.entities[n];
+    jsonEntity << jsonResponse.entities[n];
+
+    ASSERT_EQ(xmlEntity.str(), jsonEntity.str());
+  }
+
+  ASSERT_EQ("observation", jsonResponse.entities[9].name);
+  ASSERT_EQ("2014-03-14", jsonResponse.entities[9].attribute("date"));
+}
+
+
+TEST(JsonResponseParser, ParsesErrorResponse) {
+  FREDCPP_TESTCASE("Parses error response into error result");
+  using namespace fredcpp;
+
+  ApiResponse response;
+  ASSERT_TRUE(parseJson(readDataFile("data/err400_bad_request_api_key.json"), response));
+
+  response.setErrorFromResult();
+
+  ASSERT_FALSE(response.good());
+  ASSERT_EQ("error", response.result.name);
+  ASSERT_EQ("400", response.error.code);
+  ASSERT_EQ(0U, response.error.message.find("Bad Request."));
+  ASSERT_NE(std::string::npos, response.error.message.find("https://research.stlouisfed.org/"));
+}
+
+
+TEST(JsonResponseParser, DecodesValues) {
+  FREDCPP_TESTCASE("Decodes escapes and keeps scalars as text, skipping nested values");
+  using namespace fredcpp;
+
+  ApiResponse response;
+  ASSERT_TRUE(parseJson(
+      "{ \"count\" : 2, \"ok\": true, \"none\": null, \"extra\": {\"a\": [1, {\"b\": \"]\"}]},\n"
+      "  \"seriess\": [\n"
+      "    {\"id\": \"A\\\"B\\\\C\", \"title\": \"\\u00e9\\ud83d\\ude00\\n\", \"tags\": [\"x\"], \"popularity\": -1.5e3},\n"
+      "    {}\n"
+      "  ],\n"
+      "  \"more\": [\"not\", \"entities\"]\n"
+      "}\n", response));
+
+  ASSERT_EQ("seriess", response.result.name);
+  ASSERT_EQ("2", response.result.attribute("count"));
+  ASSERT_EQ("true", response.result.attribute("ok"));
+  ASSERT_EQ("", response.result.attribute("none"));
+
+  ASSERT_EQ(2U, response.entities.size());
+  ASSERT_EQ("series", response.entities[0].name);
+  ASSERT_EQ("A\"B\\C", response.entities[0].attribute("id"));
+  ASSERT_EQ("\xC3\xA9\xF0\x9F\x98\x80\n", response.entities[0].attribute("title"));
+  ASSERT_EQ("-1.5e3", response.entities[0].attribute("popularity"));
+  ASSERT_EQ("", response.entities[0].attribute("tags"));
+  ASSERT_EQ("series", response.entities[1].name);
+
+  ASSERT_TRUE(parseJson("{\"vintage_dates\": [\"1958-12-21\", \"1959-02-19\"]}", response));
+  ASSERT_EQ(2U, response.entities.size());
+  ASSERT_EQ("vintage_date", response.entities[1].name);
+  ASSERT_EQ("1959-02-19", response.entities[1].value);
+
+  ASSERT_EQ("category", external::JsonResponseParser::getEntityName("categories"));
+}
+
+
+TEST(JsonResponseParser, RejectsMalformedContent) {
+  FREDCPP_TESTCASE("Fails on malformed or truncated content");
+  using namespace fredcpp;
+
+  const char* malformed[] = {
+    "",
+    "[]",
+    "{\"count\": 1",
+    "{\"count\" 1}",
+    "{\"count\": 1,}",
+    "{\"title\": \"unterminated}",
+    "{\"title\": \"bad \\q escape\"}",
+    "{\"seriess\": [{\"id\": \"A\"}, ]}",
+    "{\"seriess\": [{\"id\": \"A\"}} ",
+    "{\"count\": 1} trailing",
+  };
+
+  for (std::size_t n = 0; n < sizeof(malformed) / sizeof(malformed[0]); ++n) {
+    ApiResponse response;
+    ASSERT_FALSE(parseJson(malformed[n], response)) << malformed[n];
+  }
+
+  ApiResponse response;
+  ASSERT_TRUE(parseJson(" { } ", response));
+}
+
+
+TEST(JsonResponseParser, AcceptsJsonContentType) {
+  FREDCPP_TESTCASE("Accepts JSON content type only");
+  using namespace fredcpp;
+
+  external::JsonResponseParser& parser(external::JsonResponseParser::getInstance());
+
+  ASSERT_TRUE(parser.accepts("application/json; charset=UTF-8"));
+  ASSERT_FALSE(parser.accepts("text/xml; charset=UTF-8"));
+  ASSERT_FALSE(external::StreamingXmlParser::getInstance().accepts("application/json"));
+}
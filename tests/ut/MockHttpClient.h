@@ -28,6 +28,10 @@
 #include <fredcpp/internal/HttpRequestExecutor.h>
 #include <fredcpp/internal/HttpResponse.h>
 
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
 #include <string>
 
 
@@ -43,6 +47,7 @@ public:
     MOCK_BAD_URI,
     MOCK_BAD_REQUEST,
     MOCK_BAD_CONTENT_TYPE,
+    MOCK_OK_PAGED,
   } ExecuteMode;
 
   static MockHttpClient& getInstance() {
@@ -63,14 +68,39 @@ public:
     return (*this);
   }
 
+  /// Sets content-type of OK responses, XML when empty.
   MockHttpClient& withContentType(const std::string& type) {
     contentType_ = type;
     return (*this);
   }
 
+  /// Sets ETag of OK responses; requests matching it get HTTP_NOT_MODIFIED.
+  MockHttpClient& withETag(const std::string& eTag) {
+    eTag_ = eTag;
+    return (*this);
+  }
+
+  /// Sets total count of entities and default page size of MOCK_OK_PAGED.
+  MockHttpClient& withPaging(unsigned long count, unsigned long limit) {
+    pagedCount_ = count;
+    pagedLimit_ = limit;
+    return (*this);
+  }
+
+  unsigned long getExecuteCount() const {
+    return (executeCount_);
+  }
+
+  void resetExecuteCount() {
+    executeCount_ = 0;
+  }
+
 private:
   MockHttpClient()
-    : executeMode_(MOCK_OK) {
+    : executeMode_(MOCK_OK)
+    , executeCount_(0)
+    , pagedCount_(0)
+    , pagedLimit_(0) {
   }
 
   bool loadContent(std::ostream& contentStream);
@@ -78,11 +108,16 @@ private:
   bool execute_OK(const internal::HttpRequest& request, internal::HttpResponse& response);
   bool execute_ERROR(const internal::HttpRequest& request, internal::HttpResponse& response);
   bool execute_FAIL(const internal::HttpRequest& request, internal::HttpResponse& response);
+  bool execute_OK_PAGED(const internal::HttpRequest& request, internal::HttpResponse& response);
 
 
   ExecuteMode executeMode_;
   std::string dataFile_;
   std::string contentType_;
+  std::string eTag_;
+  std::atomic<unsigned long> executeCount_;
+  unsigned long pagedCount_;
+  unsigned long pagedLimit_;
 };
 
 
@@ -97,6 +132,8 @@ namespace fredcpp {
 inline bool MockHttpClient::execute(const internal::HttpRequest& request, internal::HttpResponse& response) {
   bool result(false);
 
+  ++executeCount_;
+
   switch (executeMode_) {
   case MOCK_OK:
     result = execute_OK(request, response);
@@ -110,6 +147,10 @@ inline bool MockHttpClient::execute(const internal::HttpRequest& request, intern
     result = execute_FAIL(request, response);
     break;
 
+  case MOCK_OK_PAGED:
+    result = execute_OK_PAGED(request, response);
+    break;
+
   default:
     assert(false && "Unsupported ExecuteMode");
   }
@@ -146,8 +187,20 @@ inline bool MockHttpClient::execute_OK(const internal::HttpRequest& request, int
 
   response.clear();
 
+  if (!eTag_.empty()) {
+    response.setHeader("ETag", eTag_);
+
+    internal::KeyValueMap::const_iterator itFound(request.getHeaders().find("If-None-Match"));
+
+    if (itFound != request.getHeaders().end()
+        && eTag_ == itFound->second) {
+      response.setHttpStatus(internal::HttpResponse::HTTP_NOT_MODIFIED);
+      return (false);
+    }
+  }
+
   response.setHttpStatus(internal::HttpResponse::HTTP_OK);
-  response.setContentType("text/xml; charset=UTF-8");
+  response.setContentType(contentType_.empty() ? "text/xml; charset=UTF-8" : contentType_);
 
   loadContent(response.getContentStream());
 
@@ -176,6 +229,41 @@ inline bool MockHttpClient::execute_FAIL(const internal::HttpRequest& request, i
 }
 
 
+
+inline bool MockHttpClient::execute_OK_PAGED(const internal::HttpRequest& request, internal::HttpResponse& response) {
+  response.clear();
+
+  response.setHttpStatus(internal::HttpResponse::HTTP_OK);
+  response.setContentType("text/xml; charset=UTF-8");
+
+  unsigned long offset(0);
+  unsigned long limit(pagedLimit_);
+
+  internal::ParamMap::const_iterator itFound;
+
+  if ((itFound = request.getParams().find("offset")) != request.getParams().end()) {
+    offset = std::strtoul(itFound->second.c_str(), NULL, 10);
+  }
+
+  if ((itFound = request.getParams().find("limit")) != request.getParams().end()) {
+    limit = std::strtoul(itFound->second.c_str(), NULL, 10);
+  }
+
+  std::ostream& content(response.getContentStream());
+
+  content << "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
+          << "<seriess count=\"" << pagedCount_ << "\" offset=\"" << offset
+          << "\" limit=\"" << limit << "\">\n";
+
+  for (unsigned long n = offset; n < pagedCount_ && n < offset + limit; ++n) {
+    content << "  <series id=\"S" << n << "\" title=\"Series " << n << "\"/>\n";
+  }
+
+  content << "</seriess>\n";
+
+  return (internal::HttpResponse::HTTP_OK == response.getHttpStatus());
+}
+
 } // namespace fredcpp
 
 #endif // FREDCPP_MOCKHTTPCLIENT_H_
@@ -0,0 +1,218 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-testutils.h>
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/ObservationSeries.h>
+#include <fredcpp/Api.h>
+#include <fredcpp/ApiRequestBuilder.h>
+
+#include <fredcpp/external/StreamingXmlParser.h>
+
+#include <MockHttpClient.h>
+#include <MockLogger.h>
+
+#include <cstdlib>
+
+
+TEST(ObservationSeries, ConvertsDates) {
+  FREDCPP_TESTCASE("Converts dates to day numbers and back");
+  using namespace fredcpp;
+
+  ASSERT_EQ(0, ObservationSeries::toDayNumber("1970-01-01"));
+  ASSERT_EQ(-1, ObservationSeries::toDayNumber("1969-12-31"));
+  ASSERT_EQ(16132, ObservationSeries::toDayNumber("2014-03-03"));
+
+  const char* dates[] = { "1776-07-04", "1900-02-28", "2000-02-29", "2014-03-03", "9999-12-31" };
+
+  for (std::size_t n = 0; n < sizeof(dates) / sizeof(dates[0]); ++n) {
+    ASSERT_EQ(dates[n], ObservationSeries::toDateString(ObservationSeries::toDayNumber(dates[n])));
+  }
+
+  ASSERT_EQ(ObservationSeries::INVALID_DAY, ObservationSeries::toDayNumber("2014-3-3"));
+  ASSERT_EQ(ObservationSeries::INVALID_DAY, ObservationSeries::toDayNumber("2014-13-01"));
+}
+
+
+TEST(ObservationSeries, StoresMissingValueAsNaN) {
+  FREDCPP_TESTCASE("Stores missing value '.' as NaN");
+  using namespace fredcpp;
+
+  ApiEntity entity;
+  entity.name = "observation";
+  entity.attributes["date"] = "2014-03-03";
+  entity.attributes["value"] = ".";
+
+  ObservationSeries series;
+  series.onEntity(entity);
+
+  entity.attributes["value"] = "1.5";
+  series.onEntity(entity);
+
+  ASSERT_EQ(2U, series.size());
+  ASSERT_TRUE(series.isMissing(0));
+  ASSERT_FALSE(series.isMissing(1));
+  ASSERT_DOUBLE_EQ(1.5, series.value(1));
+}
+
+
+TEST(ObservationSeries, StoresConstantRealtimeOnce) {
+  FREDCPP_TESTCASE("Stores realtime period once until it varies");
+  using namespace fredcpp;
+
+  ObservationSeries series;
+  series.append(1, 1.0, 100, 200);
+  series.append(2, 2.0, 100, 200);
+  ASSERT_TRUE(series.hasConstantRealtime());
+  ASSERT_EQ(100, series.realtimeStart(1));
+
+  series.append(3, 3.0, 150, 200);
+  ASSERT_FALSE(series.hasConstantRealtime());
+  ASSERT_EQ(100, series.realtimeStart(0));
+  ASSERT_EQ(100, series.realtimeStart(1));
+  ASSERT_EQ(150, series.realtimeStart(2));
+  ASSERT_EQ(200, series.realtimeEnd(2));
+}
+
+
+TEST(ObservationSeries, FillsFromApiResponse) {
+  FREDCPP_TESTCASE("Fills observations directly from the parsed response");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+  ObservationSeries series;
+
+  bool result = api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), response, series);
+  ASSERT_TRUE(result);
+
+  ASSERT_EQ(10U, series.size());
+  ASSERT_EQ("2014-03-03", ObservationSeries::toDateString(series.date(0)));
+  ASSERT_DOUBLE_EQ(1.3924, series.value(9));
+  ASSERT_TRUE(series.hasConstantRealtime());
+  ASSERT_EQ("2014-05-02", ObservationSeries::toDateString(series.realtimeEnd(9)));
+}
+
+
+TEST(ObservationSeries, DecodesValuesAsStrtod) {
+  FREDCPP_TESTCASE("Decodes values same as strtod");
+  using namespace fredcpp;
+
+  const char* values[] = { "0", "1.5", "-0.25", "1234.5678", "0.1", "3.", "-.5",
+                           "12345678901234567", "123456789.0123456789", "1e3",
+                           " 42" };
+
+  for (std::size_t n = 0; n < sizeof(values) / sizeof(values[0]); ++n) {
+    ASSERT_EQ(std::strtod(values[n], NULL), ObservationSeries::toValue(values[n])) << values[n];
+  }
+
+  double missing = ObservationSeries::toValue(".");
+  ASSERT_NE(missing, missing);
+
+  double malformed = ObservationSeries::toValue("-");
+  ASSERT_NE(malformed, malformed);
+}
+
+
+TEST(ObservationSeries, RejectsTrailingCharactersInValues) {
+  FREDCPP_TESTCASE("Decodes a number followed by other characters as NaN");
+  using namespace fredcpp;
+
+  const char* values[] = { "1.2abc", "17.3 ", "1e3x", "12345678901234567abc", "1,5" };
+
+  for (std::size_t n = 0; n < sizeof(values) / sizeof(values[0]); ++n) {
+    double value = ObservationSeries::toValue(values[n]);
+    ASSERT_NE(value, value) << values[n];
+  }
+}
+
+
+TEST(ObservationSeries, RejectsMalformedDates) {
+  FREDCPP_TESTCASE("Rejects malformed dates");
+  using namespace fredcpp;
+
+  const char* dates[] = { "", "2014-03-0", "2014-03-031", "2014/03/03", "2014-03-3a",
+                          "2O14-03-03", "2014-00-01", "2014-01-00", "2014-01-32",
+                          "2014-03-03\xB0", "\xB0""014-03-03" };
+
+  for (std::size_t n = 0; n < sizeof(dates) / sizeof(dates[0]); ++n) {
+    ASSERT_EQ(ObservationSeries::INVALID_DAY, ObservationSeries::toDayNumber(dates[n])) << dates[n];
+  }
+}
+
+
+TEST(ObservationSeries, DecodesResponseColumns) {
+  FREDCPP_TESTCASE("Decodes attribute columns of parsed response");
+  using namespace fredcpp;
+
+  Api api;
+
+  api.withExecutor(MockHttpClient::getInstance())
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance());
+
+  MockHttpClient::getInstance()
+    .withExecuteMode(MockHttpClient::MOCK_OK)
+    .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+  ASSERT_TRUE(api.get(ApiRequestBuilder::SeriesObservations("TEST-ID"), response));
+
+  ObservationSeries expected;
+  for (std::size_t n = 0; n < response.entities.size(); ++n) {
+    expected.onEntity(response.entities[n]);
+  }
+
+  ObservationSeries series;
+  series.assign(response);
+
+  ASSERT_EQ(expected.size(), series.size());
+  ASSERT_TRUE(expected.dates() == series.dates());
+  ASSERT_TRUE(series.hasConstantRealtime());
+  ASSERT_EQ(expected.realtimeStart(0), series.realtimeStart(0));
+
+  for (std::size_t n = 0; n < series.size(); ++n) {
+    ASSERT_EQ(expected.isMissing(n), series.isMissing(n));
+    if (!series.isMissing(n)) {
+      ASSERT_EQ(expected.value(n), series.value(n));
+    }
+  }
+
+  std::vector<double> missing;
+  ObservationSeries::toValues(response.entities, "no_such_attribute", missing);
+  ASSERT_EQ(response.entities.size(), missing.size());
+  ASSERT_TRUE(missing[0] != missing[0]);
+}
@@ -0,0 +1,191 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-testutils.h>
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/external/PugiXmlParser.h>
+#include <fredcpp/ApiResponse.h>
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+std::string readDataFile(const std::string& path) {
+  std::ifstream ifs(fredcpp::test::harmonizePath(path).c_str());
+  std::ostringstream content;
+  content << ifs.rdbuf();
+  return (content.str());
+}
+
+} // namespace
+
+
+TEST(PugiXmlParser, ReusesMemoryBetweenParses) {
+  FREDCPP_TESTCASE("Keeps the parse buffer for reuse up to the high-water mark");
+  using namespace fredcpp;
+
+  external::PugiXmlParser& parser(external::PugiXmlParser::getInstance());
+  std::size_t highWaterMark(parser.getMemoryHighWaterMark());
+
+  std::string xml(readDataFile("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+  std::istringstream xmlStream(xml);
+  ASSERT_TRUE(parser.parse(xmlStream, response));
+  ASSERT_EQ(10U, response.entities.size());
+  ASSERT_EQ("2014-03-14", response.entities[9].attribute("date"));
+  ASSERT_GE(parser.getPooledMemory(), xml.size());
+
+  std::string content(xml);
+  response.clear();
+  ASSERT_TRUE(parser.parseInPlace(&content[0], content.size(), response));
+  ASSERT_EQ(10U, response.entities.size());
+
+  parser.withMemoryHighWaterMark(0);
+  ASSERT_EQ(0U, parser.getPooledMemory());
+
+  xmlStream.clear();
+  xmlStream.str(xml);
+  ASSERT_TRUE(parser.parse(xmlStream, response));
+  ASSERT_EQ(0U, parser.getPooledMemory());
+
+  parser.withMemoryHighWaterMark(highWaterMark);
+}
+
+
+TEST(PugiXmlParser, ReusesPugixmlPagesWithMemoryPool) {
+  FREDCPP_TESTCASE("Keeps pugixml pages for reuse once the page pool is installed");
+  using namespace fredcpp;
+
+  pugi::xml_document doc;
+  ASSERT_TRUE(doc.load("<a><b/></a>"));
+
+  pugi::allocation_function allocate(pugi::get_memory_allocation_function());
+
+  external::PugiXmlParser::installMemoryPool();
+  external::PugiXmlParser::installMemoryPool();
+
+  ASSERT_NE(allocate, pugi::get_memory_allocation_function());
+
+  // pages allocated before the install are freed as before
+  doc.reset();
+
+  external::PugiXmlParser& parser(external::PugiXmlParser::getInstance());
+  parser.releaseMemory();
+  ASSERT_EQ(0U, parser.getPooledMemory());
+
+  std::string xml(readDataFile("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+  std::string content(xml);
+  ASSERT_TRUE(parser.parseInPlace(&content[0], content.size(), response));
+
+  std::size_t pooled(parser.getPooledMemory());
+  ASSERT_GT(pooled, 0U);
+
+  content = xml;
+  response.clear();
+  ASSERT_TRUE(parser.parseInPlace(&content[0], content.size(), response));
+  ASSERT_EQ(10U, response.entities.size());
+  ASSERT_EQ(pooled, parser.getPooledMemory());
+
+  parser.releaseMemory();
+  ASSERT_EQ(0U, parser.getPooledMemory());
+}
+
+
+TEST(PugiXmlParser, CollectsParseStats) {
+  FREDCPP_TESTCASE("Collects statistics of parsed bytes");
+  using namespace fredcpp;
+
+  external::PugiXmlParser& parser(external::PugiXmlParser::getInstance());
+  parser.resetParseStats();
+
+  std::string xml(readDataFile("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+  for (int n = 0; n < 2; ++n) {
+    std::string content(xml);
+    ASSERT_TRUE(parser.parseInPlace(&content[0], content.size(), response));
+  }
+
+  ASSERT_EQ(1U, parser.getLastParseStats().parses);
+  ASSERT_EQ(xml.size(), parser.getLastParseStats().bytesParsed);
+  ASSERT_EQ(2U, parser.getTotalParseStats().parses);
+  ASSERT_EQ(2 * xml.size(), parser.getTotalParseStats().bytesParsed);
+}
+
+
+namespace {
+
+void parseRepeatedly(const std::string& xml, std::size_t count, std::atomic<unsigned long>& failures) {
+  fredcpp::external::PugiXmlParser& parser(fredcpp::external::PugiXmlParser::getInstance());
+
+  for (std::size_t n = 0; n < count; ++n) {
+    fredcpp::ApiResponse response;
+    std::istringstream xmlStream(xml);
+
+    if (!parser.parse(xmlStream, response)
+        || 10U != response.entities.size()
+        || 1U != parser.getLastParseStats().parses) {
+      ++failures;
+    }
+  }
+}
+
+} // namespace
+
+
+TEST(PugiXmlParser, ParsesConcurrently) {
+  FREDCPP_TESTCASE("Parses in many threads at once, sharing the pooled memory");
+  using namespace fredcpp;
+
+  external::PugiXmlParser& parser(external::PugiXmlParser::getInstance());
+  parser.resetParseStats();
+
+  std::string xml(readDataFile("data/response_series_observations_1.xml"));
+
+  std::atomic<unsigned long> failures(0);
+  std::vector<std::thread> threads;
+
+  for (std::size_t n = 0; n < 4; ++n) {
+    threads.push_back(std::thread(parseRepeatedly, std::cref(xml), 100, std::ref(failures)));
+  }
+
+  for (std::size_t n = 0; n < threads.size(); ++n) {
+    threads[n].join();
+  }
+
+  ASSERT_EQ(0UL, failures.load());
+  ASSERT_EQ(400U, parser.getTotalParseStats().parses);
+}
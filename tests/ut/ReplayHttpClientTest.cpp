@@ -0,0 +1,273 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-testutils.h>
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/Api.h>
+#include <fredcpp/ApiLog.h>
+#include <fredcpp/ApiRequestBuilder.h>
+#include <fredcpp/external/RecordingHttpClient.h>
+#include <fredcpp/external/ReplayHttpClient.h>
+#include <fredcpp/external/StreamingXmlParser.h>
+#include <fredcpp/internal/HttpRequest.h>
+#include <fredcpp/internal/HttpResponse.h>
+#include <fredcpp/internal/Request.h>
+
+#include <MockHttpClient.h>
+#include <MockLogger.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+const std::string ARCHIVE_PATH("replay-ut.replay");
+const std::string OBSERVATIONS_URI("https://api.stlouisfed.org/fred/series/observations");
+
+
+fredcpp::internal::HttpRequest makeRequest(const std::string& seriesId) {
+  fredcpp::internal::HttpRequest request;
+  request.withURI(OBSERVATIONS_URI)
+         .withParams(fredcpp::internal::Request()
+                     .with("series_id", seriesId)
+                     .with("api_key", "abcdef"));
+  return (request);
+}
+
+
+fredcpp::MockHttpClient& resetMock() {
+  fredcpp::ApiLog::getInstance().configure()
+                                .withLogger(&fredcpp::MockLogger::getInstance());
+
+  fredcpp::MockHttpClient& mock(fredcpp::MockHttpClient::getInstance());
+
+  mock.withExecuteMode(fredcpp::MockHttpClient::MOCK_OK)
+      .withDataContent(fredcpp::test::harmonizePath("data/response_series_observations_1.xml"))
+      .withETag("");
+
+  return (mock);
+}
+
+
+/// Archive with recorded responses of the series.
+void recordArchive(const std::vector<std::string>& seriesIds) {
+  std::remove(ARCHIVE_PATH.c_str());
+
+  fredcpp::external::RecordingHttpClient recorder(resetMock(), ARCHIVE_PATH);
+
+  for (std::size_t n = 0; n < seriesIds.size(); ++n) {
+    fredcpp::internal::HttpResponse response;
+    recorder.execute(makeRequest(seriesIds[n]), response);
+  }
+}
+
+
+std::string readFile(const std::string& path) {
+  std::ifstream ifs(path.c_str(), std::ios::in | std::ios::binary);
+  std::ostringstream buf;
+  buf << ifs.rdbuf();
+  return (buf.str());
+}
+
+} // namespace
+
+
+TEST(ReplayHttpClient, ReplaysRecordedResponses) {
+  FREDCPP_TESTCASE("Replays responses recorded by RecordingHttpClient");
+  using namespace fredcpp;
+
+  std::remove(ARCHIVE_PATH.c_str());
+
+  std::string recordedContent;
+  {
+    external::RecordingHttpClient recorder(resetMock(), ARCHIVE_PATH);
+    ASSERT_TRUE(recorder.good());
+
+    internal::HttpResponse response;
+    ASSERT_TRUE(recorder.execute(makeRequest("SERIES-A"), response));
+    ASSERT_TRUE(recorder.execute(makeRequest("SERIES-B"), response));
+    recordedContent = response.getContent();
+
+    ASSERT_EQ(2U, recorder.getRecordCount());
+  }
+
+  std::string archive(readFile(ARCHIVE_PATH));
+  ASSERT_EQ(0U, archive.find(internal::ReplayArchive::SIGNATURE));
+  ASSERT_EQ(std::string::npos, archive.find("abcdef"));
+
+  external::ReplayHttpClient replay(ARCHIVE_PATH);
+  ASSERT_EQ(2U, replay.size());
+
+  internal::HttpResponse response;
+  ASSERT_TRUE(replay.execute(makeRequest("SERIES-B"), response));
+  ASSERT_EQ(internal::HttpResponse::HTTP_OK, response.getHttpStatus());
+  ASSERT_TRUE(response.isXmlContent());
+  ASSERT_EQ(recordedContent, response.getContent());
+
+  ASSERT_FALSE(replay.execute(makeRequest("SERIES-C"), response));
+  ASSERT_EQ(internal::HttpResponse::HTTP_NOT_FOUND, response.getHttpStatus());
+
+  ASSERT_EQ(1U, replay.getReplayStats().replayed);
+  ASSERT_EQ(1U, replay.getReplayStats().misses);
+}
+
+
+TEST(ReplayHttpClient, AppendsToArchive) {
+  FREDCPP_TESTCASE("Appends records to existing archive, later record replaces earlier");
+  using namespace fredcpp;
+
+  recordArchive(std::vector<std::string>(1, "SERIES-A"));
+
+  {
+    external::RecordingHttpClient recorder(resetMock(), ARCHIVE_PATH);
+
+    internal::HttpResponse response;
+    recorder.execute(makeRequest("SERIES-A"), response);
+    recorder.execute(makeRequest("SERIES-B"), response);
+  }
+
+  std::string archive(readFile(ARCHIVE_PATH));
+  ASSERT_EQ(archive.rfind(internal::ReplayArchive::SIGNATURE), 0U);
+
+  external::ReplayHttpClient replay;
+  ASSERT_TRUE(replay.load(ARCHIVE_PATH));
+  ASSERT_EQ(2U, replay.size());
+}
+
+
+TEST(ReplayHttpClient, RejectsMalformedArchive) {
+  FREDCPP_TESTCASE("Fails to load malformed archive");
+  using namespace fredcpp;
+
+  resetMock();
+
+  {
+    std::ofstream ofs(ARCHIVE_PATH.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    ofs << internal::ReplayArchive::SIGNATURE << "\n"
+        << "record 200 1000\n"
+        << "key " << OBSERVATIONS_URI << "\n"
+        << "\n"
+        << "truncated";
+  }
+
+  external::ReplayHttpClient replay;
+  ASSERT_FALSE(replay.load(ARCHIVE_PATH));
+  ASSERT_FALSE(replay.load("no-such-archive.replay"));
+}
+
+
+TEST(ReplayHttpClient, ServesApiRequests) {
+  FREDCPP_TESTCASE("Serves recorded Api requests, also as a batch, with other API key");
+  using namespace fredcpp;
+
+  std::remove(ARCHIVE_PATH.c_str());
+
+  ApiRequestVector requests;
+  requests.push_back(ApiRequestBuilder::SeriesObservations("SERIES-A"));
+  requests.push_back(ApiRequestBuilder::SeriesObservations("SERIES-B"));
+
+  {
+    external::RecordingHttpClient recorder(resetMock(), ARCHIVE_PATH);
+
+    Api api;
+    api.withExecutor(recorder)
+       .withParser(external::StreamingXmlParser::getInstance())
+       .withLogger(MockLogger::getInstance())
+       .withKey("abcdef");
+
+    std::vector<ApiResponse> responses;
+    ASSERT_TRUE(api.getBatch(requests, responses));
+    ASSERT_EQ(2U, recorder.getRecordCount());
+  }
+
+  external::ReplayHttpClient replay(ARCHIVE_PATH);
+
+  Api api;
+  api.withExecutor(replay)
+     .withParser(external::StreamingXmlParser::getInstance())
+     .withLogger(MockLogger::getInstance())
+     .withKey("0123456789");
+
+  ApiResponse response;
+  ASSERT_TRUE(api.get(requests[1], response));
+  ASSERT_EQ(10U, response.entities.size());
+
+  std::vector<ApiResponse> responses;
+  ASSERT_TRUE(api.getBatch(requests, responses));
+  ASSERT_EQ(10U, responses[0].entities.size());
+
+  ASSERT_FALSE(api.get(ApiRequestBuilder::SeriesObservations("SERIES-C"), response));
+  ASSERT_FALSE(response.good());
+
+  ASSERT_EQ(3U, replay.getReplayStats().replayed);
+  ASSERT_EQ(1U, replay.getReplayStats().misses);
+}
+
+
+TEST(ReplayHttpClient, InjectsFaultsDeterministically) {
+  FREDCPP_TESTCASE("Injects errors and failures at the rates, repeatable by seed");
+  using namespace fredcpp;
+
+  recordArchive(std::vector<std::string>(1, "SERIES-A"));
+
+  external::ReplayHttpClient replay(ARCHIVE_PATH);
+  replay.withErrorRate(0.25, internal::HttpResponse::HTTP_SERVICE_UNAVAILABLE)
+        .withFailureRate(0.25)
+        .withSeed(7);
+
+  const int COUNT(400);
+  std::vector<int> statuses;
+  internal::HttpResponse response;
+
+  for (int n = 0; n < COUNT; ++n) {
+    replay.execute(makeRequest("SERIES-A"), response);
+    statuses.push_back(response.getHttpStatus());
+  }
+
+  external::ReplayHttpClient::ReplayStats stats(replay.getReplayStats());
+  ASSERT_EQ(static_cast<unsigned long>(COUNT), stats.replayed + stats.injectedErrors + stats.injectedFailures);
+  ASSERT_NEAR(COUNT / 4, static_cast<int>(stats.injectedErrors), COUNT / 10);
+  ASSERT_NEAR(COUNT / 4, static_cast<int>(stats.injectedFailures), COUNT / 10);
+
+  replay.withSeed(7);
+
+  for (int n = 0; n < COUNT; ++n) {
+    replay.execute(makeRequest("SERIES-A"), response);
+    ASSERT_EQ(statuses[n], response.getHttpStatus());
+
+    if (internal::HttpResponse::HTTP_SERVICE_UNAVAILABLE == response.getHttpStatus()) {
+      ASSERT_NE(std::string::npos, response.getContent().find("code=\"503\""));
+    }
+  }
+
+  replay.withoutFaults();
+  ASSERT_TRUE(replay.execute(makeRequest("SERIES-A"), response));
+}
@@ -0,0 +1,218 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/external/SimpleLogger.h>
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+
+namespace {
+
+std::ostream& messageOnlyFormat(std::ostream& os, fredcpp::internal::LogLevel::Level level, const std::string& message, const fredcpp::internal::LogContext& context) {
+  os << message;
+  return (os);
+}
+
+
+/// String buffer that holds up the writer on flush until opened.
+class GatedStringBuf : public std::stringbuf {
+public:
+  GatedStringBuf()
+    : open_(false) {
+  }
+
+  void open() {
+    open_.store(true);
+  }
+
+protected:
+  virtual int sync() {
+    while (!open_.load()) {
+      std::this_thread::yield();
+    }
+    return (std::stringbuf::sync());
+  }
+
+private:
+  std::atomic<bool> open_;
+};
+
+
+std::size_t countLines(const std::string& str) {
+  std::size_t count(0);
+
+  for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+    if ('\n' == *it) {
+      ++count;
+    }
+  }
+
+  return (count);
+}
+
+
+void logWarnings(fredcpp::external::SimpleLogger& logger, std::size_t count) {
+  fredcpp::internal::LogContext context(__FILE__, __LINE__, "logWarnings");
+
+  for (std::size_t n = 0; n < count; ++n) {
+    std::ostringstream message;
+    message << "warning " << n;
+    logger.logMessage(fredcpp::internal::LogLevel::LOG_WARN, message.str(), context);
+  }
+}
+
+
+void restoreDefaults(fredcpp::external::SimpleLogger& logger) {
+  logger.stopAsync();
+  logger.setFormatter(fredcpp::external::defaultLogFormat);
+  logger.setOutput(std::cerr);
+  logger.setOutput(fredcpp::internal::LogLevel::LOG_INFO, std::cout);
+}
+
+} // namespace
+
+
+TEST(SimpleLogger, WritesQueuedMessagesInOrder) {
+  FREDCPP_TESTCASE("Writes asynchronously logged messages in order, all written on flush and stop");
+  using namespace fredcpp;
+
+  external::SimpleLogger& logger(external::SimpleLogger::getInstance());
+  std::ostringstream output;
+
+  logger.setFormatter(messageOnlyFormat);
+  logger.setOutput(output);
+
+  logger.startAsync(16, external::SimpleLogger::OVERFLOW_BLOCK);
+  ASSERT_TRUE(logger.isAsync());
+
+  logWarnings(logger, 100);
+  logger.flush();
+
+  external::SimpleLogger::AsyncStats stats(logger.getAsyncStats());
+  ASSERT_EQ(100U, stats.queued);
+  ASSERT_EQ(100U, stats.written);
+  ASSERT_EQ(0U, stats.dropped);
+
+  std::string content(output.str());
+  ASSERT_EQ(100U, countLines(content));
+  ASSERT_EQ(0U, content.find("warning 0\nwarning 1\n"));
+  ASSERT_NE(std::string::npos, content.find("warning 98\nwarning 99\n"));
+
+  logWarnings(logger, 10);
+  logger.stopAsync();
+  ASSERT_FALSE(logger.isAsync());
+  ASSERT_EQ(110U, countLines(output.str()));
+
+  logWarnings(logger, 1);
+  ASSERT_EQ(111U, countLines(output.str()));
+
+  restoreDefaults(logger);
+}
+
+
+TEST(SimpleLogger, CountsDroppedMessages) {
+  FREDCPP_TESTCASE("Drops and counts messages logged while the queue is full");
+  using namespace fredcpp;
+
+  external::SimpleLogger& logger(external::SimpleLogger::getInstance());
+  GatedStringBuf outputBuf;
+  std::ostream output(&outputBuf);
+
+  logger.setFormatter(messageOnlyFormat);
+  logger.setOutput(output);
+
+  logger.startAsync(2, external::SimpleLogger::OVERFLOW_DROP);
+
+  // writer is held up at most after the first batch
+  logWarnings(logger, 1000);
+
+  outputBuf.open();
+  logger.flush();
+
+  external::SimpleLogger::AsyncStats stats(logger.getAsyncStats());
+  ASSERT_GT(stats.dropped, 500U);
+  ASSERT_EQ(1000U, stats.queued + stats.dropped);
+  ASSERT_EQ(stats.queued, stats.written);
+  ASSERT_EQ(stats.written, countLines(outputBuf.str()));
+
+  restoreDefaults(logger);
+}
+
+
+TEST(SimpleLogger, BlocksOrSamplesOnOverflow) {
+  FREDCPP_TESTCASE("Waits for room on overflow when blocking, keeps some of the messages when sampling");
+  using namespace fredcpp;
+
+  external::SimpleLogger& logger(external::SimpleLogger::getInstance());
+
+  {
+    GatedStringBuf outputBuf;
+    std::ostream output(&outputBuf);
+
+    logger.setFormatter(messageOnlyFormat);
+    logger.setOutput(output);
+    logger.startAsync(2, external::SimpleLogger::OVERFLOW_BLOCK);
+
+    std::thread producer(logWarnings, std::ref(logger), 100);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    outputBuf.open();
+    producer.join();
+
+    logger.stopAsync();
+
+    external::SimpleLogger::AsyncStats stats(logger.getAsyncStats());
+    ASSERT_EQ(100U, stats.written);
+    ASSERT_EQ(0U, stats.dropped);
+    ASSERT_EQ(100U, countLines(outputBuf.str()));
+  }
+
+  {
+    GatedStringBuf outputBuf;
+    std::ostream output(&outputBuf);
+
+    logger.setOutput(output);
+    logger.startAsync(2, external::SimpleLogger::OVERFLOW_SAMPLE, 10);
+
+    std::thread producer(logWarnings, std::ref(logger), 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    outputBuf.open();
+    producer.join();
+
+    logger.stopAsync();
+
+    external::SimpleLogger::AsyncStats stats(logger.getAsyncStats());
+    ASSERT_GT(stats.dropped, 0U);
+    ASSERT_GT(stats.written, 2U);
+    ASSERT_EQ(1000U, stats.written + stats.dropped);
+    ASSERT_EQ(stats.written, countLines(outputBuf.str()));
+  }
+
+  restoreDefaults(logger);
+}
@@ -0,0 +1,166 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-testutils.h>
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/external/StreamingXmlParser.h>
+#include <fredcpp/ApiResponse.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+std::string readDataFile(const std::string& path) {
+  std::ifstream ifs(fredcpp::test::harmonizePath(path).c_str());
+  std::ostringstream content;
+  content << ifs.rdbuf();
+  return (content.str());
+}
+
+
+bool parseInChunks(const std::string& xml, std::size_t chunkSize,
+                   fredcpp::ApiResponse& response, fredcpp::ApiEntityHandler* handler = NULL) {
+  fredcpp::external::StreamingXmlParser& parser(fredcpp::external::StreamingXmlParser::getInstance());
+
+  parser.beginParse(response, handler);
+
+  for (std::size_t pos = 0; pos < xml.size(); pos += chunkSize) {
+    parser.parseChunk(xml.data() + pos, std::min(chunkSize, xml.size() - pos));
+  }
+
+  return (parser.endParse());
+}
+
+
+class CollectingEntityHandler : public fredcpp::ApiEntityHandler {
+public:
+  void onEntity(const fredcpp::ApiEntity& entity) {
+    entities.push_back(entity);
+  }
+
+  std::vector<fredcpp::ApiEntity> entities;
+};
+
+} // namespace
+
+
+TEST(StreamingXmlParser, ParsesResultAndEntities) {
+  FREDCPP_TESTCASE("Parses result attributes and entities of the response");
+  using namespace fredcpp;
+
+  std::string xml(readDataFile("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+  ASSERT_TRUE(parseInChunks(xml, xml.size(), response));
+
+  ASSERT_EQ("observations", response.result.name);
+  ASSERT_EQ("10", response.result.attribute("limit"));
+
+  ASSERT_EQ(10U, response.entities.size());
+  ASSERT_EQ("observation", response.entities[0].name);
+  ASSERT_EQ("2014-03-03", response.entities[0].attribute("date"));
+  ASSERT_EQ("1.3924", response.entities[9].attribute("value"));
+}
+
+
+TEST(StreamingXmlParser, ParsesContentSplitInChunks) {
+  FREDCPP_TESTCASE("Produces the same response regardless of chunk boundaries");
+  using namespace fredcpp;
+
+  std::string xml(readDataFile("data/response_series_observations_1.xml"));
+
+  ApiResponse expected;
+  ASSERT_TRUE(parseInChunks(xml, xml.size(), expected));
+
+  std::ostringstream expectedOutput;
+  expectedOutput << expected;
+
+  std::size_t chunkSizes[] = { 1, 2, 7, 64 };
+
+  for (std::size_t n = 0; n < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++n) {
+    ApiResponse response;
+    ASSERT_TRUE(parseInChunks(xml, chunkSizes[n], response));
+
+    std::ostringstream output;
+    output << response;
+    ASSERT_EQ(expectedOutput.str(), output.str());
+  }
+}
+
+
+TEST(StreamingXmlParser, PassesEntitiesToHandler) {
+  FREDCPP_TESTCASE("Passes entities to the handler instead of storing them");
+  using namespace fredcpp;
+
+  std::string xml(readDataFile("data/response_series_observations_1.xml"));
+
+  ApiResponse response;
+  CollectingEntityHandler handler;
+  ASSERT_TRUE(parseInChunks(xml, 16, response, &handler));
+
+  ASSERT_TRUE(response.entities.empty());
+  ASSERT_EQ(10U, handler.entities.size());
+  ASSERT_EQ("2014-03-14", handler.entities[9].attribute("date"));
+}
+
+
+TEST(StreamingXmlParser, DecodesEscapedContent) {
+  FREDCPP_TESTCASE("Decodes character references, CDATA, and skips comments");
+  using namespace fredcpp;
+
+  std::string xml("<?xml version=\"1.0\"?>\n"
+                  "<!-- comment with <markup> -->\n"
+                  "<seriess count='2'>\n"
+                  "  <series id=\"A&amp;B\" title=\"x &gt; y &#233;\"/>\n"
+                  "  <note id=\"N\">a &lt; b<![CDATA[ <c> ]]></note>\n"
+                  "</seriess>\n");
+
+  ApiResponse response;
+  ASSERT_TRUE(parseInChunks(xml, 3, response));
+
+  ASSERT_EQ("2", response.result.attribute("count"));
+  ASSERT_EQ(2U, response.entities.size());
+  ASSERT_EQ("A&B", response.entities[0].attribute("id"));
+  ASSERT_EQ("x > y \xC3\xA9", response.entities[0].attribute("title"));
+  ASSERT_EQ("a < b <c> ", response.entities[1].value);
+}
+
+
+TEST(StreamingXmlParser, FailsOnMalformedContent) {
+  FREDCPP_TESTCASE("Fails on mismatched or incomplete elements");
+  using namespace fredcpp;
+
+  ApiResponse response;
+
+  ASSERT_FALSE(parseInChunks("<seriess><series></seriess>", 4, response));
+  ASSERT_FALSE(parseInChunks("<seriess><series id=\"1\"/>", 4, response));
+  ASSERT_FALSE(parseInChunks("not xml", 4, response));
+}
@@ -0,0 +1,188 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/internal/AttributeMap.h>
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+TEST(internalAttributeMap, StoresAttributeValue) {
+  FREDCPP_TESTCASE("Stores a value for a given attribute");
+  using namespace fredcpp::internal;
+
+  AttributeMap attributes;
+  attributes["id"] = "GDP";
+  attributes["title"] = "Gross Domestic Product";
+
+  ASSERT_EQ(2U, attributes.size());
+  ASSERT_EQ("GDP", attributes.find("id")->second);
+  ASSERT_TRUE(attributes.find("units") == attributes.end());
+}
+
+
+TEST(internalAttributeMap, SupportsCaseInsensitiveNames) {
+  FREDCPP_TESTCASE("Matches attribute names case-insensitively");
+  using namespace fredcpp::internal;
+
+  AttributeMap attributes;
+  attributes["AnyCaseName"] = "value";
+  ASSERT_EQ("value", attributes.find("anyCASEname")->second);
+
+  attributes["ANYCaseName"] = "new-value";
+  ASSERT_EQ(1U, attributes.size());
+  ASSERT_EQ("new-value", attributes.find("AnyCaseName")->second);
+}
+
+
+TEST(internalAttributeMap, KeepsAttributesSortedByName) {
+  FREDCPP_TESTCASE("Iterates attributes in order of names");
+  using namespace fredcpp::internal;
+
+  AttributeMap attributes;
+  attributes["value"] = "1";
+  attributes["date"] = "2";
+  attributes["realtime_start"] = "3";
+
+  AttributeMap::const_iterator it(attributes.begin());
+  ASSERT_EQ("date", (it++)->first.str());
+  ASSERT_EQ("realtime_start", (it++)->first.str());
+  ASSERT_EQ("value", (it++)->first.str());
+  ASSERT_TRUE(it == attributes.end());
+
+  attributes.erase("realtime_start");
+  ASSERT_EQ(2U, attributes.size());
+}
+
+
+TEST(internalAttributeMap, SharesInternedNames) {
+  FREDCPP_TESTCASE("Shares a single interned copy of the same attribute name");
+  using namespace fredcpp::internal;
+
+  AttributeMap first;
+  AttributeMap second;
+  first["observation_start"] = "1";
+  second["observation_start"] = "2";
+
+  ASSERT_EQ(first.begin()->first, second.begin()->first);
+  ASSERT_EQ(&first.begin()->first.str(), &second.begin()->first.str());
+
+  Symbol symbol;
+  ASSERT_TRUE(SymbolTable::getInstance().find("OBSERVATION_START", symbol));
+  ASSERT_EQ(first.begin()->first, symbol);
+  ASSERT_FALSE(SymbolTable::getInstance().find("not-interned-name", symbol));
+}
+
+
+TEST(internalAttributeMap, ReusesRecycledSlots) {
+  FREDCPP_TESTCASE("Keeps recycled attribute slots and reuses them for new attributes");
+  using namespace fredcpp::internal;
+
+  const std::string LONG_VALUE("a value long enough to be allocated on the heap");
+
+  AttributeMap attributes;
+  attributes["value"] = LONG_VALUE;
+  attributes["date"] = LONG_VALUE;
+  const char* valueStorage(attributes["value"].data());
+  const char* dateStorage(attributes["date"].data());
+
+  attributes.recycle();
+  ASSERT_TRUE(attributes.empty());
+  ASSERT_TRUE(attributes.begin() == attributes.end());
+  ASSERT_TRUE(attributes.find("value") == attributes.end());
+
+  attributes["VALUE"] = LONG_VALUE;
+  attributes["units"] = "1";
+  attributes["date"] = LONG_VALUE;
+  ASSERT_EQ(valueStorage, attributes.find("value")->second.data());
+  ASSERT_EQ(dateStorage, attributes.find("date")->second.data());
+
+  AttributeMap::const_iterator it(attributes.begin());
+  ASSERT_EQ("date", (it++)->first.str());
+  ASSERT_EQ("units", (it++)->first.str());
+  ASSERT_EQ("value", (it++)->first.str());
+  ASSERT_TRUE(it == attributes.end());
+
+  attributes.recycle();
+  attributes["series_id"] = "3";
+  attributes["date"] = LONG_VALUE;
+  ASSERT_EQ(2U, attributes.size());
+  ASSERT_EQ("3", attributes.find("SERIES_ID")->second);
+  ASSERT_EQ(dateStorage, attributes.find("date")->second.data());
+  ASSERT_TRUE(attributes.find("units") == attributes.end());
+  ASSERT_EQ(2U, AttributeMap(attributes).size());
+}
+
+
+namespace {
+
+void internNames(std::size_t count, std::atomic<unsigned long>& failures) {
+  using namespace fredcpp::internal;
+
+  Symbol expected(SymbolTable::getInstance().intern("concurrent_name"));
+
+  for (std::size_t n = 0; n < count; ++n) {
+    std::ostringstream name;
+    name << "concurrent_name_" << (n % 2000);
+
+    AttributeMap attributes;
+    attributes[name.str()] = "1";
+    attributes["CONCURRENT_NAME"] = "2";
+
+    if (attributes.find("concurrent_name")->first != expected
+        || attributes.find(name.str())->first.str() != name.str()) {
+      ++failures;
+    }
+  }
+}
+
+} // namespace
+
+
+TEST(internalAttributeMap, InternsNamesConcurrently) {
+  FREDCPP_TESTCASE("Interns names in many threads at once, each thread gets the shared symbol");
+  using namespace fredcpp::internal;
+
+  std::atomic<unsigned long> failures(0);
+  std::vector<std::thread> threads;
+
+  for (std::size_t n = 0; n < 4; ++n) {
+    threads.push_back(std::thread(internNames, 4000, std::ref(failures)));
+  }
+
+  for (std::size_t n = 0; n < threads.size(); ++n) {
+    threads[n].join();
+  }
+
+  ASSERT_EQ(0UL, failures.load());
+
+  Symbol symbol;
+  ASSERT_TRUE(SymbolTable::getInstance().find("concurrent_name_1999", symbol));
+}
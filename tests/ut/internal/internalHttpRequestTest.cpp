@@ -90,3 +90,44 @@ TEST(internalHttpRequest, DetectsHttpsURI) {
   request.withURI("\t\r\nhttps:");
   ASSERT_TRUE(request.isHttps());
 }
+
+TEST(internalHttpRequest, RefersToRequestParams) {
+  FREDCPP_TESTCASE("Refers to parameters of a request, own parameters override them");
+  using namespace fredcpp::internal;
+
+  const std::string URI("http://server.net");
+
+  Request params;
+  params.with("b","value b")
+        .with("d","value-d")
+        ;
+
+  HttpRequest request;
+  request.withURIRef(URI)
+         .withParamsRef(params);
+
+  request.with("a","1")
+         .with("c","2")
+         .with("D","3")
+         .with("e","4")
+         ;
+
+  ASSERT_EQ(&URI, &request.getURI());
+  ASSERT_EQ("a=1&b=value%20b&c=2&d=3&e=4", request.getEncodedQuery());
+  ASSERT_EQ(5U, request.getParams().size());
+  ASSERT_EQ("value b", request["b"]);
+
+  std::string query;
+  request.appendEncodedQuery(query);
+  ASSERT_EQ(request.getEncodedQuery(), query);
+
+  Request expected;
+  expected.with("a","1").with("b","value b").with("c","2").with("d","3").with("e","4");
+  ASSERT_EQ(expected.getFingerprint(), request.getFingerprint());
+
+  HttpRequest copy(request);
+  copy.eraseParam("b");
+  ASSERT_EQ("a=1&c=2&d=3&e=4", copy.getEncodedQuery());
+  ASSERT_EQ("a=1&b=value%20b&c=2&d=3&e=4", request.getEncodedQuery());
+  ASSERT_EQ("b=value%20b&d=value-d", params.getEncodedQuery());
+}
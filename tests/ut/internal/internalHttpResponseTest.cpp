@@ -0,0 +1,86 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/internal/HttpResponse.h>
+
+
+TEST(internalHttpResponse, StoresStreamedContentInBuffer) {
+  FREDCPP_TESTCASE("Stores content written to the stream in contiguous buffer");
+  using namespace fredcpp::internal;
+
+  HttpResponse response;
+  response.getContentStream() << "<series id=" << '"' << "GDP" << '"' << "/>";
+  response.appendContent("\n", 1);
+
+  ASSERT_EQ("<series id=\"GDP\"/>\n", response.getContent());
+  ASSERT_EQ(&response.getContent(), &response.getContentBuffer());
+}
+
+
+TEST(internalHttpResponse, ClearsContent) {
+  FREDCPP_TESTCASE("Clears content and allows to stream new content");
+  using namespace fredcpp::internal;
+
+  HttpResponse response;
+  response.getContentStream() << "old-content";
+
+  response.clear();
+  ASSERT_TRUE(response.getContent().empty());
+
+  response.getContentStream() << "new-content";
+  ASSERT_EQ("new-content", response.getContent());
+}
+
+
+TEST(internalHttpResponse, CountsContentBytes) {
+  FREDCPP_TESTCASE("Counts content bytes received by the buffer or the sink");
+  using namespace fredcpp::internal;
+
+  class NullSink : public HttpContentSink {
+  public:
+    void onContent(const char* data, std::size_t size) {}
+    void onContentReset() {}
+  };
+
+  HttpResponse response;
+  response.getContentStream() << "0123456789";
+  response.setTransferBytes(4);
+
+  ASSERT_EQ(10U, response.getContentBytes());
+  ASSERT_EQ(4U, response.getTransferBytes());
+
+  NullSink sink;
+  response.setContentSink(&sink);
+  response.appendContent("abc", 3);
+
+  ASSERT_EQ(13U, response.getContentBytes());
+  ASSERT_EQ(10U, response.getContent().size());
+
+  response.clear();
+  ASSERT_EQ(0U, response.getContentBytes());
+  ASSERT_EQ(0U, response.getTransferBytes());
+}
@@ -0,0 +1,87 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/internal/LiteralCache.h>
+
+#include <cstring>
+#include <string>
+
+
+TEST(internalLiteralCache, FindsCachedLiteral) {
+  FREDCPP_TESTCASE("Finds the interned string cached for the literal address");
+  using namespace fredcpp::internal;
+
+  const std::string interned("series");
+
+  LiteralCache literals(LiteralCache::equals);
+  const char* literal("series");
+
+  ASSERT_TRUE(NULL == literals.find(literal));
+
+  literals.insert(literal, &interned);
+  ASSERT_EQ(&interned, literals.find(literal));
+}
+
+
+TEST(internalLiteralCache, VerifiesReusedBuffer) {
+  FREDCPP_TESTCASE("Does not return the cached string once the buffer text changes");
+  using namespace fredcpp::internal;
+
+  const std::string first("series");
+  const std::string second("release");
+
+  LiteralCache literals(LiteralCache::equals);
+  char buffer[16];
+
+  std::strcpy(buffer, "series");
+  literals.insert(buffer, &first);
+  ASSERT_EQ(&first, literals.find(buffer));
+
+  std::strcpy(buffer, "release");
+  ASSERT_TRUE(NULL == literals.find(buffer));
+
+  literals.insert(buffer, &second);
+  ASSERT_EQ(&second, literals.find(buffer));
+  ASSERT_EQ(1U, literals.size());
+}
+
+
+TEST(internalLiteralCache, BoundsCachedAddresses) {
+  FREDCPP_TESTCASE("Keeps a bounded number of addresses");
+  using namespace fredcpp::internal;
+
+  const std::string interned("series");
+
+  LiteralCache literals(LiteralCache::equals);
+  std::string buffers(4096, '\0');
+
+  for (std::size_t n = 0; n < 1000; ++n) {
+    literals.insert(&buffers[n], &interned);
+  }
+
+  ASSERT_LT(literals.size(), 1000U);
+}
@@ -0,0 +1,123 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/internal/LogRing.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+TEST(internalLogRing, PopsInPushOrder) {
+  FREDCPP_TESTCASE("Pops records in the order pushed, fails when full or empty");
+  using namespace fredcpp::internal;
+
+  LogRing ring(3);
+  ASSERT_EQ(4U, ring.capacity());
+
+  LogRecord record;
+  ASSERT_FALSE(ring.tryPop(record));
+
+  ASSERT_TRUE(ring.tryPush(LogLevel::LOG_INFO, "1"));
+  ASSERT_TRUE(ring.tryPush(LogLevel::LOG_WARN, "2"));
+  ASSERT_TRUE(ring.tryPush(LogLevel::LOG_ERROR, "3"));
+  ASSERT_TRUE(ring.tryPush(LogLevel::LOG_DEBUG, "4"));
+  ASSERT_FALSE(ring.tryPush(LogLevel::LOG_INFO, "5"));
+  ASSERT_EQ(4U, ring.getPushCount());
+
+  ASSERT_TRUE(ring.tryPop(record));
+  ASSERT_EQ(LogLevel::LOG_INFO, record.level);
+  ASSERT_EQ("1", record.line);
+
+  ASSERT_TRUE(ring.tryPush(LogLevel::LOG_FATAL, "5"));
+
+  const char* expected[] = {"2", "3", "4", "5"};
+
+  for (std::size_t n = 0; n < 4; ++n) {
+    ASSERT_TRUE(ring.tryPop(record));
+    ASSERT_EQ(expected[n], record.line);
+  }
+
+  ASSERT_EQ(LogLevel::LOG_FATAL, record.level);
+  ASSERT_FALSE(ring.tryPop(record));
+  ASSERT_EQ(5U, ring.getPushCount());
+}
+
+
+TEST(internalLogRing, TakesRecordsFromManyThreads) {
+  FREDCPP_TESTCASE("Keeps each record whole and each producer's order with concurrent producers");
+  using namespace fredcpp::internal;
+
+  const std::size_t NUM_THREADS = 4;
+  const std::size_t NUM_RECORDS = 10000;
+
+  LogRing ring(64);
+  std::vector<std::thread> threads;
+
+  for (std::size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.push_back(std::thread([&ring, t] () {
+      for (std::size_t n = 0; n < NUM_RECORDS; ++n) {
+        std::ostringstream line;
+        line << t << ":" << n;
+
+        while (!ring.tryPush(LogLevel::LOG_INFO, line.str())) {
+          std::this_thread::yield();
+        }
+      }
+    }));
+  }
+
+  std::vector<std::size_t> nextRecord(NUM_THREADS, 0);
+  std::size_t numPopped(0);
+  LogRecord record;
+
+  while (numPopped < NUM_THREADS * NUM_RECORDS) {
+    if (!ring.tryPop(record)) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::size_t t(0);
+    std::size_t n(0);
+    char separator(0);
+
+    std::istringstream line(record.line);
+    line >> t >> separator >> n;
+
+    ASSERT_LT(t, NUM_THREADS);
+    ASSERT_EQ(nextRecord[t], n);
+    ++nextRecord[t];
+    ++numPopped;
+  }
+
+  for (std::size_t t = 0; t < NUM_THREADS; ++t) {
+    threads[t].join();
+  }
+
+  ASSERT_FALSE(ring.tryPop(record));
+  ASSERT_EQ(NUM_THREADS * NUM_RECORDS, ring.getPushCount());
+}
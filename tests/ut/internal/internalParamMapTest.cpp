@@ -0,0 +1,108 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/internal/ParamMap.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+
+TEST(internalParamMap, StoresParamValue) {
+  FREDCPP_TESTCASE("Stores values of parameters, case-insensitive and sorted by name");
+  using namespace fredcpp::internal;
+
+  SymbolTable& symbols(SymbolTable::getInstance());
+
+  ParamMap params;
+  ASSERT_TRUE(params.set(symbols.intern("series_id"), "GDP", 3).second);
+  ASSERT_TRUE(params.set(symbols.intern("limit"), "10", 2).second);
+  ASSERT_FALSE(params.set(symbols.intern("SERIES_ID"), "GNP", 3).second);
+
+  ASSERT_EQ(2U, params.size());
+  ASSERT_EQ("GNP", params.find("Series_Id")->second.str());
+  ASSERT_TRUE(params.find("offset") == params.end());
+
+  ASSERT_TRUE(params.begin() == params.find("limit"));
+  ASSERT_TRUE(params.begin() + 1 == params.find("series_id"));
+
+  params.erase("limit");
+  ASSERT_EQ(1U, params.size());
+  ASSERT_EQ("GNP", params.begin()->second.str());
+}
+
+
+TEST(internalParamMap, MovesToHeapAboveInlineCapacity) {
+  FREDCPP_TESTCASE("Keeps parameters above the inline capacity, in order");
+  using namespace fredcpp::internal;
+
+  const std::size_t COUNT(ParamMap::INLINE_CAPACITY * 2);
+
+  ParamMap params;
+  for (std::size_t n = COUNT; n > 0; --n) {
+    std::ostringstream name;
+    name << "param" << (n < 10 ? "0" : "") << n;
+    params.set(SymbolTable::getInstance().intern(name.str()), name.str().data(), name.str().size());
+  }
+
+  ASSERT_EQ(COUNT, params.size());
+  ASSERT_EQ("param01", params.begin()->first.str());
+  ASSERT_EQ("param16", params.find("PARAM16")->second.str());
+
+  ParamMap copy(params);
+
+  for (std::size_t n = COUNT; n > 1; --n) {
+    std::ostringstream name;
+    name << "param" << (n < 10 ? "0" : "") << n;
+    copy.erase(name.str());
+  }
+
+  ASSERT_EQ(1U, copy.size());
+  ASSERT_EQ("param01", copy.begin()->second.str());
+  ASSERT_EQ(COUNT, params.size());
+}
+
+
+TEST(internalParamMap, StoresLongValues) {
+  FREDCPP_TESTCASE("Stores values inline or on the heap");
+  using namespace fredcpp::internal;
+
+  std::string shortValue(ParamValue::INLINE_SIZE, 'a');
+  std::string longValue(ParamValue::INLINE_SIZE + 1, 'b');
+
+  ParamValue value(shortValue);
+  ASSERT_EQ(shortValue, value.str());
+  ASSERT_EQ(0, std::strcmp(shortValue.c_str(), value.c_str()));
+
+  value.assign(longValue.data(), longValue.size());
+  ASSERT_EQ(longValue, value.str());
+  ASSERT_TRUE(value.equals(longValue.data(), longValue.size()));
+
+  value.assign("", 0);
+  ASSERT_TRUE(value.empty());
+  ASSERT_EQ(std::string(), static_cast<std::string>(value));
+}
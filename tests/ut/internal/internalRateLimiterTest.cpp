@@ -0,0 +1,125 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/internal/RateLimiter.h>
+#include <fredcpp/internal/utils.h>
+
+
+TEST(internalRateLimiter, UnlimitedByDefault) {
+  FREDCPP_TESTCASE("Does not limit requests by default");
+  using namespace fredcpp::internal;
+
+  RateLimiter limiter;
+  ASSERT_FALSE(limiter.enabled());
+
+  for (int n = 0; n < 100; ++n) {
+    ASSERT_TRUE(limiter.tryAcquire());
+  }
+  ASSERT_EQ(0UL, limiter.getWaitMillis());
+}
+
+
+TEST(internalRateLimiter, AllowsConfiguredBurst) {
+  FREDCPP_TESTCASE("Allows a burst of requests without waiting");
+  using namespace fredcpp::internal;
+
+  RateLimiter limiter(1, 60000);
+  limiter.withBurst(3);
+
+  ASSERT_TRUE(limiter.tryAcquire());
+  ASSERT_TRUE(limiter.tryAcquire());
+  ASSERT_TRUE(limiter.tryAcquire());
+  ASSERT_FALSE(limiter.tryAcquire());
+  ASSERT_GT(limiter.getWaitMillis(), 0UL);
+}
+
+
+TEST(internalRateLimiter, PacesRequestsToRate) {
+  FREDCPP_TESTCASE("Waits to pace requests to the configured rate");
+  using namespace fredcpp::internal;
+
+  RateLimiter limiter(50, 1000);
+
+  unsigned long long start(monotonicMillis());
+
+  for (int n = 0; n < 4; ++n) {
+    limiter.acquire();
+  }
+
+  // first request passes right away, each next one waits ~20ms
+  unsigned long long elapsed(monotonicMillis() - start);
+  ASSERT_GE(elapsed, 55ULL);
+}
+
+
+TEST(internalRateLimiter, KeepsTokensOnReconfiguring) {
+  FREDCPP_TESTCASE("Does not refill the bucket when the rate is set again or changed");
+  using namespace fredcpp::internal;
+
+  RateLimiter& limiter(RateLimiter::forKey("TEST-RECONFIGURED-KEY"));
+  limiter.withRate(1, 60000);
+
+  ASSERT_TRUE(limiter.tryAcquire());
+  ASSERT_FALSE(limiter.tryAcquire());
+
+  RateLimiter::forKey("TEST-RECONFIGURED-KEY").withRate(1, 60000);
+  ASSERT_FALSE(limiter.tryAcquire());
+
+  limiter.withRate(2, 60000);
+  ASSERT_FALSE(limiter.tryAcquire());
+  ASSERT_GT(limiter.getWaitMillis(), 0UL);
+
+  limiter.withRate(0);
+  ASSERT_TRUE(limiter.tryAcquire());
+}
+
+
+TEST(internalRateLimiter, TakesBackReleasedToken) {
+  FREDCPP_TESTCASE("Makes a released token available again, up to the burst");
+  using namespace fredcpp::internal;
+
+  RateLimiter limiter(1, 60000);
+
+  ASSERT_TRUE(limiter.tryAcquire());
+  ASSERT_FALSE(limiter.tryAcquire());
+
+  limiter.release();
+  limiter.release();
+  ASSERT_TRUE(limiter.tryAcquire());
+  ASSERT_FALSE(limiter.tryAcquire());
+}
+
+
+TEST(internalRateLimiter, SharesLimiterPerKey) {
+  FREDCPP_TESTCASE("Shares the same rate limiter for the same key");
+  using namespace fredcpp::internal;
+
+  RateLimiter& limiter(RateLimiter::forKey("TEST-KEY"));
+
+  ASSERT_EQ(&limiter, &RateLimiter::forKey("TEST-KEY"));
+  ASSERT_NE(&limiter, &RateLimiter::forKey("OTHER-KEY"));
+}
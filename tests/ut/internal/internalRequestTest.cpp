@@ -27,6 +27,8 @@
 
 #include <fredcpp/internal/Request.h>
 
+#include <cstring>
+
 
 TEST(internalRequest, StoresParamValue) {
   FREDCPP_TESTCASE("Stores a value for a given parameter");
@@ -101,3 +103,85 @@ TEST(internalRequest, SupportsEraseAllParams) {
 
   ASSERT_TRUE(request.getParams().empty());
 }
+
+TEST(internalRequest, EncodesQueryInParamOrder) {
+  FREDCPP_TESTCASE("Encodes parameters as query with lower-case names");
+  using namespace fredcpp::internal;
+
+  Request request;
+  ASSERT_EQ("", request.getEncodedQuery());
+
+  request.with("Series_ID", "GDP")
+         .with("search_text", "money stock/M2")
+         .with("api_key", "abc");
+
+  ASSERT_EQ("api_key=abc&search_text=money%20stock%2FM2&series_id=GDP", request.getEncodedQuery());
+}
+
+TEST(internalRequest, UpdatesQueryWhenParamsChange) {
+  FREDCPP_TESTCASE("Keeps encoded query and fingerprint in step with parameters");
+  using namespace fredcpp::internal;
+
+  Request request;
+  request.with("series_id", "GDP")
+         .with("units", "lin");
+
+  std::uint64_t fingerprint(request.getFingerprint());
+  ASSERT_EQ("series_id=GDP&units=lin", request.getEncodedQuery());
+
+  // inserted into the encoded query: first, middle, last
+  request.with("api_key", "abc")
+         .with("sort_order", "asc")
+         .with("vintage_dates", "2014-01-01");
+
+  ASSERT_EQ("api_key=abc&series_id=GDP&sort_order=asc&units=lin&vintage_dates=2014-01-01",
+            request.getEncodedQuery());
+  ASSERT_NE(fingerprint, request.getFingerprint());
+
+  Request rebuilt;
+  rebuilt.with("vintage_dates", "2014-01-01")
+         .with("units", "lin")
+         .with("sort_order", "asc")
+         .with("series_id", "GDP")
+         .with("api_key", "abc");
+
+  ASSERT_EQ(rebuilt.getEncodedQuery(), request.getEncodedQuery());
+  ASSERT_EQ(rebuilt.getFingerprint(), request.getFingerprint());
+
+  request.with("UNITS", "chg");
+  ASSERT_EQ("api_key=abc&series_id=GDP&sort_order=asc&units=chg&vintage_dates=2014-01-01",
+            request.getEncodedQuery());
+
+  request.eraseParam("sort_order");
+  ASSERT_EQ("api_key=abc&series_id=GDP&units=chg&vintage_dates=2014-01-01",
+            request.getEncodedQuery());
+
+  Request copy(request);
+  ASSERT_EQ(request.getEncodedQuery(), copy.getEncodedQuery());
+  ASSERT_EQ(request.getFingerprint(), copy.getFingerprint());
+
+  request.clear();
+  ASSERT_EQ("", request.getEncodedQuery());
+  ASSERT_EQ("api_key=abc&series_id=GDP&units=chg&vintage_dates=2014-01-01",
+            copy.getEncodedQuery());
+}
+
+
+TEST(internalRequest, NamesParamsFromReusedBuffer) {
+  FREDCPP_TESTCASE("Sets the parameter named by the current content of a reused char array");
+  using namespace fredcpp::internal;
+
+  Request request;
+  char key[32];
+
+  std::strcpy(key, "series_id");
+  request.with(key, "GNPCA");
+
+  std::strcpy(key, "limit");
+  request.with(key, "10");
+
+  ASSERT_EQ(2U, request.getParams().size());
+  ASSERT_EQ("GNPCA", request["series_id"]);
+  ASSERT_EQ("10", request["limit"]);
+  ASSERT_EQ("limit=10&series_id=GNPCA", request.getEncodedQuery());
+}
@@ -0,0 +1,170 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/internal/RetryPolicy.h>
+#include <fredcpp/internal/HttpResponse.h>
+
+
+TEST(internalRetryPolicy, RetriesTransientStatuses) {
+  FREDCPP_TESTCASE("Retries too-many-requests and server errors only");
+  using namespace fredcpp::internal;
+
+  RetryPolicy policy;
+
+  ASSERT_TRUE(policy.isRetryableStatus(HttpResponse::HTTP_TOO_MANY_REQUESTS));
+  ASSERT_TRUE(policy.isRetryableStatus(HttpResponse::HTTP_INTERNAL_SERVER_ERROR));
+  ASSERT_TRUE(policy.isRetryableStatus(HttpResponse::HTTP_BAD_GATEWAY));
+  ASSERT_TRUE(policy.isRetryableStatus(HttpResponse::HTTP_SERVICE_UNAVAILABLE));
+  ASSERT_TRUE(policy.isRetryableStatus(HttpResponse::HTTP_GATEWAY_TIMEOUT));
+
+  ASSERT_FALSE(policy.isRetryableStatus(HttpResponse::HTTP_OK));
+  ASSERT_FALSE(policy.isRetryableStatus(HttpResponse::HTTP_BAD_REQUEST));
+  ASSERT_FALSE(policy.isRetryableStatus(HttpResponse::HTTP_NOT_FOUND));
+  ASSERT_FALSE(policy.isRetryableStatus(HttpResponse::HTTP_NOT_IMPLEMENTED));
+}
+
+
+TEST(internalRetryPolicy, BacksOffExponentially) {
+  FREDCPP_TESTCASE("Doubles the delay with each retry up to the maximum");
+  using namespace fredcpp::internal;
+
+  RetryPolicy policy;
+  policy.withInitialDelay(100)
+        .withMaxDelay(1000)
+        .withJitter(0.0);
+
+  HttpResponse response;
+
+  ASSERT_EQ(100UL, policy.getDelayMillis(1, response));
+  ASSERT_EQ(200UL, policy.getDelayMillis(2, response));
+  ASSERT_EQ(400UL, policy.getDelayMillis(3, response));
+  ASSERT_EQ(800UL, policy.getDelayMillis(4, response));
+  ASSERT_EQ(1000UL, policy.getDelayMillis(5, response));
+  ASSERT_EQ(1000UL, policy.getDelayMillis(100, response));
+}
+
+
+TEST(internalRetryPolicy, JittersWithinBounds) {
+  FREDCPP_TESTCASE("Randomizes the configured share of the delay");
+  using namespace fredcpp::internal;
+
+  RetryPolicy policy;
+  policy.withInitialDelay(1000)
+        .withMaxDelay(10000)
+        .withJitter(0.5);
+
+  HttpResponse response;
+  bool varies(false);
+  unsigned long first(policy.getDelayMillis(2, response));
+
+  for (int n = 0; n < 100; ++n) {
+    unsigned long delay(policy.getDelayMillis(2, response));
+
+    ASSERT_GE(delay, 1000UL);
+    ASSERT_LE(delay, 2000UL);
+    varies = varies || (delay != first);
+  }
+
+  ASSERT_TRUE(varies);
+}
+
+
+TEST(internalRetryPolicy, HonorsRetryAfter) {
+  FREDCPP_TESTCASE("Waits no shorter than the server asks, gives up beyond the maximum delay");
+  using namespace fredcpp::internal;
+
+  RetryPolicy policy;
+  policy.withInitialDelay(100)
+        .withMaxDelay(5000)
+        .withJitter(0.0);
+
+  HttpResponse response;
+  response.setHttpStatus(HttpResponse::HTTP_TOO_MANY_REQUESTS);
+  response.setHeader("Retry-After", "3");
+
+  unsigned long delay(0);
+
+  ASSERT_EQ(3000UL, policy.getDelayMillis(1, response));
+  ASSERT_TRUE(policy.nextRetry(1, 0, response, delay));
+  ASSERT_EQ(3000UL, delay);
+
+  response.setHeader("Retry-After", "60");
+  ASSERT_FALSE(policy.nextRetry(1, 0, response, delay));
+}
+
+
+TEST(internalRetryPolicy, ParsesRetryAfter) {
+  FREDCPP_TESTCASE("Parses delay-seconds and HTTP-date");
+  using namespace fredcpp::internal;
+
+  // Sun, 06 Nov 1994 08:49:37 GMT
+  const std::time_t NOW(784111777);
+
+  unsigned long delay(0);
+
+  ASSERT_TRUE(RetryPolicy::parseRetryAfter("120", NOW, delay));
+  ASSERT_EQ(120000UL, delay);
+
+  ASSERT_TRUE(RetryPolicy::parseRetryAfter("Sun, 06 Nov 1994 08:50:07 GMT", NOW, delay));
+  ASSERT_EQ(30000UL, delay);
+
+  ASSERT_TRUE(RetryPolicy::parseRetryAfter("Sun, 06 Nov 1994 08:00:00 GMT", NOW, delay));
+  ASSERT_EQ(0UL, delay);
+
+  ASSERT_FALSE(RetryPolicy::parseRetryAfter("", NOW, delay));
+  ASSERT_FALSE(RetryPolicy::parseRetryAfter("-1", NOW, delay));
+  ASSERT_FALSE(RetryPolicy::parseRetryAfter("soon", NOW, delay));
+  ASSERT_FALSE(RetryPolicy::parseRetryAfter("Sun, 06 Foo 1994 08:50:07 GMT", NOW, delay));
+}
+
+
+TEST(internalRetryPolicy, StopsAtMaxRetriesAndDeadline) {
+  FREDCPP_TESTCASE("Gives up when retries are exhausted or the deadline would pass");
+  using namespace fredcpp::internal;
+
+  RetryPolicy policy;
+  policy.withMaxRetries(2)
+        .withInitialDelay(100)
+        .withJitter(0.0);
+
+  HttpResponse response;
+  unsigned long delay(0);
+
+  ASSERT_TRUE(policy.nextRetry(1, 0, response, delay));
+  ASSERT_TRUE(policy.nextRetry(2, 0, response, delay));
+  ASSERT_FALSE(policy.nextRetry(3, 0, response, delay));
+
+  ASSERT_EQ(0UL, policy.getRemainingMillis(1000000));
+
+  policy.withDeadline(1000);
+
+  ASSERT_TRUE(policy.nextRetry(1, 800, response, delay));
+  ASSERT_FALSE(policy.nextRetry(1, 900, response, delay));
+
+  ASSERT_EQ(600UL, policy.getRemainingMillis(400));
+  ASSERT_EQ(1UL, policy.getRemainingMillis(1500));
+}
@@ -0,0 +1,65 @@
+/*
+ *  This file is part of fredcpp library
+ *
+ *  Copyright (c) 2012 - 2020, Artur Shepilko, <fredcpp@nomadbyte.com>.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fredcpp-gtest.h>
+#include <gtest/gtest.h>
+
+#include <fredcpp/internal/utils.h>
+
+#include <string>
+
+
+TEST(internalUtils, PercentEncodesAllButUnreserved) {
+  FREDCPP_TESTCASE("Keeps unreserved characters, encodes any other byte");
+  using namespace fredcpp::internal;
+
+  const std::string UNRESERVED("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._~");
+  const char HEX[] = "0123456789ABCDEF";
+
+  for (int c = 0; c < 256; ++c) {
+    std::string value(1, static_cast<char>(c));
+    std::string expected(value);
+
+    if (std::string::npos == UNRESERVED.find(static_cast<char>(c))) {
+      expected = std::string("%") + HEX[c >> 4] + HEX[c & 0xF];
+    }
+
+    ASSERT_EQ(expected, percentEncode(value)) << "byte:" << c;
+  }
+}
+
+
+TEST(internalUtils, AppendsPercentEncoded) {
+  FREDCPP_TESTCASE("Appends encoded runs to the buffer");
+  using namespace fredcpp::internal;
+
+  std::string buf("q=");
+
+  appendPercentEncoded(buf, "GDP per capita/US&EU_2014~");
+  appendPercentEncoded(buf, "");
+  appendPercentEncoded(buf, "\xC3\xA9");
+
+  ASSERT_EQ("q=GDP%20per%20capita%2FUS%26EU_2014~%C3%A9", buf);
+  ASSERT_EQ("", percentEncode(""));
+}